@@ -1687,7 +1687,6 @@ QString textEmojiString(const EmojiData *emoji) {
 
 bool genEmoji(QString, const QString &emoji_out, const QString &emoji_png) {
 	int currentRow = 0, currentColumn = 0;
-	uint32 min1 = 0xFFFFFFFFU, max1 = 0, min2 = 0xFFFFFFFFU, max2 = 0;
 
 	for (int i = 0, l = sizeof(emojiPostfixed) / sizeof(emojiPostfixed[0]); i < l; ++i) {
 		emojiWithPostfixes.insert(emojiPostfixed[i], true);
@@ -1726,20 +1725,6 @@ bool genEmoji(QString, const QString &emoji_out, const QString &emoji_png) {
 				currentColumn = 0;
 			}
 
-			uint32 high = data.code >> 16;
-			if (high == 0xFFFF) { // sequences
-
-			} else if (!high) { // small codes
-				if (data.code == 169 || data.code == 174) { // two small
-				} else {
-					if (data.code < min1) min1 = data.code;
-					if (data.code > max1) max1 = data.code;
-				}
-			} else if (high == 0x23 || high == 0x2A || (high >= 0x30 && high < 0x3A)) { // digits
-			} else {
-				if (data.code < min2) min2 = data.code;
-				if (data.code > max2) max2 = data.code;
-			}
 			EmojisData::const_iterator key = emojisData.constFind(fullCode);
 			if (key != emojisData.cend()) {
 				cout << QString("Bad emoji code (duplicate) %1 %2 and %3 %4").arg(data.code).arg(data.code2).arg(key->code).arg(key->code2).toUtf8().constData() << "\n";
@@ -2010,106 +1995,69 @@ Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org\n\
 			}
 			tcpp << "};\n\n";
 
-			// getter of one symbol emojis
-			tcpp << "EmojiPtr emojiGet(uint32 code) {\n";
-			tcpp << "\tif (!emojis) return 0;\n\n";
-			tcpp << "\tuint32 highCode = code >> 16;\n";
-
-			EmojisData::const_iterator i = emojisData.cbegin(), e = emojisData.cend();
-
-			tcpp << "\tif (!highCode) {\n"; // small codes
-			tcpp << "\t\tswitch (code) {\n";
-			for (index = 0; i != e; ++i) { // two small
-				if (i->code2) break;
-				if (i->code != 169 && i->code != 174) break;
-
-                tcpp << "\t\t\tcase 0x" << QString("%1").arg(i->code, 0, 16).toUpper().toUtf8().constData() << "U: return &emojis[" << (index++) << "];\n";
-			}
-			tcpp << "\t\t}\n\n";
-            tcpp << "\t\tif (code < 0x" << QString("%1").arg(min1, 0, 16).toUpper().toUtf8().constData() << "U || code > 0x" << QString("%1").arg(max1, 0, 16).toUpper().toUtf8().constData() << "U) return 0;\n\n";
-			tcpp << "\t\tswitch (code) {\n";
-			for (; i != e; ++i) {
-				if (i->code2 || (i->code >> 16)) break;
-                tcpp << "\t\t\tcase 0x" << QString("%1").arg(i->code, 0, 16).toUpper().toUtf8().constData() << "U: return &emojis[" << (index++) << "];\n";
-			}
-			tcpp << "\t\t}\n\n";
-			tcpp << "\t\treturn 0;\n";
-			tcpp << "\t}\n\n";
-
-			tcpp << "\tif (highCode == 0x23 || highCode == 0x2A || (highCode >= 0x30 && highCode < 0x3A)) {\n"; // digits
-            tcpp << "\t\tif ((code & 0xFFFFU) != 0x20E3U) return 0;\n\n";
-			tcpp << "\t\tswitch (code) {\n";
-			for (; i != e; ++i) {
-				if (i->code2) break;
-				uint32 high = i->code >> 16;
-				if (high != 0x23 && high != 0x2A && (high < 0x30 || high >= 0x3A)) break;
-
-                tcpp << "\t\t\tcase 0x" << QString("%1").arg(i->code, 0, 16).toUpper().toUtf8().constData() << "U: return &emojis[" << (index++) << "];\n";
-			}
-			tcpp << "\t\t}\n\n";
-			tcpp << "\t\treturn 0;\n";
-			tcpp << "\t}\n\n";
-
-			tcpp << "\tif (highCode == 0xFFFFU) {\n"; // sequences
-			tcpp << "\t\tstatic const int sequenceOffset = " << sequenceOffset << ";\n\n";
-			tcpp << "\t\tuint32 index = (code & 0xFFFFU);\n";
-			tcpp << "\t\treturn (index < " << (sizeof(emojiSequences) / sizeof(emojiSequences[0])) << ") ? &emojis[sequenceOffset + index] : 0;\n";
-			tcpp << "\t}\n\n";
-
-            tcpp << "\tif (code < 0x" << QString("%1").arg(min2, 0, 16).toUpper().toUtf8().constData() << "U || code > 0x" << QString("%1").arg(max2, 0, 16).toUpper().toUtf8().constData() << "U) return 0;\n\n";
-			tcpp << "\tswitch (code) {\n";
-			uint32 minTwoSymbol = 0, maxTwoSymbol = 0;
-			for (; i != e; ++i) {
+			// sorted tables for the getters of one and two symbol emojis
+			QMap<uint32, uint32> byCode;
+			QMap<uint64, uint32> byCodes;
+			index = 0;
+			for (EmojisData::const_iterator i = emojisData.cbegin(), e = emojisData.cend(); i != e; ++i, ++index) {
 				if (i->code2) {
-					if (!minTwoSymbol) minTwoSymbol = i->code;
-					if (i->code > maxTwoSymbol) {
-						tcpp << "\t\tcase 0x" << QString("%1").arg(i->code, 0, 16).toUpper().toUtf8().constData() << "U: return TwoSymbolEmoji;\n";
-						maxTwoSymbol = i->code;
-					}
-					index++;
-					continue;
+					byCode.insert(i->code, 0xFFFFU); // two symbol emoji start
+					byCodes.insert((uint64(i->code) << 32) | uint64(i->code2), index);
+				} else if (!i->color || ((i->color & 0xFFFF0000U) == 0xFFFF0000U)) {
+					byCode.insert(i->code, index);
 				}
-				if ((i->code & 16) == 0xFFFF) { // sequence
-					index++;
-					continue;
-				}
-				if (i->color && ((i->color & 0xFFFF0000U) != 0xFFFF0000U)) {
-					index++;
-					continue;
+			}
+
+			tcpp << "namespace {\n\n";
+			tcpp << "struct EmojiCodeIndex {\n";
+			tcpp << "\tuint32 code;\n";
+			tcpp << "\tuint16 index;\n";
+			tcpp << "};\n\n";
+			tcpp << "struct EmojiCodesIndex {\n";
+			tcpp << "\tuint64 codes;\n";
+			tcpp << "\tuint16 index;\n";
+			tcpp << "};\n\n";
+			tcpp << "const uint16 TwoSymbolEmojiIndex = 0xFFFFU;\n\n";
+			tcpp << "// Sorted by code, looked up with a binary search.\n";
+			tcpp << "const EmojiCodeIndex EmojisByCode[] = {\n";
+			for (auto i = byCode.cbegin(), e = byCode.cend(); i != e; ++i) {
+				tcpp << "\t{ 0x" << QString("%1").arg(i.key(), 0, 16).toUpper().toUtf8().constData() << "U, ";
+				if (i.value() == 0xFFFFU) {
+					tcpp << "TwoSymbolEmojiIndex";
+				} else {
+					tcpp << i.value();
 				}
-                tcpp << "\t\tcase 0x" << QString("%1").arg(i->code, 0, 16).toUpper().toUtf8().constData() << "U: return &emojis[" << (index++) << "];\n";
+				tcpp << " },\n";
 			}
-			tcpp << "\t}\n\n";
+			tcpp << "};\n\n";
+			tcpp << "// Sorted by (code << 32) | code2, looked up with a binary search.\n";
+			tcpp << "const EmojiCodesIndex EmojisByCodes[] = {\n";
+			for (auto i = byCodes.cbegin(), e = byCodes.cend(); i != e; ++i) {
+				tcpp << "\t{ 0x" << QString("%1").arg(i.key(), 16, 16, QChar('0')).toUpper().toUtf8().constData() << "ULL, " << i.value() << " },\n";
+			}
+			tcpp << "};\n\n";
+			tcpp << "} // namespace\n\n";
 
-			tcpp << "\treturn 0;\n";
+			// getter of one symbol emojis
+			tcpp << "EmojiPtr emojiGet(uint32 code) {\n";
+			tcpp << "\tif (!emojis) return 0;\n\n";
+			tcpp << "\tauto begin = EmojisByCode, end = EmojisByCode + base::array_size(EmojisByCode);\n";
+			tcpp << "\tauto i = std::lower_bound(begin, end, code, [](const EmojiCodeIndex &entry, uint32 code) {\n";
+			tcpp << "\t\treturn entry.code < code;\n";
+			tcpp << "\t});\n";
+			tcpp << "\tif (i == end || i->code != code) return 0;\n\n";
+			tcpp << "\treturn (i->index == TwoSymbolEmojiIndex) ? TwoSymbolEmoji : &emojis[i->index];\n";
 			tcpp << "}\n\n";
 
 			// getter of two symbol emojis
 			tcpp << "EmojiPtr emojiGet(uint32 code, uint32 code2) {\n";
-			tcpp << "\tif (code < 0x" << QString("%1").arg(minTwoSymbol, 0, 16).toUpper().toUtf8().constData() << "U || code > 0x" << QString("%1").arg(maxTwoSymbol, 0, 16).toUpper().toUtf8().constData() << "U) return 0;\n\n";
-			tcpp << "\tswitch (code) {\n";
-			maxTwoSymbol = 0;
-			index = 0;
-			for (i = emojisData.cbegin(); i != e; ++i) {
-				if (i->code2) {
-					if (i->code > maxTwoSymbol) {
-						if (maxTwoSymbol) {
-							tcpp << "\t\t\tdefault: return 0;\n";
-							tcpp << "\t\t} break;\n";
-						}
-						tcpp << "\t\tcase 0x" << QString("%1").arg(i->code, 0, 16).toUpper().toUtf8().constData() << "U: switch (code2) {\n";
-						maxTwoSymbol = i->code;
-					}
-					tcpp << "\t\t\tcase 0x" << QString("%1").arg(i->code2, 0, 16).toUpper().toUtf8().constData() << "U: return &emojis[" << index << "];\n";
-				}
-				index++;
-			}
-			if (maxTwoSymbol) {
-				tcpp << "\t\t\tdefault: return 0;\n";
-				tcpp << "\t\t} break;\n";
-			}
-			tcpp << "\t}\n\n";
-			tcpp << "\treturn 0;\n";
+			tcpp << "\tauto codes = (uint64(code) << 32) | uint64(code2);\n";
+			tcpp << "\tauto begin = EmojisByCodes, end = EmojisByCodes + base::array_size(EmojisByCodes);\n";
+			tcpp << "\tauto i = std::lower_bound(begin, end, codes, [](const EmojiCodesIndex &entry, uint64 codes) {\n";
+			tcpp << "\t\treturn entry.codes < codes;\n";
+			tcpp << "\t});\n";
+			tcpp << "\tif (i == end || i->codes != codes) return 0;\n\n";
+			tcpp << "\treturn &emojis[i->index];\n";
 			tcpp << "}\n\n";
 
 			// getter of colored emojis
@@ -32,6 +32,8 @@ Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
 #include "styles/style_boxes.h"
 #include "lang.h"
 #include "data/data_abstract_structure.h"
+#include "data/data_messages_index.h"
+#include "data/data_search_index.h"
 #include "history/history_service_layout.h"
 #include "history/history_location_manager.h"
 #include "history/history_media_types.h"
@@ -87,10 +89,8 @@ namespace {
 
 	Histories histories;
 
-	using MsgsData = QHash<MsgId, HistoryItem*>;
-	MsgsData msgsData;
-	using ChannelMsgsData = QMap<ChannelId, MsgsData>;
-	ChannelMsgsData channelMsgsData;
+	Data::MessagesIndex msgsIndex;
+	Data::MessagesSearchIndex searchIndex;
 
 	using RandomData = QMap<uint64, FullMsgId>;
 	RandomData randomData;
@@ -123,8 +123,6 @@ namespace {
 	EmojiMap mainEmojiMap;
 	QMap<int32, EmojiMap> otherEmojiMap;
 
-	int32 serviceImageCacheSize = 0;
-
 	using LastPhotosList = QLinkedList<PhotoData*>;
 	LastPhotosList lastPhotos;
 	using LastPhotosMap = QHash<PhotoData*, LastPhotosList::iterator>;
@@ -1257,34 +1255,24 @@ namespace {
 		}
 	}
 
-	inline MsgsData *fetchMsgsData(ChannelId channelId, bool insert = true) {
-		if (channelId == NoChannel) return &msgsData;
-		ChannelMsgsData::iterator i = channelMsgsData.find(channelId);
-		if (i == channelMsgsData.cend()) {
-			if (insert) {
-				i = channelMsgsData.insert(channelId, MsgsData());
-			} else {
-				return 0;
-			}
-		}
-		return &(*i);
-	}
-
 	void feedWereDeleted(ChannelId channelId, const QVector<MTPint> &msgsIds) {
-		MsgsData *data = fetchMsgsData(channelId, false);
-		if (!data) return;
+		if (!::msgsIndex.hasChannel(channelId)) return;
 
 		ChannelHistory *channelHistory = (channelId == NoChannel) ? 0 : App::historyLoaded(peerFromChannel(channelId))->asChannelHistory();
 
 		QMap<History*, bool> historiesToCheck;
 		for (QVector<MTPint>::const_iterator i = msgsIds.cbegin(), e = msgsIds.cend(); i != e; ++i) {
-			MsgsData::const_iterator j = data->constFind(i->v);
-			if (j != data->cend()) {
-				History *h = (*j)->history();
-				(*j)->destroy();
+			auto item = ::msgsIndex.mayContain(channelId, i->v) ? ::msgsIndex.find(channelId, i->v) : nullptr;
+			if (item) {
+				History *h = item->history();
+				item->destroy();
 				if (!h->lastMsg) historiesToCheck.insert(h, true);
+
+				// The cached page could contain the deleted message, it'll be written again on the next load.
+				Local::clearCachedMessages(h->peer->id);
 			} else {
 				if (channelHistory) {
+					Local::clearCachedMessages(channelHistory->peer->id);
 					if (channelHistory->unreadCount() > 0 && i->v >= channelHistory->inboxReadBefore) {
 						channelHistory->setUnreadCount(channelHistory->unreadCount() - 1);
 					}
@@ -1645,6 +1633,9 @@ namespace {
 			lastPhotos.erase(inLastIter.value()); // move to back
 			(*inLastIter) = lastPhotos.insert(lastPhotos.end(), result);
 		}
+		result->thumb->setCacheCategory(Images::CacheCategory::Thumbnail);
+		result->medium->setCacheCategory(Images::CacheCategory::Photo);
+		result->full->setCacheCategory(Images::CacheCategory::Photo);
 		return result;
 	}
 
@@ -1765,6 +1756,7 @@ namespace {
 				}
 			}
 		}
+		result->thumb->setCacheCategory(Images::CacheCategory::Thumbnail);
 		return result;
 	}
 
@@ -1949,26 +1941,15 @@ namespace {
 	HistoryItem *histItemById(ChannelId channelId, MsgId itemId) {
 		if (!itemId) return nullptr;
 
-		auto data = fetchMsgsData(channelId, false);
-		if (!data) return nullptr;
-
-		auto i = data->constFind(itemId);
-		if (i != data->cend()) {
-			return i.value();
-		}
-		return nullptr;
+		return ::msgsIndex.find(channelId, itemId);
 	}
 
 	void historyRegItem(HistoryItem *item) {
-		MsgsData *data = fetchMsgsData(item->channelId());
-		MsgsData::const_iterator i = data->constFind(item->id);
-		if (i == data->cend()) {
-			data->insert(item->id, item);
-		} else if (i.value() != item) {
+		if (auto previous = ::msgsIndex.insert(item->channelId(), item->id, item)) {
 			LOG(("App Error: trying to historyRegItem() an already registered item"));
-			i.value()->destroy();
-			data->insert(item->id, item);
+			previous->destroy();
 		}
+		::searchIndex.add(item);
 	}
 
 	void historyItemDetached(HistoryItem *item) {
@@ -1993,15 +1974,10 @@ namespace {
 	}
 
 	void historyUnregItem(HistoryItem *item) {
-		auto data = fetchMsgsData(item->channelId(), false);
-		if (!data) return;
+		::searchIndex.remove(item);
+		if (!::msgsIndex.hasChannel(item->channelId())) return;
 
-		auto i = data->find(item->id);
-		if (i != data->cend()) {
-			if (i.value() == item) {
-				data->erase(i);
-			}
-		}
+		::msgsIndex.remove(item->channelId(), item->id, item);
 		historyItemDetached(item);
 		auto j = ::dependentItems.find(item);
 		if (j != ::dependentItems.cend()) {
@@ -2022,6 +1998,9 @@ namespace {
 	}
 
 	void historyUpdateDependent(HistoryItem *item) {
+		::searchIndex.remove(item);
+		::searchIndex.add(item);
+
 		DependentItems::iterator j = ::dependentItems.find(item);
 		if (j != ::dependentItems.cend()) {
 			for_const (HistoryItem *dependent, j.value()) {
@@ -2037,20 +2016,13 @@ namespace {
 		::dependentItems.clear();
 
 		QVector<HistoryItem*> toDelete;
-		for_const (HistoryItem *item, msgsData) {
+		::msgsIndex.enumerate([&toDelete](HistoryItem *item) {
 			if (item->detached()) {
 				toDelete.push_back(item);
 			}
-		}
-		for_const (const MsgsData &chMsgsData, channelMsgsData) {
-			for_const (HistoryItem *item, chMsgsData) {
-				if (item->detached()) {
-					toDelete.push_back(item);
-				}
-			}
-		}
-		msgsData.clear();
-		channelMsgsData.clear();
+		});
+		::msgsIndex.clear();
+		::searchIndex.clear();
 		for (int32 i = 0, l = toDelete.size(); i < l; ++i) {
 			delete toDelete[i];
 		}
@@ -2133,6 +2105,14 @@ namespace {
 		}
 	}
 
+	bool historyHasDependents(HistoryItem *dependency) {
+		return ::dependentItems.contains(dependency);
+	}
+
+	QVector<HistoryItem*> historySearchLoaded(History *history, const QString &query) {
+		return ::searchIndex.query(history, query);
+	}
+
 	void historyRegRandom(uint64 randomId, const FullMsgId &itemId) {
 		randomData.insert(randomId, itemId);
 	}
@@ -2297,6 +2277,7 @@ namespace {
 			if (update.paletteChanged()) {
 				clearCorners();
 				createCorners();
+				clearUserpicAtlases();
 
 				if (App::main()) {
 					App::main()->updateScrollColors();
@@ -2324,10 +2305,9 @@ namespace {
 
 		histories().clear();
 
+		clearUserpicAtlases();
 		clearStorageImages();
 		cSetServerBackgrounds(WallPapers());
-
-		serviceImageCacheSize = imageCacheSize();
 	}
 
 	void deinitMedia() {
@@ -2343,6 +2323,7 @@ namespace {
 
 		Data::clearGlobalStructures();
 
+		clearUserpicAtlases();
 		clearAllImages();
 	}
 
@@ -2441,11 +2422,7 @@ namespace {
 	}
 
 	void checkImageCacheSize() {
-		int64 nowImageCacheSize = imageCacheSize();
-		if (nowImageCacheSize > serviceImageCacheSize + MemoryForImageCache) {
-			App::forgetMedia();
-			serviceImageCacheSize = imageCacheSize();
-		}
+		trimImageCache();
 	}
 
 	bool isValidPhone(QString phone) {
@@ -189,6 +189,10 @@ namespace App {
 	void historyClearItems();
 	void historyRegDependency(HistoryItem *dependent, HistoryItem *dependency);
 	void historyUnregDependency(HistoryItem *dependent, HistoryItem *dependency);
+	bool historyHasDependents(HistoryItem *dependency);
+
+	// Finds the loaded messages of the history by the words of their text.
+	QVector<HistoryItem*> historySearchLoaded(History *history, const QString &query);
 
 	void historyRegRandom(uint64 randomId, const FullMsgId &itemId);
 	void historyUnregRandom(uint64 randomId);
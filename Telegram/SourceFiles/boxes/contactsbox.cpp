@@ -1582,40 +1582,9 @@ void ContactsBox::Inner::updateFilter(QString filter) {
 
 			_filtered.clear();
 			if (!f.isEmpty()) {
-				const Dialogs::List *toFilter = nullptr;
-				if (!_contacts->isEmpty()) {
-					for (fi = fb; fi != fe; ++fi) {
-						auto found = _contacts->filtered(fi->at(0));
-						if (found->isEmpty()) {
-							toFilter = nullptr;
-							break;
-						}
-						if (!toFilter || toFilter->size() > found->size()) {
-							toFilter = found;
-						}
-					}
-				}
-				if (toFilter) {
-					_filtered.reserve(toFilter->size());
-					for_const (auto row, *toFilter) {
-						const PeerData::Names &names(row->history()->peer->names);
-						PeerData::Names::const_iterator nb = names.cbegin(), ne = names.cend(), ni;
-						for (fi = fb; fi != fe; ++fi) {
-							QString filterName(*fi);
-							for (ni = nb; ni != ne; ++ni) {
-								if (ni->startsWith(*fi)) {
-									break;
-								}
-							}
-							if (ni == ne) {
-								break;
-							}
-						}
-						if (fi == fe) {
-							row->attached = nullptr;
-							_filtered.push_back(row);
-						}
-					}
+				_filtered = _contacts->filtered(f);
+				for_const (auto row, _filtered) {
+					row->attached = nullptr;
 				}
 
 				_byUsernameFiltered.reserve(_byUsername.size());
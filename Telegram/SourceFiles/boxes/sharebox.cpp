@@ -700,44 +700,9 @@ void ShareBox::Inner::updateFilter(QString filter) {
 		if (_filter.isEmpty()) {
 			refresh();
 		} else {
-			QStringList::const_iterator fb = f.cbegin(), fe = f.cend(), fi;
-
 			_filtered.clear();
 			if (!f.isEmpty()) {
-				const Dialogs::List *toFilter = nullptr;
-				if (!_chatsIndexed->isEmpty()) {
-					for (fi = fb; fi != fe; ++fi) {
-						auto found = _chatsIndexed->filtered(fi->at(0));
-						if (found->isEmpty()) {
-							toFilter = nullptr;
-							break;
-						}
-						if (!toFilter || toFilter->size() > found->size()) {
-							toFilter = found;
-						}
-					}
-				}
-				if (toFilter) {
-					_filtered.reserve(toFilter->size());
-					for_const (auto row, *toFilter) {
-						auto &names = row->history()->peer->names;
-						PeerData::Names::const_iterator nb = names.cbegin(), ne = names.cend(), ni;
-						for (fi = fb; fi != fe; ++fi) {
-							auto filterName = *fi;
-							for (ni = nb; ni != ne; ++ni) {
-								if (ni->startsWith(*fi)) {
-									break;
-								}
-							}
-							if (ni == ne) {
-								break;
-							}
-						}
-						if (fi == fe) {
-							_filtered.push_back(row);
-						}
-					}
-				}
+				_filtered = _chatsIndexed->filtered(f);
 			}
 			refresh();
 
@@ -36,6 +36,7 @@ enum {
 	MTPCheckResendTimeout = 10000, // how much time passed from send till we resend request or check it's state, in ms
 	MTPCheckResendWaiting = 1000, // how much time to wait for some more requests, when resending request or checking it's state, in ms
 	MTPAckSendWaiting = 10000, // how much time to wait for some more requests, when sending msg acks
+	MTPAckSendMaxCount = 256, // do not wait for some more requests, when that much msg acks are waiting
 	MTPResendThreshold = 1, // how much ints should message contain for us not to resend, but to check it's state
 	MTPContainerLives = 600, // container lives 10 minutes in haveSent map
 	MTPMinReceiveDelay = 4000, // 4 seconds
@@ -45,6 +46,8 @@ enum {
 	MTPConnectionOldTimeout = 192000, // 192 seconds
 	MTPTcpConnectionWaitTimeout = 2000, // 2 seconds waiting for tcp, until we accept http
 	MTPIPv4ConnectionWaitTimeout = 1000, // 1 seconds waiting for ipv4, until we accept ipv6
+	MTPRaceEndpointsCount = 3, // race up to 3 endpoints of the same dc for each address family
+	MTPUnknownEndpointRtt = 500, // rank endpoints we never connected to as if their handshake took 500 ms
 	MTPMillerRabinIterCount = 30, // 30 Miller-Rabin iterations for dh_prime primality check
 
 	MTPUploadSessionsCount = 2, // max 2 upload sessions is created
@@ -54,6 +57,8 @@ enum {
 	MTPEnumDCTimeout = 8000, // 8 seconds timeout for help_getConfig to work (then move to other dc)
 
 	MTPDebugBufferSize = 1024 * 1024, // 1 mb start size
+	MTPPacketLogQueueBytes = 4 * 1024 * 1024, // drop logged packets while 4 mb of them wait to be serialized
+	MTPPacketLogQueueCount = 1024, // drop logged packets while 1024 of them wait to be serialized
 
 	MaxUsersPerInvite = 100, // max users in one super group invite request
 
@@ -61,6 +66,11 @@ enum {
 	MTPPingSendAfterAuto = 30, // send new ping starting from 30 seconds (add to existing container)
 	MTPPingSendAfter = 45, // send new ping after 45 seconds without ping
 
+	MTPFutureSaltsCount = 32, // request 32 future server salts at once (each is valid for about an hour)
+	MTPServerSaltsRequestBefore = 3 * 3600, // request new salts when the known ones are valid for less than 3 hours
+	MTPServerSaltValidityMargin = 60, // do not send with a salt that expires in less than 1 minute
+	MTPFutureSaltsRequestTimeout = 60000, // request future salts again if the answer did not come in 1 minute
+
 	MTPChannelGetDifferenceLimit = 100,
 
 	MaxSelectedItems = 100,
@@ -126,6 +136,7 @@ enum {
 	ShortcutsCountLimit = 256, // how many shortcuts can be in json file
 
 	PreloadHeightsCount = 3, // when 3 screens to scroll left make a preload request
+	UnloadHeightsCount = 16, // history blocks more than 16 screens away from the visible area are unloaded
 	EmojiPanPerRow = 7,
 	EmojiPanRowsPerPage = 6,
 	StickerPanPerRow = 5,
@@ -378,7 +389,11 @@ enum {
 	WaitForSkippedTimeout = 1000, // 1s wait for skipped seq or pts in updates
 	WaitForChannelGetDifference = 1000, // 1s wait after show channel history before sending getChannelDifference
 
-	MemoryForImageCache = 64 * 1024 * 1024, // after 64mb of unpacked images we try to clear some memory
+	MemoryForThumbnailsCache = 16 * 1024 * 1024, // keep up to 16mb of unpacked thumbnails, least recently used are freed first
+	MemoryForPhotosCache = 64 * 1024 * 1024, // keep up to 64mb of unpacked photos
+	MemoryForStickersCache = 32 * 1024 * 1024, // keep up to 32mb of unpacked stickers
+	MemoryForUserpicsCache = 16 * 1024 * 1024, // keep up to 16mb of unpacked userpics
+	MemoryForOtherImagesCache = 32 * 1024 * 1024, // keep up to 32mb of all other unpacked images
 	NotifySettingSaveTimeout = 1000, // wait 1 second before saving notify setting to server
 	UpdateChunk = 100 * 1024, // 100kb parts when downloading the update
 	IdleMsecs = 60 * 1000, // after 60secs without user input we think we are idle
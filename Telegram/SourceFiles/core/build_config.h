@@ -64,6 +64,11 @@ Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
 #error Please add support for your architecture in core/build_config.h
 #endif
 
+// SSE2 is always there on x86-64, for 32 bit builds it should be enabled in the compiler.
+#if defined(ARCH_CPU_X86_64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ARCH_CPU_SSE2 1
+#endif
+
 #if defined(COMPILER_GCC) || defined(COMPILER_CLANG)
 #define WARN_UNUSED_RESULT __attribute__((warn_unused_result))
 #else
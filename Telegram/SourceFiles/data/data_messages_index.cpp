@@ -0,0 +1,155 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
+*/
+#include "stdafx.h"
+#include "data/data_messages_index.h"
+
+namespace Data {
+namespace {
+
+constexpr auto kMinCapacity = 64;
+
+// The table is grown when it is filled more than by 3/4.
+constexpr auto kMaxLoadNumerator = 3;
+constexpr auto kMaxLoadDenominator = 4;
+
+inline uint32 hashKey(uint64 key) {
+	// The finalizer of MurmurHash3, so that the sequential ids
+	// are spread all over the table instead of a single cluster.
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ULL;
+	key ^= key >> 33;
+	return uint32(key);
+}
+
+} // namespace
+
+HistoryItem *MessagesIndex::find(ChannelId channelId, MsgId msgId) const {
+	if (!_count) return nullptr;
+
+	auto index = findIndex(ComposeKey(channelId, msgId));
+	return (index >= 0) ? _entries[index].item : nullptr;
+}
+
+HistoryItem *MessagesIndex::insert(ChannelId channelId, MsgId msgId, HistoryItem *item) {
+	t_assert(item != nullptr);
+
+	if ((_count + 1) * kMaxLoadDenominator > int(_entries.size()) * kMaxLoadNumerator) {
+		rehash(_entries.empty() ? kMinCapacity : int(_entries.size()) * 2);
+	}
+
+	auto key = ComposeKey(channelId, msgId);
+	auto index = slotIndex(key);
+	auto &entry = _entries[index];
+	if (entry.item) {
+		auto result = entry.item;
+		entry.item = item;
+		return (result == item) ? nullptr : result;
+	}
+	entry.key = key;
+	entry.item = item;
+	++_count;
+	if (channelId != NoChannel) {
+		rangeAdded(channelId, msgId);
+	}
+	return nullptr;
+}
+
+void MessagesIndex::remove(ChannelId channelId, MsgId msgId, HistoryItem *item) {
+	if (!_count) return;
+
+	auto index = findIndex(ComposeKey(channelId, msgId));
+	if (index < 0 || _entries[index].item != item) {
+		return;
+	}
+
+	// Backward shift deletion: move the following entries of the cluster
+	// to the freed slot while it is not before their home slot, so that
+	// no tombstones are needed and the lookups stop at the first hole.
+	auto mask = int(_entries.size()) - 1;
+	for (auto next = (index + 1) & mask; _entries[next].item; next = (next + 1) & mask) {
+		auto home = int(hashKey(_entries[next].key)) & mask;
+		auto homeInGap = (index <= next) ? (index < home && home <= next) : (index < home || home <= next);
+		if (!homeInGap) {
+			_entries[index] = _entries[next];
+			index = next;
+		}
+	}
+	_entries[index] = Entry();
+	--_count;
+}
+
+bool MessagesIndex::hasChannel(ChannelId channelId) const {
+	return (channelId == NoChannel) || _channelRanges.contains(channelId);
+}
+
+bool MessagesIndex::mayContain(ChannelId channelId, MsgId msgId) const {
+	if (channelId == NoChannel) {
+		return true;
+	}
+	auto i = _channelRanges.constFind(channelId);
+	return (i != _channelRanges.cend()) && (msgId >= i.value().min) && (msgId <= i.value().max);
+}
+
+void MessagesIndex::clear() {
+	_entries = std::vector<Entry>();
+	_count = 0;
+	_channelRanges.clear();
+}
+
+int MessagesIndex::slotIndex(uint64 key) const {
+	auto mask = int(_entries.size()) - 1;
+	auto index = int(hashKey(key)) & mask;
+	while (_entries[index].item && _entries[index].key != key) {
+		index = (index + 1) & mask;
+	}
+	return index;
+}
+
+int MessagesIndex::findIndex(uint64 key) const {
+	auto index = slotIndex(key);
+	return _entries[index].item ? index : -1;
+}
+
+void MessagesIndex::rehash(int capacity) {
+	auto entries = std::vector<Entry>(capacity);
+	std::swap(entries, _entries);
+	for (auto &entry : entries) {
+		if (entry.item) {
+			_entries[slotIndex(entry.key)] = entry;
+		}
+	}
+}
+
+void MessagesIndex::rangeAdded(ChannelId channelId, MsgId msgId) {
+	// The range is not narrowed when the items are removed.
+	auto i = _channelRanges.find(channelId);
+	if (i == _channelRanges.end()) {
+		i = _channelRanges.insert(channelId, ChannelRange());
+		i.value().min = i.value().max = msgId;
+	} else {
+		accumulate_min(i.value().min, msgId);
+		accumulate_max(i.value().max, msgId);
+	}
+}
+
+} // namespace Data
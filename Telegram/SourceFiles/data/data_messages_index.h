@@ -0,0 +1,91 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
+*/
+#pragma once
+
+class HistoryItem;
+
+namespace Data {
+
+// All the registered history items by their FullMsgId in one open
+// addressing (linear probing) table, so that a lookup of a channel
+// message is a single probe, same as for the other messages.
+//
+// The registered ids range is kept for every channel separately until
+// clear(), so that the bulk deletes can skip the ids that were never
+// registered and the channels that never had any registered items.
+class MessagesIndex {
+public:
+	MessagesIndex() = default;
+	MessagesIndex(const MessagesIndex &other) = delete;
+	MessagesIndex &operator=(const MessagesIndex &other) = delete;
+
+	HistoryItem *find(ChannelId channelId, MsgId msgId) const;
+
+	// Returns the item previously registered with the same id (if it
+	// was not the same one), the caller decides what to do with it.
+	HistoryItem *insert(ChannelId channelId, MsgId msgId, HistoryItem *item);
+
+	// Removes the id only if it is registered for the passed item.
+	void remove(ChannelId channelId, MsgId msgId, HistoryItem *item);
+
+	bool hasChannel(ChannelId channelId) const;
+	bool mayContain(ChannelId channelId, MsgId msgId) const;
+
+	template <typename Callback>
+	void enumerate(Callback callback) const {
+		for (auto &entry : _entries) {
+			if (entry.item) {
+				callback(entry.item);
+			}
+		}
+	}
+
+	int size() const {
+		return _count;
+	}
+	void clear();
+
+private:
+	struct Entry {
+		uint64 key = 0;
+		HistoryItem *item = nullptr;
+	};
+	struct ChannelRange {
+		MsgId min = 0;
+		MsgId max = 0;
+	};
+
+	static uint64 ComposeKey(ChannelId channelId, MsgId msgId) {
+		return (uint64(uint32(channelId)) << 32) | uint64(uint32(msgId));
+	}
+	int slotIndex(uint64 key) const;
+	int findIndex(uint64 key) const; // -1 if not found
+	void rehash(int capacity);
+
+	void rangeAdded(ChannelId channelId, MsgId msgId);
+
+	std::vector<Entry> _entries;
+	int _count = 0;
+	QHash<ChannelId, ChannelRange> _channelRanges;
+
+};
+
+} // namespace Data
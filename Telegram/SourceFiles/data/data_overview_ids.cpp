@@ -0,0 +1,199 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
+*/
+#include "stdafx.h"
+#include "data/data_overview_ids.h"
+
+namespace Data {
+namespace {
+
+// A chunk is split in two when it grows larger than kChunkSize and
+// is merged with a neighbour when it becomes smaller than a quarter.
+constexpr auto kChunkSize = 256;
+constexpr auto kChunkMergeSize = kChunkSize / 4;
+
+} // namespace
+
+MsgId OverviewIds::at(int index) const {
+	t_assert(index >= 0 && index < _count);
+
+	// Descend the tree to the last chunk with not more than index ids before it.
+	auto count = int(_chunks.size());
+	auto step = 1;
+	while (step * 2 <= count) {
+		step *= 2;
+	}
+	auto chunk = 0;
+	for (; step > 0; step /= 2) {
+		if (chunk + step <= count && _sizes[chunk + step] <= index) {
+			chunk += step;
+			index -= _sizes[chunk];
+		}
+	}
+	return _chunks[chunk][index];
+}
+
+int OverviewIds::findChunk(MsgId msgId) const {
+	// The first chunk that could contain the id (or the last one).
+	auto i = std::lower_bound(_chunks.cbegin(), _chunks.cend(), msgId, [](const std::vector<MsgId> &chunk, MsgId msgId) {
+		return Less(chunk.back(), msgId);
+	});
+	if (i == _chunks.cend()) {
+		return int(_chunks.size()) - 1;
+	}
+	return int(i - _chunks.cbegin());
+}
+
+int OverviewIds::lowerBound(MsgId msgId) const {
+	if (_chunks.empty()) {
+		return 0;
+	}
+	auto chunk = findChunk(msgId);
+	auto &ids = _chunks[chunk];
+	auto i = std::lower_bound(ids.cbegin(), ids.cend(), msgId, Less);
+	return chunkOffset(chunk) + int(i - ids.cbegin());
+}
+
+int OverviewIds::indexOf(MsgId msgId) const {
+	if (_chunks.empty()) {
+		return -1;
+	}
+	auto chunk = findChunk(msgId);
+	auto &ids = _chunks[chunk];
+	auto i = std::lower_bound(ids.cbegin(), ids.cend(), msgId, Less);
+	if (i == ids.cend() || *i != msgId) {
+		return -1;
+	}
+	return chunkOffset(chunk) + int(i - ids.cbegin());
+}
+
+bool OverviewIds::insert(MsgId msgId) {
+	if (_chunks.empty()) {
+		_chunks.push_back(std::vector<MsgId>(1, msgId));
+		_count = 1;
+		rebuildSizes();
+		return true;
+	}
+	auto chunk = findChunk(msgId);
+	auto &ids = _chunks[chunk];
+	auto i = std::lower_bound(ids.begin(), ids.end(), msgId, Less);
+	if (i != ids.end() && *i == msgId) {
+		return false;
+	}
+	ids.insert(i, msgId);
+	++_count;
+	if (int(ids.size()) > kChunkSize) {
+		splitChunk(chunk);
+		rebuildSizes();
+	} else {
+		addToSize(chunk, 1);
+	}
+	return true;
+}
+
+bool OverviewIds::remove(MsgId msgId) {
+	if (_chunks.empty()) {
+		return false;
+	}
+	auto chunk = findChunk(msgId);
+	auto &ids = _chunks[chunk];
+	auto i = std::lower_bound(ids.begin(), ids.end(), msgId, Less);
+	if (i == ids.end() || *i != msgId) {
+		return false;
+	}
+	ids.erase(i);
+	--_count;
+	if (ids.empty()) {
+		_chunks.erase(_chunks.begin() + chunk);
+		rebuildSizes();
+	} else if (int(ids.size()) < kChunkMergeSize && mergeChunk(chunk)) {
+		rebuildSizes();
+	} else {
+		addToSize(chunk, -1);
+	}
+	return true;
+}
+
+int OverviewIds::localCount() const {
+	// Negative ids are the largest ones in Less().
+	return _count - lowerBound(std::numeric_limits<MsgId>::min());
+}
+
+void OverviewIds::clear() {
+	_chunks.clear();
+	_sizes.clear();
+	_count = 0;
+}
+
+void OverviewIds::splitChunk(int chunk) {
+	auto &ids = _chunks[chunk];
+	auto middle = ids.begin() + (ids.size() / 2);
+	auto second = std::vector<MsgId>(middle, ids.end());
+	ids.erase(middle, ids.end());
+	_chunks.insert(_chunks.begin() + chunk + 1, std_::move(second));
+}
+
+bool OverviewIds::mergeChunk(int chunk) {
+	auto size = [this](int index) {
+		return int(_chunks[index].size());
+	};
+	auto mergeWithNext = [this](int index) {
+		auto &ids = _chunks[index];
+		auto &next = _chunks[index + 1];
+		ids.insert(ids.end(), next.cbegin(), next.cend());
+		_chunks.erase(_chunks.begin() + index + 1);
+	};
+	if (chunk + 1 < int(_chunks.size()) && size(chunk) + size(chunk + 1) <= kChunkSize) {
+		mergeWithNext(chunk);
+		return true;
+	} else if (chunk > 0 && size(chunk - 1) + size(chunk) <= kChunkSize) {
+		mergeWithNext(chunk - 1);
+		return true;
+	}
+	return false;
+}
+
+void OverviewIds::rebuildSizes() {
+	auto count = int(_chunks.size());
+	_sizes.assign(count + 1, 0);
+	for (auto i = 1; i <= count; ++i) {
+		_sizes[i] += int(_chunks[i - 1].size());
+		auto parent = i + (i & -i);
+		if (parent <= count) {
+			_sizes[parent] += _sizes[i];
+		}
+	}
+}
+
+void OverviewIds::addToSize(int chunk, int delta) {
+	for (auto i = chunk + 1, count = int(_chunks.size()); i <= count; i += (i & -i)) {
+		_sizes[i] += delta;
+	}
+}
+
+int OverviewIds::chunkOffset(int chunk) const {
+	auto result = 0;
+	for (auto i = chunk; i > 0; i -= (i & -i)) {
+		result += _sizes[i];
+	}
+	return result;
+}
+
+} // namespace Data
@@ -0,0 +1,128 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
+*/
+#pragma once
+
+namespace Data {
+
+// Message ids of a shared media overview, sorted in the order of the
+// messages in the history: server ids ascending and then the local ids
+// of the messages that are being sent, in the order they were created.
+//
+// The ids are kept in a list of small sorted chunks, so that inserting
+// or erasing an id in the middle moves only the ids of a single chunk.
+// The chunk sizes are summed in a Fenwick tree, so the rank of an id and
+// the id by its rank are found and updated in logarithmic time.
+class OverviewIds {
+public:
+	class const_iterator {
+	public:
+		MsgId operator*() const {
+			return (*_chunks)[_chunk][_index];
+		}
+		const_iterator &operator++() {
+			if (++_index == int((*_chunks)[_chunk].size())) {
+				++_chunk;
+				_index = 0;
+			}
+			return *this;
+		}
+		bool operator==(const const_iterator &other) const {
+			return (_chunk == other._chunk) && (_index == other._index);
+		}
+		bool operator!=(const const_iterator &other) const {
+			return !(*this == other);
+		}
+
+	private:
+		friend class OverviewIds;
+		const_iterator(const std::vector<std::vector<MsgId>> *chunks, int chunk, int index)
+		: _chunks(chunks)
+		, _chunk(chunk)
+		, _index(index) {
+		}
+
+		const std::vector<std::vector<MsgId>> *_chunks;
+		int _chunk;
+		int _index;
+
+	};
+
+	const_iterator begin() const {
+		return const_iterator(&_chunks, 0, 0);
+	}
+	const_iterator end() const {
+		return const_iterator(&_chunks, int(_chunks.size()), 0);
+	}
+
+	int size() const {
+		return _count;
+	}
+	bool isEmpty() const {
+		return !_count;
+	}
+	MsgId at(int index) const;
+	MsgId operator[](int index) const {
+		return at(index);
+	}
+	MsgId front() const {
+		return _chunks.front().front();
+	}
+	MsgId back() const {
+		return _chunks.back().back();
+	}
+
+	// Returns the rank of the id or -1 if it is not in the list.
+	int indexOf(MsgId msgId) const;
+	bool contains(MsgId msgId) const {
+		return indexOf(msgId) >= 0;
+	}
+
+	// Both return false if nothing was changed.
+	bool insert(MsgId msgId);
+	bool remove(MsgId msgId);
+
+	// The ids of the messages that are being sent are all at the end.
+	int localCount() const;
+
+	void clear();
+
+	static bool Less(MsgId a, MsgId b) {
+		return uint32(a) < uint32(b);
+	}
+
+private:
+	int findChunk(MsgId msgId) const;
+	int lowerBound(MsgId msgId) const;
+	void splitChunk(int chunk);
+	bool mergeChunk(int chunk);
+
+	// The tree is rebuilt only when the chunks are split or merged.
+	void rebuildSizes();
+	void addToSize(int chunk, int delta);
+	int chunkOffset(int chunk) const; // count of ids before the chunk
+
+	std::vector<std::vector<MsgId>> _chunks;
+	std::vector<int> _sizes; // Fenwick tree of the chunk sizes, 1-based
+	int _count = 0;
+
+};
+
+} // namespace Data
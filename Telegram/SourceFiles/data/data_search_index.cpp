@@ -0,0 +1,160 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
+*/
+#include "stdafx.h"
+#include "data/data_search_index.h"
+
+namespace Data {
+namespace {
+
+QStringList searchWords(const QString &text) {
+	auto result = textSearchKey(text).split(cWordSplit(), QString::SkipEmptyParts);
+	result.removeDuplicates();
+	return result;
+}
+
+QString itemSearchText(HistoryItem *item) {
+	auto result = item->originalText().text;
+	if (auto media = item->getMedia()) {
+		auto caption = media->getCaption().text;
+		if (!caption.isEmpty()) {
+			result += '\n' + caption;
+		}
+	}
+	return result;
+}
+
+bool wordsHavePrefix(const QStringList &words, const QString &prefix) {
+	for_const (auto &word, words) {
+		if (word.startsWith(prefix)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+} // namespace
+
+void MessagesSearchIndex::add(HistoryItem *item) {
+	if (_indexed.contains(item->history())) {
+		addIndexed(item);
+	}
+}
+
+void MessagesSearchIndex::addIndexed(HistoryItem *item) {
+	auto words = searchWords(itemSearchText(item));
+	if (words.isEmpty()) {
+		return;
+	}
+	auto history = item->history();
+	auto &byWord = _words[history];
+	for_const (auto &word, words) {
+		byWord[word].insert(item);
+	}
+	_items.insert(item, { history, words });
+}
+
+void MessagesSearchIndex::remove(HistoryItem *item) {
+	auto i = _items.find(item);
+	if (i == _items.cend()) {
+		return;
+	}
+	auto history = i.value().history;
+	auto j = _words.find(history);
+	if (j != _words.cend()) {
+		auto &byWord = j.value();
+		for_const (auto &word, i.value().words) {
+			auto k = byWord.find(word);
+			if (k != byWord.cend()) {
+				k.value().remove(item);
+				if (k.value().isEmpty()) {
+					byWord.erase(k);
+				}
+			}
+		}
+		if (byWord.isEmpty()) {
+			_words.erase(j);
+		}
+	}
+	_items.erase(i);
+}
+
+QVector<HistoryItem*> MessagesSearchIndex::query(History *history, const QString &query) {
+	auto result = QVector<HistoryItem*>();
+	auto words = searchWords(query);
+	if (words.isEmpty()) {
+		return result;
+	}
+	if (!_indexed.contains(history)) {
+		_indexed.insert(history);
+		for_const (auto block, history->blocks) {
+			for_const (auto item, block->items) {
+				addIndexed(item);
+			}
+		}
+	}
+	auto i = _words.constFind(history);
+	if (i == _words.cend()) {
+		return result;
+	}
+
+	// Collect the candidates by the longest query word, it usually
+	// has the least matches, and check the rest word by word.
+	auto &byWord = i.value();
+	auto longest = std::max_element(words.cbegin(), words.cend(), [](const QString &a, const QString &b) {
+		return a.size() < b.size();
+	});
+	auto candidates = QSet<HistoryItem*>();
+	for (auto j = byWord.lowerBound(*longest), e = byWord.cend(); j != e && j.key().startsWith(*longest); ++j) {
+		candidates.unite(j.value());
+	}
+	for_const (auto item, candidates) {
+		auto &itemWords = _items.constFind(item).value().words;
+		auto good = true;
+		for_const (auto &word, words) {
+			if (!wordsHavePrefix(itemWords, word)) {
+				good = false;
+				break;
+			}
+		}
+		if (good) {
+			result.push_back(item);
+		}
+	}
+	std::sort(result.begin(), result.end(), &MessagesSearchIndex::NewerFirst);
+	return result;
+}
+
+void MessagesSearchIndex::clear() {
+	_indexed.clear();
+	_words.clear();
+	_items.clear();
+}
+
+bool MessagesSearchIndex::NewerFirst(const HistoryItem *a, const HistoryItem *b) {
+	if (a->date != b->date) {
+		return (a->date > b->date);
+	} else if ((a->id < 0) != (b->id < 0)) {
+		return (a->id < 0); // the message being sent is newer
+	}
+	return (a->id > b->id); // client ids grow with the send order
+}
+
+} // namespace Data
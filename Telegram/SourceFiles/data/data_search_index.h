@@ -0,0 +1,69 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
+*/
+#pragma once
+
+class History;
+class HistoryItem;
+
+namespace Data {
+
+// Words of the texts of all the loaded messages, so that a search in
+// a chat can show the matching messages that we already have without
+// waiting for the server (or without the connection at all).
+//
+// The words are folded by textSearchKey() and every query word is
+// matched as a prefix, same as in the chats list filter.
+//
+// A history is indexed on the first search in it, after that
+// the added and edited messages of that history are kept indexed.
+class MessagesSearchIndex {
+public:
+	MessagesSearchIndex() = default;
+	MessagesSearchIndex(const MessagesSearchIndex &other) = delete;
+	MessagesSearchIndex &operator=(const MessagesSearchIndex &other) = delete;
+
+	void add(HistoryItem *item);
+	void remove(HistoryItem *item);
+
+	// Returns the messages from the newest to the oldest one.
+	QVector<HistoryItem*> query(History *history, const QString &query);
+
+	void clear();
+
+	// Messages being sent have negative client ids, so they're ordered by date.
+	static bool NewerFirst(const HistoryItem *a, const HistoryItem *b);
+
+private:
+	void addIndexed(HistoryItem *item);
+
+	using ItemsByWord = QMap<QString, QSet<HistoryItem*>>;
+	struct IndexedItem {
+		History *history;
+		QStringList words;
+	};
+
+	OrderedSet<History*> _indexed;
+	QHash<History*, ItemsByWord> _words;
+	QHash<HistoryItem*, IndexedItem> _items;
+
+};
+
+} // namespace Data
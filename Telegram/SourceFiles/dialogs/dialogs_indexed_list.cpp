@@ -22,6 +22,41 @@ Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
 #include "dialogs/dialogs_indexed_list.h"
 
 namespace Dialogs {
+namespace {
+
+bool PeerMatchesFilter(PeerData *peer, const QStringList &words) {
+	auto &names = peer->names;
+	for_const (auto &word, words) {
+		auto found = false;
+		for_const (auto &name, names) {
+			if (name.startsWith(word)) {
+				found = true;
+				break;
+			}
+		}
+		if (!found) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Each word of the previous filter is a prefix of the word
+// at the same position in the new one, so any peer matching
+// the new filter is already in the previous filter result.
+bool FilterNarrows(const QStringList &was, const QStringList &now) {
+	if (was.isEmpty() || was.size() > now.size()) {
+		return false;
+	}
+	for (auto i = 0, count = was.size(); i != count; ++i) {
+		if (!now[i].startsWith(was[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace
 
 IndexedList::IndexedList(SortMode sortMode)
 : _sortMode(sortMode)
@@ -31,6 +66,7 @@ IndexedList::IndexedList(SortMode sortMode)
 RowsByLetter IndexedList::addToEnd(History *history) {
 	RowsByLetter result;
 	if (!_list.contains(history->peer->id)) {
+		namesChanged();
 		result.insert(0, _list.addToEnd(history));
 		for_const (auto ch, history->peer->chars) {
 			auto j = _index.find(ch);
@@ -48,6 +84,7 @@ Row *IndexedList::addByName(History *history) {
 		return row;
 	}
 
+	namesChanged();
 	Row *result = _list.addByName(history);
 	for_const (auto ch, history->peer->chars) {
 		auto j = _index.find(ch);
@@ -60,6 +97,7 @@ Row *IndexedList::addByName(History *history) {
 }
 
 void IndexedList::adjustByPos(const RowsByLetter &links) {
+	orderChanged();
 	for (auto i = links.cbegin(), e = links.cend(); i != e; ++i) {
 		if (i.key() == QChar(0)) {
 			_list.adjustByPos(i.value());
@@ -73,6 +111,7 @@ void IndexedList::adjustByPos(const RowsByLetter &links) {
 
 void IndexedList::moveToTop(PeerData *peer) {
 	if (_list.moveToTop(peer->id)) {
+		orderChanged();
 		for_const (auto ch, peer->chars) {
 			if (auto list = _index.value(ch)) {
 				list->moveToTop(peer->id);
@@ -83,6 +122,7 @@ void IndexedList::moveToTop(PeerData *peer) {
 
 void IndexedList::peerNameChanged(PeerData *peer, const PeerData::Names &oldNames, const PeerData::NameFirstChars &oldChars) {
 	t_assert(_sortMode != SortMode::Date);
+	namesChanged();
 	if (_sortMode == SortMode::Name) {
 		adjustByName(peer, oldNames, oldChars);
 	} else {
@@ -92,6 +132,7 @@ void IndexedList::peerNameChanged(PeerData *peer, const PeerData::Names &oldName
 
 void IndexedList::peerNameChanged(Mode list, PeerData *peer, const PeerData::Names &oldNames, const PeerData::NameFirstChars &oldChars) {
 	t_assert(_sortMode == SortMode::Date);
+	namesChanged();
 	adjustNames(list, peer, oldNames, oldChars);
 }
 
@@ -166,6 +207,7 @@ void IndexedList::adjustNames(Mode list, PeerData *peer, const PeerData::Names &
 
 void IndexedList::del(const PeerData *peer, Row *replacedBy) {
 	if (_list.del(peer->id, replacedBy)) {
+		namesChanged();
 		for_const (auto ch, peer->chars) {
 			if (auto list = _index.value(ch)) {
 				list->del(peer->id, replacedBy);
@@ -180,6 +222,127 @@ void IndexedList::clear() {
 	}
 }
 
+QVector<Row*> IndexedList::filtered(const QStringList &words) const {
+	auto result = QVector<Row*>();
+	if (words.isEmpty() || _list.isEmpty()) {
+		return result;
+	}
+
+	if (FilterNarrows(_lastFilter, words)) {
+		result.reserve(_lastFiltered.size());
+		for_const (auto row, _lastFiltered) {
+			if (PeerMatchesFilter(row->history()->peer, words)) {
+				result.push_back(row);
+			}
+		}
+	} else {
+		auto longest = QString();
+		for_const (auto &word, words) {
+			if (word.size() > longest.size()) {
+				longest = word;
+			}
+		}
+		if (longest.size() > 1) {
+			result = filteredByNamesIndex(words, longest);
+		} else {
+			result = filteredByLetters(words);
+		}
+	}
+	_lastFilter = words;
+	_lastFiltered = result;
+	return result;
+}
+
+QVector<Row*> IndexedList::filteredByLetters(const QStringList &words) const {
+	auto result = QVector<Row*>();
+
+	// Each of the words is a single letter, the smallest letter list
+	// is the answer already, up to the other letters check.
+	const List *toFilter = nullptr;
+	for_const (auto &word, words) {
+		auto found = _index.value(word.at(0));
+		if (!found || found->isEmpty()) {
+			return result;
+		}
+		if (!toFilter || toFilter->size() > found->size()) {
+			toFilter = found;
+		}
+	}
+	result.reserve(toFilter->size());
+	for_const (auto row, *toFilter) {
+		if (PeerMatchesFilter(row->history()->peer, words)) {
+			result.push_back(row);
+		}
+	}
+	return result;
+}
+
+QVector<Row*> IndexedList::filteredByNamesIndex(const QStringList &words, const QString &longest) const {
+	auto result = QVector<Row*>();
+
+	// Every matching peer has a name starting with the longest word,
+	// so all of them have a row in the list of its first letter.
+	auto letterList = _index.value(longest.at(0));
+	if (!letterList || letterList->isEmpty()) {
+		return result;
+	}
+
+	ensureNamesIndex();
+	auto candidates = QVector<PeerData*>();
+	auto i = std::lower_bound(_namesIndex.cbegin(), _namesIndex.cend(), longest, [](const NameWord &nameWord, const QString &word) {
+		return nameWord.first < word;
+	});
+	for (auto e = _namesIndex.cend(); i != e && i->first.startsWith(longest); ++i) {
+		candidates.push_back(i->second);
+	}
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+	// The index is not updated for renames this list was not notified
+	// about, so the current names of the candidates are checked as well.
+	result.reserve(candidates.size());
+	for_const (auto peer, candidates) {
+		if (PeerMatchesFilter(peer, words)) {
+			if (auto row = letterList->getRow(peer->id)) {
+				result.push_back(row);
+			}
+		}
+	}
+	std::sort(result.begin(), result.end(), [](Row *a, Row *b) {
+		return a->pos() < b->pos();
+	});
+	return result;
+}
+
+void IndexedList::namesChanged() {
+	_namesIndexValid = false;
+	_namesIndex.clear();
+	orderChanged();
+}
+
+void IndexedList::orderChanged() {
+	_lastFilter.clear();
+	_lastFiltered.clear();
+}
+
+void IndexedList::ensureNamesIndex() const {
+	if (_namesIndexValid) {
+		return;
+	}
+	_namesIndexValid = true;
+	_namesIndex.clear();
+	_namesIndex.reserve(_list.size() * 2);
+	for_const (auto row, _list) {
+		auto peer = row->history()->peer;
+		for_const (auto &name, peer->names) {
+			_namesIndex.push_back(NameWord(name, peer));
+		}
+	}
+	std::sort(_namesIndex.begin(), _namesIndex.end(), [](const NameWord &a, const NameWord &b) {
+		return a.first < b.first;
+	});
+}
+
 IndexedList::~IndexedList() {
 	clear();
 }
@@ -48,10 +48,11 @@ public:
 	const List &all() const {
 		return _list;
 	}
-	const List *filtered(QChar ch) const {
-		static StaticNeverFreedPointer<List> empty(new List(SortMode::Add));
-		return _index.value(ch, empty.data());
-	}
+
+	// Rows having a name word starting with each of the filter words,
+	// in the order of the list. The words are expected to be prepared
+	// by textSearchKey() and split by cWordSplit().
+	QVector<Row*> filtered(const QStringList &words) const;
 
 	~IndexedList();
 
@@ -81,11 +82,30 @@ private:
 	void adjustByName(PeerData *peer, const PeerData::Names &oldNames, const PeerData::NameFirstChars &oldChars);
 	void adjustNames(Mode list, PeerData *peer, const PeerData::Names &oldNames, const PeerData::NameFirstChars &oldChars);
 
+	QVector<Row*> filteredByLetters(const QStringList &words) const;
+	QVector<Row*> filteredByNamesIndex(const QStringList &words, const QString &longest) const;
+
+	void namesChanged();
+	void orderChanged();
+	void ensureNamesIndex() const;
+
 	SortMode _sortMode;
 	List _list;
 	using Index = QMap<QChar, List*>;
 	Index _index;
 
+	// All the name words of the peers in the list, sorted, so that
+	// the peers with a name word starting with the filter word are
+	// found by a binary search. Built on demand by filtered().
+	using NameWord = QPair<QString, PeerData*>;
+	mutable std::vector<NameWord> _namesIndex;
+	mutable bool _namesIndexValid = false;
+
+	// The last filter result, if the filter only grows (another word
+	// or more letters in a word) the result is narrowed from it.
+	mutable QStringList _lastFilter;
+	mutable QVector<Row*> _lastFiltered;
+
 };
 
 } // namespace Dialogs
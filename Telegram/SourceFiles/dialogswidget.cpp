@@ -29,6 +29,7 @@ Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
 #include "ui/widgets/buttons.h"
 #include "ui/widgets/popup_menu.h"
 #include "data/data_drafts.h"
+#include "data/data_search_index.h"
 #include "lang.h"
 #include "application.h"
 #include "mainwindow.h"
@@ -937,81 +938,18 @@ void DialogsInner::onFilterUpdate(QString newFilter, bool force) {
 				_lastSearchPeer = 0;
 				_lastSearchId = _lastSearchMigratedId = 0;
 			} else {
-				QStringList::const_iterator fb = f.cbegin(), fe = f.cend(), fi;
-
 				_state = FilteredState;
 				_filterResults.clear();
 				if (!_searchInPeer && !f.isEmpty()) {
-					const Dialogs::List *toFilter = nullptr;
-					if (!_dialogs->isEmpty()) {
-						for (fi = fb; fi != fe; ++fi) {
-							auto found = _dialogs->filtered(fi->at(0));
-							if (found->isEmpty()) {
-								toFilter = nullptr;
-								break;
-							}
-							if (!toFilter || toFilter->size() > found->size()) {
-								toFilter = found;
-							}
-						}
-					}
-					const Dialogs::List *toFilterContacts = nullptr;
-					if (!_contactsNoDialogs->isEmpty()) {
-						for (fi = fb; fi != fe; ++fi) {
-							auto found = _contactsNoDialogs->filtered(fi->at(0));
-							if (found->isEmpty()) {
-								toFilterContacts = nullptr;
-								break;
-							}
-							if (!toFilterContacts || toFilterContacts->size() > found->size()) {
-								toFilterContacts = found;
-							}
-						}
-					}
-					_filterResults.reserve((toFilter ? toFilter->size() : 0) + (toFilterContacts ? toFilterContacts->size() : 0));
-					if (toFilter) {
-						for_const (auto row, *toFilter) {
-							const PeerData::Names &names(row->history()->peer->names);
-							PeerData::Names::const_iterator nb = names.cbegin(), ne = names.cend(), ni;
-							for (fi = fb; fi != fe; ++fi) {
-								QString filterName(*fi);
-								for (ni = nb; ni != ne; ++ni) {
-									if (ni->startsWith(*fi)) {
-										break;
-									}
-								}
-								if (ni == ne) {
-									break;
-								}
-							}
-							if (fi == fe) {
-								_filterResults.push_back(row);
-							}
-						}
-					}
-					if (toFilterContacts) {
-						for_const (auto row, *toFilterContacts) {
-							const PeerData::Names &names(row->history()->peer->names);
-							PeerData::Names::const_iterator nb = names.cbegin(), ne = names.cend(), ni;
-							for (fi = fb; fi != fe; ++fi) {
-								QString filterName(*fi);
-								for (ni = nb; ni != ne; ++ni) {
-									if (ni->startsWith(*fi)) {
-										break;
-									}
-								}
-								if (ni == ne) {
-									break;
-								}
-							}
-							if (fi == fe) {
-								_filterResults.push_back(row);
-							}
-						}
-					}
+					auto filteredDialogs = _dialogs->filtered(f);
+					auto filteredContacts = _contactsNoDialogs->filtered(f);
+					_filterResults.reserve(filteredDialogs.size() + filteredContacts.size());
+					_filterResults.append(filteredDialogs);
+					_filterResults.append(filteredContacts);
 				}
 			}
 		}
+		searchLoaded();
 		refresh(true);
 		setMouseSelection(false, true);
 	}
@@ -1062,6 +1000,57 @@ void DialogsInner::clearSearchResults(bool clearPeerSearchResults) {
 	_lastSearchId = _lastSearchMigratedId = 0;
 }
 
+void DialogsInner::searchLoaded() {
+	if (_searchLoadedPeer == _searchInPeer && _searchLoadedQuery == _filter) {
+		return;
+	}
+	_searchLoadedPeer = _searchInPeer;
+	_searchLoadedQuery = _filter;
+	_searchLoaded.clear();
+	if (!_searchInPeer || _filter.isEmpty()) {
+		return;
+	}
+
+	if (auto history = App::historyLoaded(_searchInPeer->id)) {
+		_searchLoaded = App::historySearchLoaded(history, _filter);
+	}
+	clearSearchResults(false);
+	for_const (auto item, _searchLoaded) {
+		_searchResults.push_back(std_::make_unique<Dialogs::FakeRow>(item));
+	}
+	_searchedCount = _searchResults.size();
+	if (_state == FilteredState && !_searchResults.isEmpty()) {
+		_state = SearchedState;
+	}
+}
+
+void DialogsInner::mergeSearchLoaded(int from, bool hasMore) {
+	auto merged = false;
+	for (auto i = _searchLoaded.begin(); i != _searchLoaded.end();) {
+		auto item = *i;
+		if (hasMore && item->id > 0 && item->id < _lastSearchId) {
+			++i; // It will be merged with one of the next pages.
+			continue;
+		}
+		i = _searchLoaded.erase(i);
+
+		// The message could be already received in one of the previous pages.
+		auto b = _searchResults.begin(), e = _searchResults.end();
+		auto found = std::find_if(b, e, [item](const std_::unique_ptr<Dialogs::FakeRow> &row) {
+			return (row->item() == item);
+		});
+		if (found == e) {
+			_searchResults.push_back(std_::make_unique<Dialogs::FakeRow>(item));
+			merged = true;
+		}
+	}
+	if (merged) {
+		std::stable_sort(_searchResults.begin() + from, _searchResults.end(), [](const std_::unique_ptr<Dialogs::FakeRow> &a, const std_::unique_ptr<Dialogs::FakeRow> &b) {
+			return Data::MessagesSearchIndex::NewerFirst(a->item(), b->item());
+		});
+	}
+}
+
 PeerData *DialogsInner::updateFromParentDrag(QPoint globalPos) {
 	_mouseSelection = true;
 	updateSelected(mapFromGlobal(globalPos));
@@ -1090,6 +1079,8 @@ void DialogsInner::setVisibleTopBottom(int visibleTop, int visibleBottom) {
 }
 
 void DialogsInner::itemRemoved(HistoryItem *item) {
+	_searchLoaded.removeOne(item);
+
 	int wasCount = _searchResults.size();
 	for (auto i = _searchResults.begin(); i != _searchResults.end();) {
 		if ((*i)->item() == item) {
@@ -1175,6 +1166,7 @@ bool DialogsInner::searchReceived(const QVector<MTPMessage> &messages, DialogsSe
 	}
 	auto isGlobalSearch = (type == DialogsSearchFromStart || type == DialogsSearchFromOffset);
 	auto isMigratedSearch = (type == DialogsSearchMigratedFromStart || type == DialogsSearchMigratedFromOffset);
+	auto firstFound = _searchResults.size();
 
 	TimeId lastDateFound = 0;
 	for_const (auto message, messages) {
@@ -1205,10 +1197,16 @@ bool DialogsInner::searchReceived(const QVector<MTPMessage> &messages, DialogsSe
 			LOG(("API Error: a search results with not message id"));
 		}
 	}
+	if (_searchInPeer && !isGlobalSearch && !isMigratedSearch) {
+		mergeSearchLoaded(firstFound, (lastDateFound != 0));
+	}
 	if (isMigratedSearch) {
 		_searchedMigratedCount = fullCount;
 	} else {
 		_searchedCount = fullCount;
+		if (_searchInPeer && !isGlobalSearch) {
+			accumulate_max(_searchedCount, _searchResults.size());
+		}
 	}
 	if (_state == FilteredState && (!_searchResults.isEmpty() || !_searchInMigrated || type == DialogsSearchMigratedFromStart || type == DialogsSearchMigratedFromOffset)) {
 		_state = SearchedState;
@@ -1412,6 +1410,9 @@ void DialogsInner::clearFilter() {
 		_lastSearchDate = 0;
 		_lastSearchPeer = 0;
 		_lastSearchId = _lastSearchMigratedId = 0;
+		_searchLoaded.clear();
+		_searchLoadedPeer = nullptr;
+		_searchLoadedQuery = QString();
 		_filter = QString();
 		refresh(true);
 	}
@@ -2342,6 +2343,12 @@ void DialogsWidget::searchReceived(DialogsSearchRequestType type, const MTPmessa
 	}
 
 	if (_searchRequest == req) {
+		if (_searchInPeer && _searchQuery != _filter->getLastText().trimmed()) {
+			// Results for the new query are already shown from the loaded
+			// messages, they will be merged with the next request results.
+			_searchRequest = 0;
+			return;
+		}
 		switch (result.type()) {
 		case mtpc_messages_messages: {
 			auto &d(result.c_messages_messages());
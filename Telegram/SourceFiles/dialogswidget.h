@@ -202,6 +202,8 @@ private:
 
 	void clearSelection();
 	void clearSearchResults(bool clearPeerSearchResults = true);
+	void searchLoaded();
+	void mergeSearchLoaded(int from, bool hasMore);
 	void updateSelectedRow(PeerData *peer = 0);
 
 	Dialogs::IndexedList *shownDialogs() const {
@@ -252,6 +254,12 @@ private:
 	MsgId _lastSearchId = 0;
 	MsgId _lastSearchMigratedId = 0;
 
+	// Already loaded messages of _searchInPeer found by the filter, they
+	// are shown right away and merged with the server results by pages.
+	QVector<HistoryItem*> _searchLoaded;
+	PeerData *_searchLoadedPeer = nullptr;
+	QString _searchLoadedQuery;
+
 	State _state = DefaultState;
 
 	object_ptr<Ui::LinkButton> _addContactLnk;
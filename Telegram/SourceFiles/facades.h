@@ -363,7 +363,7 @@ DeclareVar(Stickers::Order, ArchivedStickerSetsOrder);
 
 DeclareVar(MTP::DcOptions, DcOptions);
 
-typedef QMap<uint64, QPixmap> CircleMasksMap;
+typedef QMap<uint64, QImage> CircleMasksMap;
 DeclareRefVar(CircleMasksMap, CircleMasks);
 
 DeclareRefVar(base::Observable<void>, SelfChanged);
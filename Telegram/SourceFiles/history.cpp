@@ -31,6 +31,8 @@ Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
 #include "localstorage.h"
 #include "window/top_bar_widget.h"
 #include "observer_peer.h"
+#include "core/task_queue.h"
+#include "apiwrap.h"
 
 namespace {
 
@@ -45,6 +47,8 @@ constexpr int kStatusShowClientsideChooseLocation = 6000;
 constexpr int kStatusShowClientsideChooseContact = 6000;
 constexpr int kStatusShowClientsidePlayGame = 10000;
 constexpr int kSetMyActionForMs = 10000;
+constexpr int kPrepareResizeMinItems = 256;
+constexpr int kPrepareResizeChunkItems = 64;
 
 auto GlobalPinnedIndex = 0;
 
@@ -56,6 +60,60 @@ HistoryItem *createUnsupportedMessage(History *history, MsgId msgId, MTPDmessage
 	return HistoryMessage::create(history, msgId, flags, replyTo, viaBotId, date, from, { text, entities });
 }
 
+// Shared with the worker tasks, a task started after all the chunks
+// were taken finds nothing to do and doesn't touch the items at all.
+struct PrepareResizeState {
+	QVector<HistoryItem*> items;
+	int width = 0;
+	int chunks = 0;
+	QAtomicInt nextChunk = 0;
+	QSemaphore chunksDone;
+};
+
+void prepareResizeChunks(PrepareResizeState *state) {
+	while (true) {
+		auto chunk = state->nextChunk.fetchAndAddOrdered(1);
+		if (chunk >= state->chunks) {
+			break;
+		}
+		auto from = chunk * kPrepareResizeChunkItems;
+		auto till = qMin(from + kPrepareResizeChunkItems, state->items.size());
+		for (auto i = from; i != till; ++i) {
+			state->items[i]->prepareResize(state->width);
+		}
+		state->chunksDone.release();
+	}
+}
+
+// Counts the text layouts of all the items for the new width in parallel,
+// so that the following resize on the main thread finds them ready.
+void prepareResizeItems(const QList<HistoryBlock*> &blocks, int width) {
+	auto count = 0;
+	for_const (auto block, blocks) {
+		count += block->items.size();
+	}
+	if (count < kPrepareResizeMinItems) {
+		return;
+	}
+
+	auto state = QSharedPointer<PrepareResizeState>::create();
+	state->items.reserve(count);
+	for_const (auto block, blocks) {
+		state->items.append(block->items);
+	}
+	state->width = width;
+	state->chunks = (count + kPrepareResizeChunkItems - 1) / kPrepareResizeChunkItems;
+
+	auto workers = qMin(QThread::idealThreadCount() - 1, state->chunks - 1);
+	for (auto i = 0; i < workers; ++i) {
+		base::TaskQueue::Normal().Put([state] {
+			prepareResizeChunks(state.data());
+		});
+	}
+	prepareResizeChunks(state.data());
+	state->chunksDone.acquire(state->chunks);
+}
+
 } // namespace
 
 void historyInit() {
@@ -1075,19 +1133,10 @@ HistoryItem *History::addNewGame(MsgId id, MTPDmessage::Flags flags, int32 viaBo
 }
 
 bool History::addToOverview(MediaOverviewType type, MsgId msgId, AddToOverviewMethod method) {
-	bool adding = false;
-	switch (method) {
-	case AddToOverviewNew:
-	case AddToOverviewFront: adding = (overviewIds[type].constFind(msgId) == overviewIds[type].cend()); break;
-	case AddToOverviewBack: adding = (overviewCountData[type] != 0); break;
-	}
-	if (!adding) return false;
-
-	overviewIds[type].insert(msgId);
-	switch (method) {
-	case AddToOverviewNew:
-	case AddToOverviewBack: overview[type].push_back(msgId); break;
-	case AddToOverviewFront: overview[type].push_front(msgId); break;
+	if (method == AddToOverviewBack && overviewCountData[type] == 0) {
+		return false;
+	} else if (!overview[type].insert(msgId)) {
+		return false;
 	}
 	if (method == AddToOverviewNew) {
 		if (overviewCountData[type] > 0) {
@@ -1099,20 +1148,10 @@ bool History::addToOverview(MediaOverviewType type, MsgId msgId, AddToOverviewMe
 }
 
 void History::eraseFromOverview(MediaOverviewType type, MsgId msgId) {
-	if (overviewIds[type].isEmpty()) return;
-
-	auto i = overviewIds[type].find(msgId);
-	if (i == overviewIds[type].cend()) return;
+	if (!overview[type].remove(msgId)) return;
 
-	overviewIds[type].erase(i);
-	for (auto i = overview[type].begin(), e = overview[type].end(); i != e; ++i) {
-		if ((*i) == msgId) {
-			overview[type].erase(i);
-			if (overviewCountData[type] > 0) {
-				--overviewCountData[type];
-			}
-			break;
-		}
+	if (overviewCountData[type] > 0) {
+		--overviewCountData[type];
 	}
 	Notify::mediaOverviewUpdated(peer, type);
 }
@@ -1449,9 +1488,8 @@ void History::checkAddAllToOverview() {
 	int32 mask = 0;
 	for (int32 i = 0; i < OverviewCount; ++i) {
 		if (overviewCountData[i] == 0) continue; // all loaded
-		if (!overview[i].isEmpty() || !overviewIds[i].isEmpty()) {
+		if (!overview[i].isEmpty()) {
 			overview[i].clear();
-			overviewIds[i].clear();
 			mask |= (1 << i);
 		}
 	}
@@ -1961,6 +1999,10 @@ int History::resizeGetHeight(int newWidth) {
 	}
 	_flags &= ~(Flag::f_pending_resize | Flag::f_has_pending_resized_items);
 
+	if (resizeAllItems) {
+		prepareResizeItems(blocks, newWidth);
+	}
+
 	width = newWidth;
 	int y = 0;
 	for_const (HistoryBlock *block, blocks) {
@@ -1999,6 +2041,7 @@ void History::clear(bool leaveItems) {
 	if (!leaveItems) {
 		setLastMessage(nullptr);
 		notifies.clear();
+		Local::clearCachedMessages(peer->id);
 		auto &pending = Global::RefPendingRepaintItems();
 		for (auto i = pending.begin(); i != pending.end();) {
 			if ((*i)->history() == this) {
@@ -2009,7 +2052,7 @@ void History::clear(bool leaveItems) {
 		}
 	}
 	for (int32 i = 0; i < OverviewCount; ++i) {
-		if (!overview[i].isEmpty() || !overviewIds[i].isEmpty()) {
+		if (!overview[i].isEmpty()) {
 			if (leaveItems) {
 				if (overviewCountData[i] == 0) {
 					overviewCountData[i] = overview[i].size();
@@ -2018,7 +2061,6 @@ void History::clear(bool leaveItems) {
 				overviewCountData[i] = -1; // not loaded yet
 			}
 			overview[i].clear();
-			overviewIds[i].clear();
 			if (!App::quitting()) Notify::mediaOverviewUpdated(peer, MediaOverviewType(i));
 		}
 	}
@@ -2060,6 +2102,157 @@ void History::clearBlocks(bool leaveItems) {
 	}
 }
 
+bool History::hasFarBlocks(int visibleTop, int visibleBottom, int keepHeight, bool unloadTop, bool unloadBottom) const {
+	if (blocks.size() < 2 || hasPendingResizedItems()) {
+		return false;
+	}
+	auto front = blocks.front(), back = blocks.back();
+	return (unloadTop && front->y + front->height < visibleTop - keepHeight)
+		|| (unloadBottom && back->y > visibleBottom + keepHeight);
+}
+
+int History::unloadFarBlocks(int visibleTop, int visibleBottom, int keepHeight, bool unloadTop, bool unloadBottom, const UnloadKeepItem &keepItem) {
+	if (blocks.size() < 2 || hasPendingResizedItems()) {
+		return 0; // block coords are not valid or there is nothing to unload
+	}
+
+	auto removedHeight = 0;
+	if (unloadTop) {
+		while (blocks.size() > 1) {
+			auto block = blocks.front();
+			if (block->y + block->height >= visibleTop - keepHeight || !canUnloadBlock(block)) {
+				break;
+			}
+			removedHeight += block->height;
+			unloadBlock(block, keepItem);
+			oldLoaded = false;
+		}
+	}
+	if (unloadBottom) {
+		while (blocks.size() > 1) {
+			auto block = blocks.back();
+			if (block->y <= visibleBottom + keepHeight || !canUnloadBlock(block)) {
+				break;
+			}
+			height -= block->height;
+			unloadBlock(block, keepItem);
+			newLoaded = false;
+		}
+	}
+	if (removedHeight > 0) {
+		for_const (auto block, blocks) {
+			block->y -= removedHeight;
+		}
+		height -= removedHeight;
+	}
+	return removedHeight;
+}
+
+bool History::canUnloadBlock(HistoryBlock *block) const {
+	if (_buildingFrontBlock || (scrollTopItem && scrollTopItem->block() == block)) {
+		return false;
+	}
+	for_const (auto item, block->items) {
+		if (item->id <= 0 || item == showFrom || item == unreadBar) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void History::unloadBlock(HistoryBlock *block, const UnloadKeepItem &keepItem) {
+	HistoryBlock::Items items;
+	std::swap(items, block->items);
+	removeBlock(block);
+	delete block;
+
+	auto &pending = Global::RefPendingRepaintItems();
+	for_const (auto item, items) {
+		if (lastSentMsg == item) {
+			lastSentMsg = nullptr;
+		}
+		if (isChannel()) {
+			asChannelHistory()->messageDetached(item);
+		}
+		item->detachFast();
+		if (mustKeepUnloadedItem(item) || (keepItem && keepItem(item))) {
+			App::historyItemDetached(item);
+		} else {
+			pending.remove(item);
+			delete item;
+		}
+	}
+}
+
+// Some items are referenced by pointer or must be found by id even when
+// they're not displayed, those are left detached as after clear(true).
+bool History::mustKeepUnloadedItem(HistoryItem *item) const {
+	if (item == lastMsg || item->id == lastKeyboardId || notifies.contains(item)) {
+		return true;
+	}
+	if (isMegagroup() && peer->asChannel()->mgInfo->pinnedMsgId == item->id) {
+		return true;
+	}
+	return App::historyHasDependents(item);
+}
+
+void History::forgetDetachedItem(HistoryItem *item) {
+	if (mustKeepUnloadedItem(item)) {
+		return;
+	}
+	if (lastSentMsg == item) {
+		lastSentMsg = nullptr;
+	}
+	Global::RefPendingRepaintItems().remove(item);
+	delete item;
+}
+
+HistoryItem *History::overviewItem(int32 overviewIndex, MsgId msgId) {
+	if (auto item = App::histItemById(channelId(), msgId)) {
+		return item;
+	}
+	if (!overviewHasMsgId(overviewIndex, msgId) || !App::api()) {
+		return nullptr;
+	}
+	_overviewRequestedMask |= (1 << overviewIndex);
+	if (!_overviewRequestedIds.contains(msgId)) {
+		_overviewRequestedIds.insert(msgId);
+		App::api()->requestMessageData(peer->asChannel(), msgId, [peerId = peer->id](ChannelData *channel, MsgId msgId) {
+			if (auto history = App::historyLoaded(peerId)) {
+				history->overviewItemReceived(msgId);
+			}
+		});
+	}
+	return nullptr;
+}
+
+void History::overviewItemReceived(MsgId msgId) {
+	if (!_overviewRequestedIds.remove(msgId)) {
+		return;
+	}
+	if (!App::histItemById(channelId(), msgId)) {
+		// The message was deleted, forget it so that it is not requested again.
+		for (auto i = 0; i < OverviewCount; ++i) {
+			if (overview[i].remove(msgId)) {
+				if (overviewCountData[i] > 0) {
+					--overviewCountData[i];
+				}
+				_overviewRequestedMask |= (1 << i);
+			}
+		}
+	}
+
+	// All the ids requested together are received at once, notify about them once.
+	if (_overviewRequestedIds.isEmpty()) {
+		auto mask = base::take(_overviewRequestedMask);
+		for (auto i = 0; i < OverviewCount; ++i) {
+			if (mask & (1 << i)) {
+				Notify::mediaOverviewUpdated(peer, MediaOverviewType(i));
+			}
+		}
+	}
+}
+
 void History::clearOnDestroy() {
 	clearBlocks(false);
 }
@@ -2178,40 +2371,21 @@ void History::overviewSliceDone(int32 overviewIndex, const MTPmessages_Messages
 	if (!onlyCounts && v->isEmpty()) {
 		overviewCountData[overviewIndex] = 0;
 	} else if (overviewCountData[overviewIndex] > 0) {
-		for_const (auto msgId, overviewIds[overviewIndex]) {
-			if (msgId < 0) {
-				++overviewCountData[overviewIndex];
-			} else {
-				break;
-			}
-		}
+		overviewCountData[overviewIndex] += overview[overviewIndex].localCount();
 	}
 
 	for (QVector<MTPMessage>::const_iterator i = v->cbegin(), e = v->cend(); i != e; ++i) {
 		HistoryItem *item = App::histories().addNewMessage(*i, NewMessageExisting);
-		if (item && overviewIds[overviewIndex].constFind(item->id) == overviewIds[overviewIndex].cend()) {
-			overviewIds[overviewIndex].insert(item->id);
-			overview[overviewIndex].push_front(item->id);
+		if (item) {
+			overview[overviewIndex].insert(item->id);
 		}
 	}
 }
 
 void History::changeMsgId(MsgId oldId, MsgId newId) {
 	for (int32 i = 0; i < OverviewCount; ++i) {
-		auto j = overviewIds[i].find(oldId);
-		if (j != overviewIds[i].cend()) {
-			overviewIds[i].erase(j);
-			int32 index = overview[i].indexOf(oldId);
-			if (overviewIds[i].constFind(newId) == overviewIds[i].cend()) {
-				overviewIds[i].insert(newId);
-				if (index >= 0) {
-					overview[i][index] = newId;
-				} else {
-					overview[i].push_back(newId);
-				}
-			} else if (index >= 0) {
-				overview[i].removeAt(index);
-			}
+		if (overview[i].remove(oldId)) {
+			overview[i].insert(newId);
 		}
 	}
 }
@@ -23,6 +23,7 @@ Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
 #include "structs.h"
 #include "dialogs/dialogs_common.h"
 #include "ui/effects/send_action_animations.h"
+#include "data/data_overview_ids.h"
 
 void historyInit();
 
@@ -215,6 +216,9 @@ public:
 
 	void clear(bool leaveItems = false);
 
+	// deletes an item left detached by clear(true) unless it is still referenced
+	void forgetDetachedItem(HistoryItem *item);
+
 	virtual ~History();
 
 	HistoryItem *addNewService(MsgId msgId, QDateTime date, const QString &text, MTPDmessage::Flags flags = 0, bool newMsg = true);
@@ -409,6 +413,18 @@ public:
 	// of the displayed window relative to the history start coord
 	void countScrollState(int top);
 
+	// unload the blocks lying further than keepHeight above (or below) the
+	// displayed window, given relative to the history start coord, so that
+	// the memory of a long scrolled history stays bounded, the history is
+	// marked as not loaded from that side and preloading gets them back
+	// returns the height removed above the window, scrollTopItem is kept
+	// and the items for which keepItem returns true are left detached
+	using UnloadKeepItem = base::lambda<bool(HistoryItem *item)>;
+	int unloadFarBlocks(int visibleTop, int visibleBottom, int keepHeight, bool unloadTop, bool unloadBottom, const UnloadKeepItem &keepItem);
+
+	// a cheap check if the first or the last block lies far enough to be unloaded
+	bool hasFarBlocks(int visibleTop, int visibleBottom, int keepHeight, bool unloadTop, bool unloadBottom) const;
+
 protected:
 	// when this item is destroyed scrollTopItem just points to the next one
 	// and scrollTopOffset remains the same
@@ -431,7 +447,7 @@ public:
 	mutable const HistoryItem *textCachedFor = nullptr; // cache
 	mutable Text lastItemTextCache;
 
-	typedef QList<MsgId> MediaOverview;
+	using MediaOverview = Data::OverviewIds;
 	MediaOverview overview[OverviewCount];
 
 	bool overviewCountLoaded(int32 overviewIndex) const {
@@ -452,18 +468,19 @@ public:
 		return result;
 	}
 	MsgId overviewMinId(int32 overviewIndex) const {
-		for_const (auto msgId, overviewIds[overviewIndex]) {
-			if (msgId > 0) {
-				return msgId;
-			}
-		}
-		return 0;
+		auto &ids = overview[overviewIndex];
+		return (ids.size() > ids.localCount()) ? ids.front() : 0;
 	}
 	void overviewSliceDone(int32 overviewIndex, const MTPmessages_Messages &result, bool onlyCounts = false);
 	bool overviewHasMsgId(int32 overviewIndex, MsgId msgId) const {
-		return overviewIds[overviewIndex].constFind(msgId) != overviewIds[overviewIndex].cend();
+		return overview[overviewIndex].contains(msgId);
 	}
 
+	// Overview items may be deleted with the unloaded history blocks while
+	// their ids are kept, such items are requested again and nullptr is returned.
+	HistoryItem *overviewItem(int32 overviewIndex, MsgId msgId);
+	void overviewItemReceived(MsgId msgId);
+
 	void changeMsgId(MsgId oldId, MsgId newId);
 
 	Text cloudDraftTextCache;
@@ -481,6 +498,12 @@ protected:
 
 	void clearBlocks(bool leaveItems);
 
+	// helpers for unloadFarBlocks(), they check if the block can be
+	// unloaded at all and remove it, deleting all the unneeded items
+	bool canUnloadBlock(HistoryBlock *block) const;
+	void unloadBlock(HistoryBlock *block, const UnloadKeepItem &keepItem);
+	bool mustKeepUnloadedItem(HistoryItem *item) const;
+
 	HistoryItem *createItem(const MTPMessage &msg, bool applyServiceAction, bool detachExistingItem);
 	HistoryItem *createItemForwarded(MsgId id, MTPDmessage::Flags flags, QDateTime date, int32 from, HistoryMessage *msg);
 	HistoryItem *createItemDocument(MsgId id, MTPDmessage::Flags flags, int32 viaBotId, MsgId replyTo, QDateTime date, int32 from, DocumentData *doc, const QString &caption, const MTPReplyMarkup &markup);
@@ -546,10 +569,13 @@ private:
 	}
 	uint64 _sortKeyInChatList = 0; // like ((unixtime) << 32) | (incremented counter)
 
-	using MediaOverviewIds = OrderedSet<MsgId>;
-	MediaOverviewIds overviewIds[OverviewCount];
 	int32 overviewCountData[OverviewCount]; // -1 - not loaded, 0 - all loaded, > 0 - count, but not all loaded
 
+	// Ids of the unloaded overview items requested by overviewItem() and
+	// the overview types to notify about when all of them are received.
+	OrderedSet<MsgId> _overviewRequestedIds;
+	int32 _overviewRequestedMask = 0;
+
 	// A pointer to the block that is currently being built.
 	// We hold this pointer so we can destroy it while building
 	// and then create a new one if it is necessary.
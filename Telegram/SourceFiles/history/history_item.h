@@ -473,6 +473,14 @@ public:
 		}
 		return resizeGetHeight_(width);
 	}
+
+	// Counts the text layouts that resizeGetHeight(width) will need, so that
+	// it can be done for many items in parallel before resizing them. Only the
+	// layout caches of the texts are changed, it is safe to call it from a
+	// worker thread while the main thread doesn't use the item.
+	virtual void prepareResize(int width) const {
+	}
+
 	virtual void draw(Painter &p, const QRect &r, TextSelection selection, TimeMs ms) const = 0;
 
 	virtual void dependencyItemRemoved(HistoryItem *dependency) {
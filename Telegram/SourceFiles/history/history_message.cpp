@@ -1443,15 +1443,34 @@ int HistoryMessage::resizeGetHeight_(int width) {
 	return result;
 }
 
-int HistoryMessage::performResizeGetHeight(int width) {
-	if (width < st::msgMinWidth) return _height;
+void HistoryMessage::prepareResize(int width) const {
+	if (pendingInitDimensions() || width < st::msgMinWidth || !drawBubble() || emptyText()) {
+		return;
+	}
 
+	width = countBubbleWidth(width);
+	if (width < _maxw) {
+		auto textWidth = qMax(width - st::msgPadding.left() - st::msgPadding.right(), 1);
+		if (textWidth != _textWidth) {
+			_text.countHeight(textWidth);
+		}
+	}
+}
+
+int HistoryMessage::countBubbleWidth(int width) const {
 	width -= st::msgMargin.left() + st::msgMargin.right();
 	if (width < st::msgPadding.left() + st::msgPadding.right() + 1) {
-		width = st::msgPadding.left() + st::msgPadding.right() + 1;
+		return st::msgPadding.left() + st::msgPadding.right() + 1;
 	} else if (width > st::msgMaxWidth) {
-		width = st::msgMaxWidth;
+		return st::msgMaxWidth;
 	}
+	return width;
+}
+
+int HistoryMessage::performResizeGetHeight(int width) {
+	if (width < st::msgMinWidth) return _height;
+
+	width = countBubbleWidth(width);
 	if (drawBubble()) {
 		auto fwd = Get<HistoryMessageForwarded>();
 		auto reply = Get<HistoryMessageReply>();
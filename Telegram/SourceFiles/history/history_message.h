@@ -71,6 +71,7 @@ public:
 	void drawInfo(Painter &p, int32 right, int32 bottom, int32 width, bool selected, InfoDisplayType type) const override;
 	void setViewsCount(int32 count) override;
 	void setId(MsgId newId) override;
+	void prepareResize(int width) const override;
 	void draw(Painter &p, const QRect &r, TextSelection selection, TimeMs ms) const override;
 
 	void dependencyItemRemoved(HistoryItem *dependency) override;
@@ -159,6 +160,7 @@ private:
 	void initDimensions() override;
 	int resizeGetHeight_(int width) override;
 	int performResizeGetHeight(int width);
+	int countBubbleWidth(int width) const;
 	void applyEditionToEmpty();
 
 	bool displayForwardedFrom() const {
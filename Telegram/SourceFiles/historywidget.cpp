@@ -117,6 +117,45 @@ ApiWrap::RequestMessageDataCallback replyEditMessageDataCallback() {
 	};
 }
 
+// The users and chats from the local messages cache are fed only if we
+// don't know them yet, so that the older data won't overwrite the newer.
+bool peerIsKnown(const PeerId &peerId) {
+	return !peerId || App::peer(peerId, PeerData::MinimalLoaded);
+}
+
+MTPVector<MTPUser> filterUnknownUsers(const MTPVector<MTPUser> &users) {
+	auto result = QVector<MTPUser>();
+	for_const (auto &user, users.c_vector().v) {
+		auto userId = UserId(0);
+		switch (user.type()) {
+		case mtpc_user: userId = user.c_user().vid.v; break;
+		case mtpc_userEmpty: userId = user.c_userEmpty().vid.v; break;
+		}
+		if (!peerIsKnown(peerFromUser(userId))) {
+			result.push_back(user);
+		}
+	}
+	return MTP_vector<MTPUser>(result);
+}
+
+MTPVector<MTPChat> filterUnknownChats(const MTPVector<MTPChat> &chats) {
+	auto result = QVector<MTPChat>();
+	for_const (auto &chat, chats.c_vector().v) {
+		auto peerId = PeerId(0);
+		switch (chat.type()) {
+		case mtpc_chat: peerId = peerFromChat(chat.c_chat().vid); break;
+		case mtpc_chatEmpty: peerId = peerFromChat(chat.c_chatEmpty().vid); break;
+		case mtpc_chatForbidden: peerId = peerFromChat(chat.c_chatForbidden().vid); break;
+		case mtpc_channel: peerId = peerFromChannel(chat.c_channel().vid); break;
+		case mtpc_channelForbidden: peerId = peerFromChannel(chat.c_channelForbidden().vid); break;
+		}
+		if (!peerIsKnown(peerId)) {
+			result.push_back(chat);
+		}
+	}
+	return MTP_vector<MTPChat>(result);
+}
+
 } // namespace
 
 // flick scroll taken from http://qt-project.org/doc/qt-4.8/demos-embedded-anomaly-src-flickcharm-cpp.html
@@ -4289,7 +4328,6 @@ void HistoryWidget::showHistory(const PeerId &peerId, MsgId showAtMsgId, bool re
 
 	if (_peer) {
 		App::forgetMedia();
-		_serviceImageCacheSize = imageCacheSize();
 		MTP::clearLoaderPriorities();
 
 		_history = App::history(_peer->id);
@@ -4377,7 +4415,9 @@ void HistoryWidget::clearAllLoadRequests() {
 	if (_firstLoadRequest) MTP::cancel(_firstLoadRequest);
 	if (_preloadRequest) MTP::cancel(_preloadRequest);
 	if (_preloadDownRequest) MTP::cancel(_preloadDownRequest);
-	_preloadRequest = _preloadDownRequest = _firstLoadRequest = 0;
+	if (_cachedRefreshRequest) MTP::cancel(_cachedRefreshRequest);
+	_preloadRequest = _preloadDownRequest = _firstLoadRequest = _cachedRefreshRequest = 0;
+	_cachedItemIds.clear();
 }
 
 void HistoryWidget::contactsReceived() {
@@ -4802,19 +4842,21 @@ bool HistoryWidget::messagesFailed(const RPCError &error, mtpRequestId requestId
 		App::main()->showBackFromStack();
 	} else if (_delayedShowAtRequest == requestId) {
 		_delayedShowAtRequest = 0;
+	} else if (_cachedRefreshRequest == requestId) {
+		_cachedRefreshRequest = 0;
 	}
 	return true;
 }
 
 void HistoryWidget::messagesReceived(PeerData *peer, const MTPmessages_Messages &messages, mtpRequestId requestId) {
 	if (!_history) {
-		_preloadRequest = _preloadDownRequest = _firstLoadRequest = _delayedShowAtRequest = 0;
+		_preloadRequest = _preloadDownRequest = _firstLoadRequest = _delayedShowAtRequest = _cachedRefreshRequest = 0;
 		return;
 	}
 
 	bool toMigrated = (peer == _peer->migrateFrom());
 	if (peer != _peer && !toMigrated) {
-		_preloadRequest = _preloadDownRequest = _firstLoadRequest = _delayedShowAtRequest = 0;
+		_preloadRequest = _preloadDownRequest = _firstLoadRequest = _delayedShowAtRequest = _cachedRefreshRequest = 0;
 		return;
 	}
 
@@ -4868,6 +4910,9 @@ void HistoryWidget::messagesReceived(PeerData *peer, const MTPmessages_Messages
 		} else if (_migrated) {
 			_migrated->clear(true);
 		}
+		if (_firstLoadAtBottom) {
+			Local::writeCachedMessages(peer->id, messages);
+		}
 		addMessagesToFront(peer, *histList);
 		_firstLoadRequest = 0;
 		if (_history->loadedAtTop()) {
@@ -4921,7 +4966,122 @@ void HistoryWidget::messagesReceived(PeerData *peer, const MTPmessages_Messages
 		_histInited = false;
 
 		historyLoaded();
+	} else if (_cachedRefreshRequest == requestId) {
+		_cachedRefreshRequest = 0;
+		Local::writeCachedMessages(peer->id, messages);
+		cachedMessagesRefreshed(peer, *histList);
+	}
+}
+
+bool HistoryWidget::showCachedMessages() {
+	MTPmessages_Messages messages;
+	if (!Local::readCachedMessages(_peer->id, messages)) {
+		return false;
+	}
+
+	const QVector<MTPMessage> *histList = nullptr;
+	switch (messages.type()) {
+	case mtpc_messages_messages: {
+		auto &d(messages.c_messages_messages());
+		App::feedUsers(filterUnknownUsers(d.vusers));
+		App::feedChats(filterUnknownChats(d.vchats));
+		histList = &d.vmessages.c_vector().v;
+	} break;
+	case mtpc_messages_messagesSlice: {
+		auto &d(messages.c_messages_messagesSlice());
+		App::feedUsers(filterUnknownUsers(d.vusers));
+		App::feedChats(filterUnknownChats(d.vchats));
+		histList = &d.vmessages.c_vector().v;
+	} break;
+	case mtpc_messages_channelMessages: {
+		auto &d(messages.c_messages_channelMessages());
+		App::feedUsers(filterUnknownUsers(d.vusers));
+		App::feedChats(filterUnknownChats(d.vchats));
+		histList = &d.vmessages.c_vector().v;
+	} break;
 	}
+	if (!histList || histList->isEmpty()) {
+		return false;
+	}
+
+	// The newest messages could be not cached yet, so we're not loaded at
+	// the bottom until lastMsg is added or the refresh request is done.
+	_history->setNotLoadedAtBottom();
+	_list->messagesReceived(_peer, *histList);
+	if (_history->isEmpty()) {
+		return false;
+	}
+	_cachedItemIds.clear();
+	for_const (auto &message, *histList) {
+		if (auto msgId = idFromMessage(message)) {
+			_cachedItemIds.insert(msgId);
+		}
+	}
+	countHistoryShowFrom();
+	destroyUnreadBar();
+	return true;
+}
+
+void HistoryWidget::cachedMessagesRefreshed(PeerData *peer, const QVector<MTPMessage> &messages) {
+	if (_preloadRequest) MTP::cancel(_preloadRequest);
+	if (_preloadDownRequest) MTP::cancel(_preloadDownRequest);
+	_preloadRequest = _preloadDownRequest = 0;
+
+	// The cached items are detached and the refreshed ones are added
+	// instead, the scroll state is restored if its item is still there.
+	auto scrollTopItemId = _history->scrollTopItem ? _history->scrollTopItem->id : MsgId(0);
+	auto scrollTopOffset = _history->scrollTopOffset;
+
+	// History::createItem() reuses the existing items as they are, so the
+	// cached ones get the fresh text, media, markup and views first.
+	auto cachedItemIds = base::take(_cachedItemIds);
+	auto freshIds = OrderedSet<MsgId>();
+	auto freshMinId = MsgId(0);
+	for_const (auto &message, messages) {
+		if (auto msgId = idFromMessage(message)) {
+			freshIds.insert(msgId);
+			if (!freshMinId || msgId < freshMinId) {
+				freshMinId = msgId;
+			}
+			if (cachedItemIds.contains(msgId)) {
+				App::updateEditedMessage(message);
+			}
+		}
+	}
+
+	_history->clear(true);
+
+	// The cached messages missing in the refreshed page were deleted if they are
+	// newer than its oldest message, the older ones are dropped until they're loaded.
+	for_const (auto msgId, cachedItemIds) {
+		if (freshIds.contains(msgId)) {
+			continue;
+		}
+		if (auto item = App::histItemById(_channel, msgId)) {
+			if (item->history() != _history || !item->detached()) {
+				continue;
+			}
+			if (freshMinId && msgId > freshMinId) {
+				item->destroy();
+			} else {
+				_history->forgetDetachedItem(item);
+			}
+		}
+	}
+
+	_history->getReadyFor(ShowAtTheEndMsgId);
+	_list->messagesReceived(peer, messages);
+
+	if (auto item = scrollTopItemId ? App::histItemById(_channel, scrollTopItemId) : nullptr) {
+		if (item->history() == _history && !item->detached()) {
+			_history->scrollTopItem = item;
+			_history->scrollTopOffset = scrollTopOffset;
+		}
+	}
+	countHistoryShowFrom();
+	updateListSize();
+	updateBotKeyboard();
+	preloadHistoryIfNeeded();
 }
 
 void HistoryWidget::historyLoaded() {
@@ -5001,11 +5161,19 @@ void HistoryWidget::firstLoadMessages() {
 		}
 	}
 
+	// The newest messages page is kept in the local cache, if we have it
+	// the chat is shown right away and then refreshed from the server.
+	_firstLoadAtBottom = (from == _peer && !offset_id && !offset);
+	if (_firstLoadAtBottom && _history->isEmpty() && (!_migrated || _migrated->isEmpty()) && !_cachedRefreshRequest && showCachedMessages()) {
+		_cachedRefreshRequest = MTP::send(MTPmessages_GetHistory(from->input, MTP_int(offset_id), MTP_int(0), MTP_int(offset), MTP_int(loadCount), MTP_int(0), MTP_int(0)), rpcDone(&HistoryWidget::messagesReceived, from), rpcFail(&HistoryWidget::messagesFailed));
+		return;
+	}
+
 	_firstLoadRequest = MTP::send(MTPmessages_GetHistory(from->input, MTP_int(offset_id), MTP_int(0), MTP_int(offset), MTP_int(loadCount), MTP_int(0), MTP_int(0)), rpcDone(&HistoryWidget::messagesReceived, from), rpcFail(&HistoryWidget::messagesFailed));
 }
 
 void HistoryWidget::loadMessages() {
-	if (!_history || _preloadRequest) return;
+	if (!_history || _preloadRequest || _cachedRefreshRequest) return;
 
 	if (_history->isEmpty() && _migrated && _migrated->isEmpty()) {
 		return firstLoadMessages();
@@ -5024,7 +5192,7 @@ void HistoryWidget::loadMessages() {
 }
 
 void HistoryWidget::loadMessagesDown() {
-	if (!_history || _preloadDownRequest) return;
+	if (!_history || _preloadDownRequest || _cachedRefreshRequest) return;
 
 	if (_history->isEmpty() && _migrated && _migrated->isEmpty()) {
 		return firstLoadMessages();
@@ -5087,6 +5255,7 @@ void HistoryWidget::onScroll() {
 	App::checkImageCacheSize();
 	preloadHistoryIfNeeded();
 	visibleAreaUpdated();
+	unloadFarHistory();
 }
 
 void HistoryWidget::visibleAreaUpdated() {
@@ -5135,6 +5304,35 @@ void HistoryWidget::preloadHistoryIfNeeded() {
 	}
 }
 
+void HistoryWidget::unloadFarHistory() {
+	if (!_history || _history->isEmpty() || !_histInited) return;
+
+	// If there is a non-empty _migrated above, we can't unload the top
+	// of _history, because the preloading won't fill the gap between them.
+	// While a slice request is sent we can't unload the side it will be added to.
+	auto unloadTop = !_preloadRequest && (!_migrated || _migrated->isEmpty());
+	auto unloadBottom = !_preloadDownRequest;
+	if (!unloadTop && !unloadBottom) return;
+
+	auto htop = _list->historyTop();
+	if (htop < 0) return;
+
+	auto visibleTop = _scroll->scrollTop() - htop;
+	auto visibleBottom = visibleTop + _scroll->height();
+	auto keepHeight = UnloadHeightsCount * _scroll->height();
+	if (!_history->hasFarBlocks(visibleTop, visibleBottom, keepHeight, unloadTop, unloadBottom)) return;
+
+	// Called after visibleAreaUpdated(), so the scroll position
+	// is restored from the up to date scrollTopItem after unloading.
+	auto wasBlocksCount = _history->blocks.size();
+	_history->unloadFarBlocks(visibleTop, visibleBottom, keepHeight, unloadTop, unloadBottom, [this](HistoryItem *item) {
+		return (item == _replyEditMsg) || (item == _replyReturn) || (item == _kbReplyTo) || _replyReturns.contains(item->id) || _list->isItemSelected(item);
+	});
+	if (_history->blocks.size() != wasBlocksCount) {
+		updateListSize();
+	}
+}
+
 void HistoryWidget::onInlineBotCancel() {
 	auto &textWithTags = _field->getTextWithTags();
 	if (textWithTags.text.size() > _inlineBotUsername.size() + 2) {
@@ -90,6 +90,9 @@ public:
 	void clearSelectedItems(bool onlyTextSelection = false);
 	void fillSelectedItems(SelectedItemSet &sel, bool forDelete = true);
 	void selectItem(HistoryItem *item);
+	bool isItemSelected(HistoryItem *item) const {
+		return _selected.contains(item);
+	}
 
 	void updateBotInfo(bool recount = true);
 
@@ -996,6 +999,15 @@ private:
 	};
 	void updateListSize(bool initial = false, bool loadedDown = false, const ScrollChange &change = { ScrollChangeNone, 0 });
 
+	// Unloads the parts of a long history far away from the visible area,
+	// must be called after visibleAreaUpdated() has updated the scroll state.
+	void unloadFarHistory();
+
+	// Shows the newest messages page from the local cache while the first
+	// request is being sent, the refreshed page replaces the cached one.
+	bool showCachedMessages();
+	void cachedMessagesRefreshed(PeerData *peer, const QVector<MTPMessage> &messages);
+
 	// Does any of the shown histories has this flag set.
 	bool hasPendingResizedItems() const {
 		return (_history && _history->hasPendingResizedItems()) || (_migrated && _migrated->hasPendingResizedItems());
@@ -1068,8 +1080,11 @@ private:
 	MsgId _showAtMsgId = ShowAtUnreadMsgId;
 
 	mtpRequestId _firstLoadRequest = 0;
+	bool _firstLoadAtBottom = false; // the newest messages page is requested
 	mtpRequestId _preloadRequest = 0;
 	mtpRequestId _preloadDownRequest = 0;
+	mtpRequestId _cachedRefreshRequest = 0; // the cached messages are shown
+	OrderedSet<MsgId> _cachedItemIds; // the messages shown from the cache, replaced on refresh
 
 	MsgId _delayedShowAtMsgId = -1; // wtf?
 	mtpRequestId _delayedShowAtRequest = 0;
@@ -1160,7 +1175,6 @@ private:
 	TaskQueue _fileLoader;
 	TextUpdateEvents _textUpdateEvents = (TextUpdateEvent::SaveDraft | TextUpdateEvent::SendTyping);
 
-	int64 _serviceImageCacheSize = 0;
 	QString _confirmSource;
 
 	QString _titlePeerText;
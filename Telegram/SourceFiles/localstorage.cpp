@@ -41,6 +41,9 @@ namespace {
 
 constexpr int kThemeFileSizeLimit = 5 * 1024 * 1024;
 
+// How many chats keep their last messages page in the local cache.
+constexpr int kCachedMessagesPeersLimit = 64;
+
 using FileKey = quint64;
 
 constexpr char tdfMagic[] = { 'T', 'D', 'F', '$' };
@@ -495,6 +498,7 @@ enum { // Local Storage Keys
 	lskSavedGifs = 0x0f, // no data
 	lskStickersKeys = 0x10, // no data
 	lskTrustedBots = 0x11, // no data
+	lskCachedMessages = 0x12, // data: PeerId peer
 };
 
 enum {
@@ -558,6 +562,8 @@ enum {
 	dbiNotificationsCount  = 0x45,
 	dbiNotificationsCorner = 0x46,
 	dbiTheme = 0x47,
+	dbiServerSalts = 0x48,
+	dbiDcEndpoints = 0x49,
 
 	dbiEncryptedWithSalt = 333,
 	dbiEncrypted = 444,
@@ -573,6 +579,10 @@ DraftsMap _draftsMap, _draftCursorsMap;
 typedef QMap<PeerId, bool> DraftsNotReadMap;
 DraftsNotReadMap _draftsNotReadMap;
 
+// The chats with cached messages, from the least to the most recently written.
+typedef QList<QPair<PeerId, FileKey>> CachedMessagesKeys;
+CachedMessagesKeys _cachedMessagesKeys;
+
 typedef QPair<FileKey, qint32> FileDesc; // file, size
 
 typedef QMultiMap<MediaKey, FileLocation> FileLocations;
@@ -845,6 +855,31 @@ bool _readSetting(quint32 blockId, QDataStream &stream, int version) {
 		if (_dcOpts) _dcOpts->insert(dcIdWithShift, MTP::DcOption(MTP::bareDcId(dcIdWithShift), MTPDdcOption::Flags(flags), ip.toUtf8().constData(), port));
 	} break;
 
+	case dbiDcEndpoints: {
+		qint32 count;
+		stream >> count;
+		if (!_checkStreamStatus(stream)) return false;
+
+		MTP::internal::DcEndpoints endpoints;
+		endpoints.reserve(count);
+		for (auto i = 0; i < count; ++i) {
+			qint32 dcIdWithShift, flags, port, rtt, failures;
+			QString ip;
+			stream >> dcIdWithShift >> flags >> ip >> port >> rtt >> failures;
+			if (!_checkStreamStatus(stream)) return false;
+
+			MTP::internal::DcEndpoint endpoint;
+			endpoint.dcIdWithShift = dcIdWithShift;
+			endpoint.flags = MTPDdcOption::Flags(flags);
+			endpoint.ip = ip.toUtf8().constData();
+			endpoint.port = port;
+			endpoint.rtt = rtt;
+			endpoint.failures = failures;
+			endpoints.push_back(endpoint);
+		}
+		MTP::setDcEndpoints(endpoints);
+	} break;
+
 	case dbiChatSizeMax: {
 		qint32 maxSize;
 		stream >> maxSize;
@@ -903,6 +938,30 @@ bool _readSetting(quint32 blockId, QDataStream &stream, int version) {
 		MTP::setKey(dcId, keyPtr);
 	} break;
 
+	case dbiServerSalts: {
+		qint32 dcId, count;
+		quint64 keyId;
+		stream >> dcId >> keyId >> count;
+		if (!_checkStreamStatus(stream)) return false;
+
+		MTP::internal::ServerSalts salts;
+		salts.reserve(count);
+		for (auto i = 0; i < count; ++i) {
+			qint32 validSince, validUntil;
+			quint64 salt;
+			stream >> validSince >> validUntil >> salt;
+			if (!_checkStreamStatus(stream)) return false;
+
+			MTP::internal::ServerSalt serverSalt;
+			serverSalt.validSince = validSince;
+			serverSalt.validUntil = validUntil;
+			serverSalt.salt = salt;
+			salts.push_back(serverSalt);
+		}
+		DEBUG_LOG(("MTP Info: server salts found, dc %1, count %2").arg(dcId).arg(count));
+		MTP::setServerSalts(dcId, keyId, salts);
+	} break;
+
 	case dbiAutoStart: {
 		qint32 v;
 		stream >> v;
@@ -1709,9 +1768,14 @@ void _writeMtpData() {
 	}
 
 	MTP::AuthKeysMap keys = MTP::getKeys();
+	auto salts = MTP::getServerSalts();
 
 	quint32 size = sizeof(quint32) + sizeof(qint32) + sizeof(quint32);
 	size += keys.size() * (sizeof(quint32) + sizeof(quint32) + 256);
+	for_const (auto &dcSalts, salts) {
+		size += sizeof(quint32) + sizeof(qint32) + sizeof(quint64) + sizeof(qint32);
+		size += dcSalts.salts.size() * (sizeof(qint32) + sizeof(qint32) + sizeof(quint64));
+	}
 
 	EncryptedDescriptor data(size);
 	data.stream << quint32(dbiUser) << qint32(MTP::authedId()) << quint32(MTP::maindc());
@@ -1719,6 +1783,14 @@ void _writeMtpData() {
 		data.stream << quint32(dbiKey) << quint32(key->getDC());
 		key->write(data.stream);
 	}
+	for (auto i = salts.cbegin(), e = salts.cend(); i != e; ++i) {
+		if (i->salts.isEmpty()) continue;
+
+		data.stream << quint32(dbiServerSalts) << qint32(i.key()) << quint64(i->keyId) << qint32(i->salts.size());
+		for_const (auto &salt, i->salts) {
+			data.stream << qint32(salt.validSince) << qint32(salt.validUntil) << quint64(salt.salt);
+		}
+	}
 
 	mtp.writeEncrypted(data);
 }
@@ -1796,6 +1868,7 @@ ReadMapState _readMap(const QByteArray &pass) {
 
 	DraftsMap draftsMap, draftCursorsMap;
 	DraftsNotReadMap draftsNotReadMap;
+	CachedMessagesKeys cachedMessagesKeys;
 	StorageMap imagesMap, stickerImagesMap, audiosMap;
 	qint64 storageImagesSize = 0, storageStickersSize = 0, storageAudiosSize = 0;
 	quint64 locationsKey = 0, reportSpamStatusesKey = 0, trustedBotsKey = 0;
@@ -1828,6 +1901,16 @@ ReadMapState _readMap(const QByteArray &pass) {
 				draftCursorsMap.insert(p, key);
 			}
 		} break;
+		case lskCachedMessages: {
+			quint32 count = 0;
+			map.stream >> count;
+			for (quint32 i = 0; i < count; ++i) {
+				FileKey key;
+				quint64 p;
+				map.stream >> key >> p;
+				cachedMessagesKeys.push_back(qMakePair(PeerId(p), key));
+			}
+		} break;
 		case lskImages: {
 			quint32 count = 0;
 			map.stream >> count;
@@ -1913,6 +1996,7 @@ ReadMapState _readMap(const QByteArray &pass) {
 	_draftsMap = draftsMap;
 	_draftCursorsMap = draftCursorsMap;
 	_draftsNotReadMap = draftsNotReadMap;
+	_cachedMessagesKeys = cachedMessagesKeys;
 
 	_imagesMap = imagesMap;
 	_storageImagesSize = storageImagesSize;
@@ -1995,6 +2079,7 @@ void _writeMap(WriteMapWhen when) {
 	uint32 mapSize = 0;
 	if (!_draftsMap.isEmpty()) mapSize += sizeof(quint32) * 2 + _draftsMap.size() * sizeof(quint64) * 2;
 	if (!_draftCursorsMap.isEmpty()) mapSize += sizeof(quint32) * 2 + _draftCursorsMap.size() * sizeof(quint64) * 2;
+	if (!_cachedMessagesKeys.isEmpty()) mapSize += sizeof(quint32) * 2 + _cachedMessagesKeys.size() * sizeof(quint64) * 2;
 	if (!_imagesMap.isEmpty()) mapSize += sizeof(quint32) * 2 + _imagesMap.size() * (sizeof(quint64) * 3 + sizeof(qint32));
 	if (!_stickerImagesMap.isEmpty()) mapSize += sizeof(quint32) * 2 + _stickerImagesMap.size() * (sizeof(quint64) * 3 + sizeof(qint32));
 	if (!_audiosMap.isEmpty()) mapSize += sizeof(quint32) * 2 + _audiosMap.size() * (sizeof(quint64) * 3 + sizeof(qint32));
@@ -2023,6 +2108,12 @@ void _writeMap(WriteMapWhen when) {
 			mapData.stream << quint64(i.value()) << quint64(i.key());
 		}
 	}
+	if (!_cachedMessagesKeys.isEmpty()) {
+		mapData.stream << quint32(lskCachedMessages) << quint32(_cachedMessagesKeys.size());
+		for_const (auto &cached, _cachedMessagesKeys) {
+			mapData.stream << quint64(cached.second) << quint64(cached.first);
+		}
+	}
 	if (!_imagesMap.isEmpty()) {
 		mapData.stream << quint32(lskImages) << quint32(_imagesMap.size());
 		for (StorageMap::const_iterator i = _imagesMap.cbegin(), e = _imagesMap.cend(); i != e; ++i) {
@@ -2177,6 +2268,9 @@ void writeSettings() {
 		LOG(("App Error: _basePath is empty in writeSettings()"));
 		return;
 	}
+	if (_manager) {
+		_manager->writingSettings();
+	}
 
 	if (!QDir().exists(_basePath)) QDir().mkpath(_basePath);
 
@@ -2219,6 +2313,11 @@ void writeSettings() {
 		size += sizeof(quint32) + sizeof(quint32) + sizeof(quint32);
 		size += sizeof(quint32) + Serialize::stringSize(QString::fromUtf8(i->ip.data(), i->ip.size()));
 	}
+	auto endpoints = MTP::getDcEndpoints();
+	size += sizeof(quint32) + sizeof(qint32);
+	for_const (auto &endpoint, endpoints) {
+		size += sizeof(qint32) * 5 + Serialize::stringSize(QString::fromUtf8(endpoint.ip.data(), endpoint.ip.size()));
+	}
 	size += sizeof(quint32) + Serialize::stringSize(cLangFile());
 
 	size += sizeof(quint32) + sizeof(qint32);
@@ -2250,6 +2349,11 @@ void writeSettings() {
 		data.stream << qint32(i->flags) << QString::fromUtf8(i->ip.data(), i->ip.size());
 		data.stream << quint32(i->port);
 	}
+	data.stream << quint32(dbiDcEndpoints) << qint32(endpoints.size());
+	for_const (auto &endpoint, endpoints) {
+		data.stream << qint32(endpoint.dcIdWithShift) << qint32(endpoint.flags) << QString::fromUtf8(endpoint.ip.data(), endpoint.ip.size());
+		data.stream << qint32(endpoint.port) << qint32(endpoint.rtt) << qint32(endpoint.failures);
+	}
 	data.stream << quint32(dbiLangFile) << cLangFile();
 
 	data.stream << quint32(dbiConnectionType) << qint32(Global::ConnectionType());
@@ -2268,6 +2372,13 @@ void writeSettings() {
 	settings.writeEncrypted(data, _settingsKey);
 }
 
+void writeSettingsDelayed() {
+	if (!_manager) {
+		return writeSettings();
+	}
+	_manager->writeSettings();
+}
+
 void writeUserSettings() {
 	_writeUserSettings();
 }
@@ -2284,6 +2395,7 @@ void reset() {
 	_passKeySalt.clear(); // reset passcode, local key
 	_draftsMap.clear();
 	_draftCursorsMap.clear();
+	_cachedMessagesKeys.clear();
 	_fileLocations.clear();
 	_fileLocationPairs.clear();
 	_fileLocationAliases.clear();
@@ -2521,6 +2633,99 @@ bool hasDraft(const PeerId &peer) {
 	return _draftsMap.contains(peer);
 }
 
+int _cachedMessagesIndex(const PeerId &peer) {
+	for (int i = 0, l = _cachedMessagesKeys.size(); i != l; ++i) {
+		if (_cachedMessagesKeys.at(i).first == peer) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void _clearCachedMessages(int index) {
+	clearKey(_cachedMessagesKeys.at(index).second);
+	_cachedMessagesKeys.removeAt(index);
+	_mapChanged = true;
+	_writeMap();
+}
+
+void writeCachedMessages(const PeerId &peer, const MTPmessages_Messages &messages) {
+	if (!_working()) return;
+
+	// The cache holds one page of the newest messages of each chat together
+	// with the users and chats required to display them, written as is.
+	auto key = FileKey(0);
+	auto index = _cachedMessagesIndex(peer);
+	if (index >= 0) {
+		key = _cachedMessagesKeys.at(index).second;
+		if (index + 1 < _cachedMessagesKeys.size()) {
+			_cachedMessagesKeys.removeAt(index);
+			_cachedMessagesKeys.push_back(qMakePair(peer, key));
+			_mapChanged = true;
+			_writeMap();
+		}
+	} else {
+		while (_cachedMessagesKeys.size() >= kCachedMessagesPeersLimit) {
+			clearKey(_cachedMessagesKeys.front().second);
+			_cachedMessagesKeys.pop_front();
+		}
+		key = genKey();
+		_cachedMessagesKeys.push_back(qMakePair(peer, key));
+		_mapChanged = true;
+		_writeMap(WriteMapFast);
+	}
+
+	mtpBuffer buffer;
+	buffer.reserve(messages.innerLength() >> 2);
+	messages.write(buffer);
+	auto serialized = QByteArray::fromRawData(reinterpret_cast<const char*>(buffer.constData()), buffer.size() * sizeof(mtpPrime));
+
+	EncryptedDescriptor data(sizeof(quint64) + Serialize::bytearraySize(serialized));
+	data.stream << quint64(peer) << serialized;
+
+	FileWriteDescriptor file(key);
+	file.writeEncrypted(data);
+}
+
+void clearCachedMessages(const PeerId &peer) {
+	if (!_working()) return;
+
+	auto index = _cachedMessagesIndex(peer);
+	if (index >= 0) {
+		_clearCachedMessages(index);
+	}
+}
+
+bool readCachedMessages(const PeerId &peer, MTPmessages_Messages &messages) {
+	auto index = _cachedMessagesIndex(peer);
+	if (index < 0) return false;
+
+	FileReadDescriptor cached;
+	if (!readEncryptedFile(cached, _cachedMessagesKeys.at(index).second)) {
+		_clearCachedMessages(index);
+		return false;
+	}
+
+	quint64 cachedPeer = 0;
+	QByteArray serialized;
+	cached.stream >> cachedPeer >> serialized;
+	if (!_checkStreamStatus(cached.stream) || cachedPeer != peer || serialized.size() % sizeof(mtpPrime)) {
+		_clearCachedMessages(index);
+		return false;
+	}
+
+	auto from = reinterpret_cast<const mtpPrime*>(serialized.constData());
+	auto end = from + serialized.size() / sizeof(mtpPrime);
+	try {
+		messages.read(from, end);
+	} catch (Exception &) {
+		LOG(("App Error: could not read cached messages for peer %1.").arg(peer));
+		_clearCachedMessages(index);
+		return false;
+	}
+	return true;
+}
+
 void writeFileLocation(MediaKey location, const FileLocation &local) {
 	if (local.fname.isEmpty()) return;
 
@@ -4271,6 +4476,10 @@ bool ClearManager::addTask(int task) {
 			_draftCursorsMap.clear();
 			_mapChanged = true;
 		}
+		if (!_cachedMessagesKeys.isEmpty()) {
+			_cachedMessagesKeys.clear();
+			_mapChanged = true;
+		}
 		if (_locationsKey) {
 			_locationsKey = 0;
 			_mapChanged = true;
@@ -4487,6 +4696,8 @@ Manager::Manager() {
 	connect(&_mapWriteTimer, SIGNAL(timeout()), this, SLOT(mapWriteTimeout()));
 	_locationsWriteTimer.setSingleShot(true);
 	connect(&_locationsWriteTimer, SIGNAL(timeout()), this, SLOT(locationsWriteTimeout()));
+	_settingsWriteTimer.setSingleShot(true);
+	connect(&_settingsWriteTimer, SIGNAL(timeout()), this, SLOT(settingsWriteTimeout()));
 }
 
 void Manager::writeMap(bool fast) {
@@ -4513,6 +4724,18 @@ void Manager::writingLocations() {
 	_locationsWriteTimer.stop();
 }
 
+void Manager::writeSettings() {
+	if (!_settingsWriteTimer.isActive()) {
+		_settingsWriteTimer.start(WriteMapTimeout);
+	} else if (_settingsWriteTimer.remainingTime() <= 0) {
+		settingsWriteTimeout();
+	}
+}
+
+void Manager::writingSettings() {
+	_settingsWriteTimer.stop();
+}
+
 void Manager::mapWriteTimeout() {
 	_writeMap(WriteMapNow);
 }
@@ -4521,6 +4744,10 @@ void Manager::locationsWriteTimeout() {
 	_writeLocations(WriteMapNow);
 }
 
+void Manager::settingsWriteTimeout() {
+	Local::writeSettings();
+}
+
 void Manager::finish() {
 	if (_mapWriteTimer.isActive()) {
 		mapWriteTimeout();
@@ -4528,6 +4755,9 @@ void Manager::finish() {
 	if (_locationsWriteTimer.isActive()) {
 		locationsWriteTimeout();
 	}
+	if (_settingsWriteTimer.isActive()) {
+		settingsWriteTimeout();
+	}
 }
 
 } // namespace internal
@@ -35,6 +35,7 @@ void finish();
 
 void readSettings();
 void writeSettings();
+void writeSettingsDelayed(); // coalesce frequent changes, like the dc endpoints ranking
 void writeUserSettings();
 void writeMtpData();
 
@@ -100,6 +101,10 @@ void writeDraftCursors(const PeerId &peer, const MessageCursor &localCursor, con
 bool hasDraftCursors(const PeerId &peer);
 bool hasDraft(const PeerId &peer);
 
+void writeCachedMessages(const PeerId &peer, const MTPmessages_Messages &messages);
+bool readCachedMessages(const PeerId &peer, MTPmessages_Messages &messages);
+void clearCachedMessages(const PeerId &peer);
+
 void writeFileLocation(MediaKey location, const FileLocation &local);
 FileLocation readFileLocation(MediaKey location, bool check = true);
 
@@ -181,15 +186,19 @@ public:
 	void writingMap();
 	void writeLocations(bool fast);
 	void writingLocations();
+	void writeSettings();
+	void writingSettings();
 	void finish();
 
 public slots:
 	void mapWriteTimeout();
 	void locationsWriteTimeout();
+	void settingsWriteTimeout();
 
 private:
 	QTimer _mapWriteTimer;
 	QTimer _locationsWriteTimer;
+	QTimer _settingsWriteTimer;
 
 };
 
@@ -87,6 +87,7 @@ MainWidget::MainWidget(QWidget *parent) : TWidget(parent)
 	connect(_history, SIGNAL(cancelled()), _dialogs, SLOT(activate()));
 	connect(this, SIGNAL(peerPhotoChanged(PeerData*)), this, SIGNAL(dialogsUpdated()));
 	connect(&noUpdatesTimer, SIGNAL(timeout()), this, SLOT(mtpPing()));
+	_pendingDifferenceTimer.setTimeoutHandler([this] { applyDifferencePart(); });
 	connect(&_onlineTimer, SIGNAL(timeout()), this, SLOT(updateOnline()));
 	connect(&_onlineUpdater, SIGNAL(timeout()), this, SLOT(updateOnlineDisplay()));
 	connect(&_idleFinishTimer, SIGNAL(timeout()), this, SLOT(checkIdleFinish()));
@@ -2142,6 +2143,10 @@ bool MainWidget::viewsIncrementFail(const RPCError &error, mtpRequestId req) {
 }
 
 void MainWidget::createDialog(History *history) {
+	if (_updatesBatchLevel > 0) {
+		_updatesBatchDialogs.insert(history->peer->id);
+		return;
+	}
 	_dialogs->createDialog(history);
 }
 
@@ -3094,6 +3099,53 @@ void MainWidget::feedMessageIds(const MTPVector<MTPUpdate> &updates) {
 	}
 }
 
+void MainWidget::startUpdatesBatch() {
+	++_updatesBatchLevel;
+}
+
+void MainWidget::finishUpdatesBatch() {
+	t_assert(_updatesBatchLevel > 0);
+	if (--_updatesBatchLevel > 0) {
+		return;
+	}
+
+	// Each chat is re-sorted in the chats list once per batch,
+	// no matter how many of its messages were received.
+	auto dialogs = base::take(_updatesBatchDialogs);
+	for_const (auto peerId, dialogs) {
+		if (auto history = App::historyLoaded(peerId)) {
+			if (history->sortKeyInChatList() && history->needUpdateInChatList()) {
+				_dialogs->createDialog(history);
+				history->updateChatListEntry();
+			}
+		}
+	}
+
+	auto messages = base::take(_updatesBatchMessages);
+	if (base::take(_updatesBatchCurrentMessages)) {
+		_history->peerMessagesUpdated();
+	}
+	for_const (auto peerId, messages) {
+		_history->peerMessagesUpdated(peerId);
+	}
+}
+
+void MainWidget::peerMessagesUpdated(PeerId peerId) {
+	if (_updatesBatchLevel > 0) {
+		_updatesBatchMessages.insert(peerId);
+	} else {
+		_history->peerMessagesUpdated(peerId);
+	}
+}
+
+void MainWidget::peerMessagesUpdated() {
+	if (_updatesBatchLevel > 0) {
+		_updatesBatchCurrentMessages = true;
+	} else {
+		_history->peerMessagesUpdated();
+	}
+}
+
 bool MainWidget::updateFail(const RPCError &e) {
 	App::logOutDelayed();
 	return true;
@@ -3131,6 +3183,9 @@ void MainWidget::updSetState(int32 pts, int32 date, int32 qts, int32 seq) {
 void MainWidget::gotChannelDifference(ChannelData *channel, const MTPupdates_ChannelDifference &diff) {
 	_channelFailDifferenceTimeout.remove(channel);
 
+	startUpdatesBatch();
+	auto finishBatch = base::scope_guard([this] { finishUpdatesBatch(); });
+
 	int32 timeout = 0;
 	bool isFinal = true;
 	switch (diff.type()) {
@@ -3294,6 +3349,35 @@ void MainWidget::gotState(const MTPupdates_State &state) {
 	updateOnline();
 }
 
+namespace {
+
+constexpr auto kDifferencePartTimeMs = 8;
+constexpr auto kDifferenceMessagesChunk = 16;
+
+QVector<MTPMessage> sortedDifferenceMessages(const MTPVector<MTPMessage> &msgs) {
+	// Same order as App::feedMsgs() uses: by message id, then by index.
+	auto &v = msgs.c_vector().v;
+	auto msgsIds = QMap<uint64, int>();
+	for (auto i = 0, l = v.size(); i != l; ++i) {
+		auto id = MsgId(0);
+		switch (v[i].type()) {
+		case mtpc_message: id = v[i].c_message().vid.v; break;
+		case mtpc_messageEmpty: id = v[i].c_messageEmpty().vid.v; break;
+		case mtpc_messageService: id = v[i].c_messageService().vid.v; break;
+		default: continue;
+		}
+		msgsIds.insert((uint64(uint32(id)) << 32) | uint64(i), i);
+	}
+	auto result = QVector<MTPMessage>();
+	result.reserve(msgsIds.size());
+	for_const (auto index, msgsIds) {
+		result.push_back(v[index]);
+	}
+	return result;
+}
+
+} // namespace
+
 void MainWidget::gotDifference(const MTPupdates_Difference &difference) {
 	_failDifferenceTimeout = 1;
 
@@ -3306,28 +3390,20 @@ void MainWidget::gotDifference(const MTPupdates_Difference &difference) {
 		noUpdatesTimer.start(NoUpdatesTimeout);
 
 		_ptsWaiter.setRequesting(false);
+		finishDifference();
 	} break;
 	case mtpc_updates_differenceSlice: {
 		auto &d = difference.c_updates_differenceSlice();
-		feedDifference(d.vusers, d.vchats, d.vnew_messages, d.vother_updates);
-
-		auto &s = d.vintermediate_state.c_updates_state();
-		updSetState(s.vpts.v, s.vdate.v, s.vqts.v, s.vseq.v);
-
-		_ptsWaiter.setRequesting(false);
-
-		MTP_LOG(0, ("getDifference { good - after a slice of difference was received }%1").arg(cTestMode() ? " TESTMODE" : ""));
-		getDifference();
+		startDifference(d.vusers, d.vchats, d.vnew_messages, d.vother_updates, d.vintermediate_state, true);
 	} break;
 	case mtpc_updates_difference: {
 		auto &d = difference.c_updates_difference();
-		feedDifference(d.vusers, d.vchats, d.vnew_messages, d.vother_updates);
-
-		gotState(d.vstate);
+		startDifference(d.vusers, d.vchats, d.vnew_messages, d.vother_updates, d.vstate, false);
 	} break;
 	case mtpc_updates_differenceTooLong: {
 		auto &d = difference.c_updates_differenceTooLong();
 		LOG(("API Error: updates.differenceTooLong is not supported by Telegram Desktop!"));
+		finishDifference();
 	} break;
 	};
 }
@@ -3417,14 +3493,95 @@ void MainWidget::ptsApplySkippedUpdates() {
 	return _ptsWaiter.applySkippedUpdates(0);
 }
 
-void MainWidget::feedDifference(const MTPVector<MTPUser> &users, const MTPVector<MTPChat> &chats, const MTPVector<MTPMessage> &msgs, const MTPVector<MTPUpdate> &other) {
+void MainWidget::startDifference(const MTPVector<MTPUser> &users, const MTPVector<MTPChat> &chats, const MTPVector<MTPMessage> &msgs, const MTPVector<MTPUpdate> &other, const MTPupdates_State &state, bool slice) {
 	App::wnd()->checkAutoLock();
-	App::feedUsers(users);
-	App::feedChats(chats);
-	feedMessageIds(other);
-	App::feedMsgs(msgs, NewMessageUnread);
-	feedUpdateVector(other, true);
-	_history->peerMessagesUpdated();
+
+	// The pts waiter stays in the requesting state until the whole
+	// difference is applied, so received updates are not fed meanwhile.
+	t_assert(_pendingDifference == nullptr);
+	_pendingDifference = std_::make_unique<PendingDifference>();
+	_pendingDifference->users = users;
+	_pendingDifference->chats = chats;
+	_pendingDifference->messages = sortedDifferenceMessages(msgs);
+	_pendingDifference->other = other;
+	_pendingDifference->state = state;
+	_pendingDifference->slice = slice;
+	_differenceMessagesCount += _pendingDifference->messages.size();
+
+	applyDifferencePart();
+}
+
+void MainWidget::applyDifferencePart() {
+	if (!_pendingDifference) return;
+
+	auto &pending = *_pendingDifference;
+	auto started = getms();
+	auto timeLeft = [started] {
+		return (getms() - started < kDifferencePartTimeMs);
+	};
+
+	startUpdatesBatch();
+	auto finishBatch = base::scope_guard([this] { finishUpdatesBatch(); });
+
+	auto &users = pending.users.c_vector().v;
+	while (pending.usersApplied < users.size()) {
+		App::feedUser(users[pending.usersApplied++]);
+		if (!timeLeft()) break;
+	}
+	auto &chats = pending.chats.c_vector().v;
+	while (pending.usersApplied == users.size() && pending.chatsApplied < chats.size()) {
+		App::feedChat(chats[pending.chatsApplied++]);
+		if (!timeLeft()) break;
+	}
+	auto peersApplied = (pending.usersApplied == users.size() && pending.chatsApplied == chats.size());
+	if (peersApplied && !pending.messageIdsApplied) {
+		feedMessageIds(pending.other);
+		pending.messageIdsApplied = true;
+	}
+	auto &messages = pending.messages;
+	while (peersApplied && pending.messagesApplied < messages.size() && timeLeft()) {
+		auto count = qMin(messages.size() - pending.messagesApplied, kDifferenceMessagesChunk);
+		App::feedMsgs(messages.mid(pending.messagesApplied, count), NewMessageUnread);
+		pending.messagesApplied += count;
+	}
+	auto &other = pending.other.c_vector().v;
+	while (peersApplied && pending.messagesApplied == messages.size() && pending.otherApplied < other.size()) {
+		auto &update = other[pending.otherApplied++];
+		if (update.type() != mtpc_updateMessageID) {
+			feedUpdate(update);
+		}
+		if (!timeLeft()) break;
+	}
+	peerMessagesUpdated();
+
+	if (pending.otherApplied < other.size() || pending.messagesApplied < messages.size() || !peersApplied) {
+		_pendingDifferenceTimer.start(0);
+		return;
+	}
+
+	auto state = pending.state;
+	auto slice = pending.slice;
+	_pendingDifference = nullptr;
+	if (slice) {
+		auto &s = state.c_updates_state();
+		updSetState(s.vpts.v, s.vdate.v, s.vqts.v, s.vseq.v);
+
+		_ptsWaiter.setRequesting(false);
+
+		MTP_LOG(0, ("getDifference { good - after a slice of difference was received }%1").arg(cTestMode() ? " TESTMODE" : ""));
+		getDifference();
+	} else {
+		gotState(state);
+		finishDifference();
+	}
+}
+
+void MainWidget::finishDifference() {
+	if (_differenceStartTime) {
+		MTP_LOG(0, ("getDifference { caught up in %1ms, %2 new messages }%3").arg(getms(true) - _differenceStartTime).arg(_differenceMessagesCount).arg(cTestMode() ? " TESTMODE" : ""));
+	}
+	_differenceStartTime = 0;
+	_differenceMessagesCount = 0;
 }
 
 bool MainWidget::failDifference(const RPCError &error) {
@@ -3498,6 +3655,10 @@ void MainWidget::getDifference() {
 
 	if (requestingDifference()) return;
 
+	if (!_differenceStartTime) {
+		_differenceStartTime = getms(true);
+	}
+
 	_bySeqUpdates.clear();
 	_bySeqTimer.stop();
 
@@ -4308,6 +4469,9 @@ DataIsLoadedResult allDataLoadedForMessage(const MTPMessage &msg) {
 } // namespace
 
 void MainWidget::feedUpdates(const MTPUpdates &updates, uint64 randomId) {
+	startUpdatesBatch();
+	auto finishBatch = base::scope_guard([this] { finishUpdatesBatch(); });
+
 	switch (updates.type()) {
 	case mtpc_updates: {
 		auto &d = updates.c_updates();
@@ -4367,7 +4531,7 @@ void MainWidget::feedUpdates(const MTPUpdates &updates, uint64 randomId) {
 		MTPDmessage::Flags flags = mtpCastFlags(d.vflags.v) | MTPDmessage::Flag::f_from_id;
 		auto item = App::histories().addNewMessage(MTP_message(MTP_flags(flags), d.vid, d.is_out() ? MTP_int(MTP::authedId()) : d.vuser_id, MTP_peerUser(d.is_out() ? d.vuser_id : MTP_int(MTP::authedId())), d.vfwd_from, d.vvia_bot_id, d.vreply_to_msg_id, d.vdate, d.vmessage, MTP_messageMediaEmpty(), MTPnullMarkup, d.has_entities() ? d.ventities : MTPnullEntities, MTPint(), MTPint()), NewMessageUnread);
 		if (item) {
-			_history->peerMessagesUpdated(item->history()->peer->id);
+			peerMessagesUpdated(item->history()->peer->id);
 		}
 
 		ptsApplySkippedUpdates();
@@ -4395,7 +4559,7 @@ void MainWidget::feedUpdates(const MTPUpdates &updates, uint64 randomId) {
 		MTPDmessage::Flags flags = mtpCastFlags(d.vflags.v) | MTPDmessage::Flag::f_from_id;
 		auto item = App::histories().addNewMessage(MTP_message(MTP_flags(flags), d.vid, d.vfrom_id, MTP_peerChat(d.vchat_id), d.vfwd_from, d.vvia_bot_id, d.vreply_to_msg_id, d.vdate, d.vmessage, MTP_messageMediaEmpty(), MTPnullMarkup, d.has_entities() ? d.ventities : MTPnullEntities, MTPint(), MTPint()), NewMessageUnread);
 		if (item) {
-			_history->peerMessagesUpdated(item->history()->peer->id);
+			peerMessagesUpdated(item->history()->peer->id);
 		}
 
 		ptsApplySkippedUpdates();
@@ -4470,7 +4634,7 @@ void MainWidget::feedUpdate(const MTPUpdate &update) {
 		}
 		if (needToAdd) {
 			if (auto item = App::histories().addNewMessage(d.vmessage, NewMessageUnread)) {
-				_history->peerMessagesUpdated(item->history()->peer->id);
+				peerMessagesUpdated(item->history()->peer->id);
 			}
 		}
 		ptsApplySkippedUpdates();
@@ -4488,7 +4652,7 @@ void MainWidget::feedUpdate(const MTPUpdate &update) {
 					if (wasLast && !history->lastMsg) {
 						checkPeerHistory(history->peer);
 					}
-					_history->peerMessagesUpdated();
+					peerMessagesUpdated();
 				} else {
 					App::historyUnregItem(msgRow);
 					if (App::wnd()) App::wnd()->changingMsgId(msgRow, d.vid.v);
@@ -4585,7 +4749,7 @@ void MainWidget::feedUpdate(const MTPUpdate &update) {
 
 		// update before applying skipped
 		App::feedWereDeleted(NoChannel, d.vmessages.c_vector().v);
-		_history->peerMessagesUpdated();
+		peerMessagesUpdated();
 
 		ptsApplySkippedUpdates();
 	} break;
@@ -4871,7 +5035,7 @@ void MainWidget::feedUpdate(const MTPUpdate &update) {
 		}
 		if (needToAdd) {
 			if (auto item = App::histories().addNewMessage(d.vmessage, NewMessageUnread)) {
-				_history->peerMessagesUpdated(item->history()->peer->id);
+				peerMessagesUpdated(item->history()->peer->id);
 			}
 		}
 		if (channel && !_handlingChannelDifference) {
@@ -4976,7 +5140,7 @@ void MainWidget::feedUpdate(const MTPUpdate &update) {
 
 		// update before applying skipped
 		App::feedWereDeleted(d.vchannel_id.v, d.vmessages.c_vector().v);
-		_history->peerMessagesUpdated();
+		peerMessagesUpdated();
 
 		if (channel && !_handlingChannelDifference) {
 			channel->ptsApplySkippedUpdates();
@@ -362,6 +362,11 @@ public:
 	void feedUpdate(const MTPUpdate &update);
 	void updateAfterDrag();
 
+	// While a batch is active chats list re-sorting and history widget
+	// updates are collected per peer and applied once the batch finishes.
+	void startUpdatesBatch();
+	void finishUpdatesBatch();
+
 	void ctrlEnterSubmitUpdated();
 	void setInnerFocus();
 
@@ -529,6 +534,11 @@ private:
 
 	SingleTimer _updateMutedTimer;
 
+	int _updatesBatchLevel = 0;
+	OrderedSet<PeerId> _updatesBatchDialogs;
+	OrderedSet<PeerId> _updatesBatchMessages;
+	bool _updatesBatchCurrentMessages = false;
+
 	enum class ChannelDifferenceRequest {
 		Unknown,
 		PtsGapOrShortPoll,
@@ -537,7 +547,9 @@ private:
 	void getChannelDifference(ChannelData *channel, ChannelDifferenceRequest from = ChannelDifferenceRequest::Unknown);
 	void gotDifference(const MTPupdates_Difference &diff);
 	bool failDifference(const RPCError &e);
-	void feedDifference(const MTPVector<MTPUser> &users, const MTPVector<MTPChat> &chats, const MTPVector<MTPMessage> &msgs, const MTPVector<MTPUpdate> &other);
+	void startDifference(const MTPVector<MTPUser> &users, const MTPVector<MTPChat> &chats, const MTPVector<MTPMessage> &msgs, const MTPVector<MTPUpdate> &other, const MTPupdates_State &state, bool slice);
+	void applyDifferencePart();
+	void finishDifference();
 	void gotState(const MTPupdates_State &state);
 	void updSetState(int32 pts, int32 date, int32 qts, int32 seq);
 	void gotChannelDifference(ChannelData *channel, const MTPupdates_ChannelDifference &diff);
@@ -547,6 +559,9 @@ private:
 	void feedUpdateVector(const MTPVector<MTPUpdate> &updates, bool skipMessageIds = false);
 	void feedMessageIds(const MTPVector<MTPUpdate> &updates);
 
+	void peerMessagesUpdated(PeerId peerId);
+	void peerMessagesUpdated();
+
 	struct DeleteHistoryRequest {
 		PeerData *peer;
 		bool justClearHistory;
@@ -626,6 +641,27 @@ private:
 		return _ptsWaiter.requesting();
 	}
 
+	// Large getDifference results are applied in parts with a time limit,
+	// so that the main window is repainted while we catch up.
+	struct PendingDifference {
+		MTPVector<MTPUser> users;
+		MTPVector<MTPChat> chats;
+		QVector<MTPMessage> messages; // sorted by message id
+		MTPVector<MTPUpdate> other;
+		MTPupdates_State state;
+		bool slice = false;
+
+		int usersApplied = 0;
+		int chatsApplied = 0;
+		bool messageIdsApplied = false;
+		int messagesApplied = 0;
+		int otherApplied = 0;
+	};
+	std_::unique_ptr<PendingDifference> _pendingDifference;
+	SingleTimer _pendingDifferenceTimer;
+	TimeMs _differenceStartTime = 0;
+	int _differenceMessagesCount = 0;
+
 	typedef QMap<ChannelData*, TimeMs> ChannelGetDifferenceTime;
 	ChannelGetDifferenceTime _channelGetDifferenceTimeByPts, _channelGetDifferenceTimeAfterFail;
 	TimeMs _getDifferenceTimeByPts = 0;
@@ -135,7 +135,7 @@ void Instance::moveInPlaylist(int delta) {
 	}
 
 	auto msgId = _playlist[newIndex];
-	if (auto item = App::histItemById(msgId)) {
+	if (auto item = playlistItem(msgId)) {
 		if (auto media = item->getMedia()) {
 			if (auto document = media->getDocument()) {
 				if (auto song = document->song()) {
@@ -146,6 +146,11 @@ void Instance::moveInPlaylist(int delta) {
 	}
 }
 
+HistoryItem *Instance::playlistItem(const FullMsgId &msgId) const {
+	auto history = (_migrated && _migrated->channelId() == msgId.channel) ? _migrated : _history;
+	return history ? history->overviewItem(OverviewMusicFiles, msgId.msg) : App::histItemById(msgId);
+}
+
 Instance *instance() {
 	t_assert(SingleInstance != nullptr);
 	return SingleInstance;
@@ -291,7 +296,7 @@ void Instance::preloadNext() {
 	if (nextIndex >= _playlist.size()) {
 		return;
 	}
-	if (auto item = App::histItemById(_playlist[nextIndex])) {
+	if (auto item = playlistItem(_playlist[nextIndex])) {
 		if (auto media = item->getMedia()) {
 			if (auto document = media->getDocument()) {
 				if (!document->loaded(DocumentData::FilePathResolveSaveFromDataSilent)) {
@@ -119,6 +119,7 @@ private:
 	void rebuildPlaylist();
 	void moveInPlaylist(int delta);
 	void preloadNext();
+	HistoryItem *playlistItem(const FullMsgId &msgId) const;
 	void handleLogout();
 
 	template <typename CheckCallback>
@@ -167,24 +167,12 @@ void MediaView::mediaOverviewUpdated(const Notify::PeerUpdate &update) {
 	}
 
 	if (_history && (_history->peer == update.peer || (_migrated && _migrated->peer == update.peer)) && (update.mediaTypesMask & (1 << _overview)) && _msgid) {
-		_index = -1;
-		if (_msgmigrated) {
-			for (int i = 0, l = _migrated->overview[_overview].size(); i < l; ++i) {
-				if (_migrated->overview[_overview].at(i) == _msgid) {
-					_index = i;
-					break;
-				}
-			}
-		} else {
-			for (int i = 0, l = _history->overview[_overview].size(); i < l; ++i) {
-				if (_history->overview[_overview].at(i) == _msgid) {
-					_index = i;
-					break;
-				}
-			}
-		}
+		_index = (_msgmigrated ? _migrated : _history)->overview[_overview].indexOf(_msgid);
 		updateControls();
 		preloadData(0);
+		if (auto delta = base::take(_pendingMoveDelta)) {
+			moveToNext(delta);
+		}
 	} else if (_user == update.peer && update.mediaTypesMask & (1 << OverviewCount)) {
 		if (!_photo) return;
 
@@ -613,6 +601,7 @@ void MediaView::clearData() {
 	_history = _migrated = nullptr;
 	_peer = _from = nullptr;
 	_user = nullptr;
+	_pendingMoveDelta = 0;
 	_photo = _additionalChatPhoto = nullptr;
 	_doc = nullptr;
 	_fullScreenVideo = false;
@@ -977,6 +966,7 @@ void MediaView::onCopy() {
 }
 
 void MediaView::showPhoto(PhotoData *photo, HistoryItem *context) {
+	_pendingMoveDelta = 0;
 	_history = context ? context->history() : nullptr;
 	_migrated = nullptr;
 	if (_history) {
@@ -1028,6 +1018,7 @@ void MediaView::showPhoto(PhotoData *photo, HistoryItem *context) {
 }
 
 void MediaView::showPhoto(PhotoData *photo, PeerData *context) {
+	_pendingMoveDelta = 0;
 	_history = _migrated = nullptr;
 	_additionalChatPhoto = nullptr;
 	_firstOpenedPeerPhoto = true;
@@ -1094,6 +1085,7 @@ void MediaView::showPhoto(PhotoData *photo, PeerData *context) {
 }
 
 void MediaView::showDocument(DocumentData *doc, HistoryItem *context) {
+	_pendingMoveDelta = 0;
 	_photo = 0;
 	_history = context ? context->history() : nullptr;
 	_migrated = nullptr;
@@ -2130,6 +2122,7 @@ bool MediaView::moveToNext(int32 delta) {
 	}
 
 	int32 newIndex = _index + delta;
+	_pendingMoveDelta = 0;
 	if (_history && _overview != OverviewCount) {
 		bool newMigrated = _msgmigrated;
 		if (!newMigrated && newIndex < 0 && _migrated) {
@@ -2140,7 +2133,8 @@ bool MediaView::moveToNext(int32 delta) {
 			newMigrated = false;
 		}
 		if (newIndex >= 0 && newIndex < (newMigrated ? _migrated : _history)->overview[_overview].size()) {
-			if (HistoryItem *item = App::histItemById(newMigrated ? 0 : _channel, (newMigrated ? _migrated : _history)->overview[_overview][newIndex])) {
+			auto newHistory = (newMigrated ? _migrated : _history);
+			if (HistoryItem *item = newHistory->overviewItem(_overview, newHistory->overview[_overview][newIndex])) {
 				_index = newIndex;
 				_msgid = item->id;
 				_msgmigrated = (item->history() == _migrated);
@@ -2160,6 +2154,9 @@ bool MediaView::moveToNext(int32 delta) {
 					displayDocument(nullptr, item);
 					preloadData(delta);
 				}
+			} else {
+				// The item was unloaded with its history block and is requested again.
+				_pendingMoveDelta = delta;
 			}
 		} else if (!newMigrated && newIndex == _history->overview[_overview].size() && _additionalChatPhoto) {
 			_index = -1;
@@ -2236,7 +2233,7 @@ void MediaView::preloadData(int32 delta) {
 				}
 			}
 			if (previewIndex >= 0 && previewIndex < previewHistory->overview[_overview].size() && (previewHistory != (indexOfMigratedItem ? _migrated : _history) || previewIndex != indexInOverview)) {
-				if (HistoryItem *item = App::histItemById(previewHistory->channelId(), previewHistory->overview[_overview][previewIndex])) {
+				if (HistoryItem *item = previewHistory->overviewItem(_overview, previewHistory->overview[_overview][previewIndex])) {
 					if (HistoryMedia *media = item->getMedia()) {
 						switch (media->type()) {
 						case MediaTypePhoto: static_cast<HistoryPhoto*>(media)->photo()->download(); break;
@@ -2711,11 +2708,9 @@ void MediaView::updateImage() {
 
 void MediaView::findCurrent() {
 	if (_msgmigrated) {
-		for (int i = 0, l = _migrated->overview[_overview].size(); i < l; ++i) {
-			if (_migrated->overview[_overview].at(i) == _msgid) {
-				_index = i;
-				break;
-			}
+		auto index = _migrated->overview[_overview].indexOf(_msgid);
+		if (index >= 0) {
+			_index = index;
 		}
 		if (!_history->overviewCountLoaded(_overview)) {
 			loadBack();
@@ -2725,11 +2720,9 @@ void MediaView::findCurrent() {
 			}
 		}
 	} else {
-		for (int i = 0, l = _history->overview[_overview].size(); i < l; ++i) {
-			if (_history->overview[_overview].at(i) == _msgid) {
-				_index = i;
-				break;
-			}
+		auto index = _history->overview[_overview].indexOf(_msgid);
+		if (index >= 0) {
+			_index = index;
 		}
 		if (!_history->overviewLoaded(_overview)) {
 			if (!_history->overviewCountLoaded(_overview) || (_index < 2 && _history->overviewCount(_overview) > 0) || (_index < 1 && _migrated && !_migrated->overviewLoaded(_overview))) {
@@ -2787,7 +2780,7 @@ void MediaView::generateTransparentBrush() {
 
 MediaView::LastChatPhoto MediaView::computeLastOverviewChatPhoto() {
 	LastChatPhoto emptyResult = { nullptr, nullptr };
-	auto lastPhotoInOverview = [&emptyResult](auto history, auto list) -> LastChatPhoto {
+	auto lastPhotoInOverview = [&emptyResult](auto history, auto &list) -> LastChatPhoto {
 		if (auto item = App::histItemById(history->channelId(), list.back())) {
 			if (auto media = item->getMedia()) {
 				if (media->type() == MediaTypePhoto && !item->toHistoryMessage()) {
@@ -307,6 +307,7 @@ private:
 	int _index = -1; // index in photos or files array, -1 if just photo
 	MsgId _msgid = 0; // msgId of current photo or file
 	bool _msgmigrated = false; // msgId is from _migrated history
+	int _pendingMoveDelta = 0; // moveToNext() waits for the target item to be received
 	ChannelId _channel = NoChannel;
 	bool _canForward = false;
 	bool _canDelete = false;
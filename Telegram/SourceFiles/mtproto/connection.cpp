@@ -31,6 +31,8 @@ Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
 #include "zlib.h"
 
 #include "mtproto/rsa_public_key.h"
+#include "mtproto/packet_log.h"
+#include "mtproto/rpc_stats.h"
 
 using std::string;
 
@@ -387,53 +389,65 @@ Connection::~Connection() {
 	t_assert(data == nullptr && thread == nullptr);
 }
 
-void ConnectionPrivate::createConn(bool createIPv4, bool createIPv6) {
-	destroyConn();
-	if (createIPv4) {
-		QWriteLocker lock(&stateConnMutex);
-		_conn4 = AbstractConnection::create(thread());
-		connect(_conn4, SIGNAL(error(bool)), this, SLOT(onError4(bool)));
-		connect(_conn4, SIGNAL(receivedSome()), this, SLOT(onReceivedSome()));
-	}
-	if (createIPv6) {
+void ConnectionPrivate::createConn(const TestConnection &test) {
+	auto conn = AbstractConnection::create(thread());
+	connect(conn, SIGNAL(error(bool)), this, SLOT(onError(bool)));
+	connect(conn, SIGNAL(receivedSome()), this, SLOT(onReceivedSome()));
+	connect(conn, SIGNAL(connected()), this, SLOT(onConnected()));
+	connect(conn, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
+
+	QWriteLocker lock(&stateConnMutex);
+	_testConnections.push_back(test);
+	_testConnections.back().data = conn;
+	_testConnections.back().startedAt = getms(true);
+}
+
+void ConnectionPrivate::destroyConn(AbstractConnection *conn) {
+	QVector<AbstractConnection*> toDisconnect;
+	{
 		QWriteLocker lock(&stateConnMutex);
-		_conn6 = AbstractConnection::create(thread());
-		connect(_conn6, SIGNAL(error(bool)), this, SLOT(onError6(bool)));
-		connect(_conn6, SIGNAL(receivedSome()), this, SLOT(onReceivedSome()));
+		for (auto i = _testConnections.begin(); i != _testConnections.end();) {
+			if (conn && i->data != conn) {
+				++i;
+				continue;
+			}
+			disconnect(i->data, SIGNAL(connected()), nullptr, nullptr);
+			disconnect(i->data, SIGNAL(disconnected()), nullptr, nullptr);
+			disconnect(i->data, SIGNAL(error(bool)), nullptr, nullptr);
+			disconnect(i->data, SIGNAL(receivedData()), nullptr, nullptr);
+			disconnect(i->data, SIGNAL(receivedSome()), nullptr, nullptr);
+			toDisconnect.push_back(i->data);
+			if (_conn == i->data) {
+				_conn = nullptr;
+			}
+			i = _testConnections.erase(i);
+		}
+		if (!conn) {
+			_conn = nullptr;
+		}
 	}
-	firstSentAt = 0;
-	if (oldConnection) {
-		oldConnection = false;
-		DEBUG_LOG(("This connection marked as not old!"));
+	for_const (auto connection, toDisconnect) {
+		connection->disconnectFromServer();
+		connection->deleteLater();
 	}
-	oldConnectionTimer.start(MTPConnectionOldTimeout);
 }
 
-void ConnectionPrivate::destroyConn(AbstractConnection **conn) {
-	if (conn) {
-		AbstractConnection *toDisconnect = nullptr;
-
-		{
-			QWriteLocker lock(&stateConnMutex);
-			if (*conn) {
-				toDisconnect = *conn;
-				disconnect(*conn, SIGNAL(connected()), nullptr, nullptr);
-				disconnect(*conn, SIGNAL(disconnected()), nullptr, nullptr);
-				disconnect(*conn, SIGNAL(error(bool)), nullptr, nullptr);
-				disconnect(*conn, SIGNAL(receivedData()), nullptr, nullptr);
-				disconnect(*conn, SIGNAL(receivedSome()), nullptr, nullptr);
-				*conn = nullptr;
-			}
+int ConnectionPrivate::findTestConnection(AbstractConnection *conn) const {
+	for (int i = 0, count = _testConnections.size(); i != count; ++i) {
+		if (_testConnections[i].data == conn) {
+			return i;
 		}
-		if (toDisconnect) {
-			toDisconnect->disconnectFromServer();
-			toDisconnect->deleteLater();
+	}
+	return -1;
+}
+
+bool ConnectionPrivate::hasWaitingIPv4() const {
+	for_const (auto &test, _testConnections) {
+		if (!test.ipv6 && !test.connected) {
+			return true;
 		}
-	} else {
-		destroyConn(&_conn4);
-		destroyConn(&_conn6);
-		_conn = nullptr;
 	}
+	return false;
 }
 
 ConnectionPrivate::ConnectionPrivate(QThread *thread, Connection *owner, SessionData *data, uint32 _dc) : QObject(nullptr)
@@ -497,6 +511,8 @@ ConnectionPrivate::ConnectionPrivate(QThread *thread, Connection *owner, Session
 	connect(this, SIGNAL(resendAsync(quint64,qint64,bool,bool)), sessionData->owner(), SLOT(resend(quint64,qint64,bool,bool)), Qt::QueuedConnection);
 	connect(this, SIGNAL(resendManyAsync(QVector<quint64>,qint64,bool,bool)), sessionData->owner(), SLOT(resendMany(QVector<quint64>,qint64,bool,bool)), Qt::QueuedConnection);
 	connect(this, SIGNAL(resendAllAsync()), sessionData->owner(), SLOT(resendAll()));
+	connect(this, SIGNAL(serverSaltsReceivedAsync()), sessionData->owner(), SLOT(onServerSaltsReceived()), Qt::QueuedConnection);
+	connect(this, SIGNAL(endpointsRankingChangedAsync()), sessionData->owner(), SLOT(onEndpointsRankingChanged()), Qt::QueuedConnection);
 }
 
 void ConnectionPrivate::onConfigLoaded() {
@@ -523,11 +539,12 @@ int32 ConnectionPrivate::getState() const {
 
 QString ConnectionPrivate::transport() const {
 	QReadLocker lock(&stateConnMutex);
-	if ((!_conn4 && !_conn6) || (_conn4 && _conn6) || (_state < 0)) {
+	if (_testConnections.size() != 1 || (_state < 0)) {
 		return QString();
 	}
-	QString result = (_conn4 ? _conn4 : _conn6)->transport();
-	if (!result.isEmpty() && Global::TryIPv6()) result += (_conn4 ? "/IPv4" : "/IPv6");
+	auto &test = _testConnections.front();
+	QString result = test.data->transport();
+	if (!result.isEmpty() && Global::TryIPv6()) result += (test.ipv6 ? "/IPv6" : "/IPv4");
 	return result;
 }
 
@@ -550,6 +567,7 @@ bool ConnectionPrivate::setState(int32 state, int32 ifState) {
 
 void ConnectionPrivate::resetSession() { // recreate all msg_id and msg_seqno
 	_needSessionReset = false;
+	clearFutureSaltsRequest();
 
 	QWriteLocker locker1(sessionData->haveSentMutex());
 	QWriteLocker locker2(sessionData->toResendMutex());
@@ -659,6 +677,7 @@ void ConnectionPrivate::resetSession() { // recreate all msg_id and msg_seqno
 	}
 
 	ackRequestData.clear();
+	_ackRequestDataSince = 0;
 	resendRequestData.clear();
 	{
 		QWriteLocker locker5(sessionData->stateRequestMutex());
@@ -770,6 +789,7 @@ void ConnectionPrivate::tryToSend() {
 	bool needsLayer = !sessionData->layerWasInited();
 	int32 state = getState();
 	bool prependOnly = (state != ConnectedState);
+	applyCachedSalt();
 	mtpRequest pingRequest;
 	if (dc == bareDcId(dc)) { // main session
 		if (!prependOnly && !_pingIdToSend && !_pingId && _pingSendAt <= getms(true)) {
@@ -810,7 +830,26 @@ void ConnectionPrivate::tryToSend() {
 		}
 	}
 
-	mtpRequest ackRequest, resendRequest, stateRequest, httpWaitRequest;
+	mtpRequest ackRequest, resendRequest, stateRequest, httpWaitRequest, saltsRequest;
+	if (_futureSaltsRequested && getms(true) - _futureSaltsRequestedAt > MTPFutureSaltsRequestTimeout) {
+		DEBUG_LOG(("MTP Info: future server salts request for dc %1 timed out").arg(dc));
+		clearFutureSaltsRequest();
+	}
+	if (!prependOnly && !_futureSaltsRequested && serverSaltsNeeded(bareDcId(dc), keyId, unixtime())) {
+		MTPGet_future_salts req(MTP_int(MTPFutureSaltsCount));
+
+		saltsRequest = mtpRequestData::prepare(req.innerLength() >> 2);
+		req.write(*saltsRequest);
+
+		saltsRequest->msDate = getms(true); // > 0 - can send without container
+		saltsRequest->requestId = 0; // dont add to haveSent / wereAcked maps
+
+		_futureSaltsRequested = true;
+		_futureSaltsRequestedAt = getms(true);
+		DEBUG_LOG(("MTP Info: requesting %1 future server salts for dc %2").arg(int(MTPFutureSaltsCount)).arg(dc));
+	}
+	QVector<MTPlong> ackSending;
+	TimeMs ackSendingSince = 0;
 	if (!prependOnly && !ackRequestData.isEmpty()) {
 		MTPMsgsAck ack(MTP_msgs_ack(MTP_vector<MTPlong>(ackRequestData)));
 
@@ -820,7 +859,8 @@ void ConnectionPrivate::tryToSend() {
 		ackRequest->msDate = getms(true); // > 0 - can send without container
 		ackRequest->requestId = 0; // dont add to haveSent / wereAcked maps
 
-		ackRequestData.clear();
+		ackSending = base::take(ackRequestData);
+		ackSendingSince = base::take(_ackRequestDataSince);
 	}
 	if (!prependOnly && !resendRequestData.isEmpty()) {
 		MTPMsgResendReq resend(MTP_msg_resend_req(MTP_vector<MTPlong>(resendRequestData)));
@@ -888,10 +928,24 @@ void ConnectionPrivate::tryToSend() {
 		if (resendRequest) ++toSendCount;
 		if (stateRequest) ++toSendCount;
 		if (httpWaitRequest) ++toSendCount;
+		if (saltsRequest) ++toSendCount;
 
 		if (!toSendCount) return; // nothing to send
 
-		mtpRequest first = pingRequest ? pingRequest : (ackRequest ? ackRequest : (resendRequest ? resendRequest : (stateRequest ? stateRequest : (httpWaitRequest ? httpWaitRequest : toSend.cbegin().value()))));
+		if (toSendCount == 1 && ackRequest && ackSending.size() < MTPAckSendMaxCount) {
+			auto waitingFor = getms(true) - ackSendingSince;
+			if (ackSendingSince && waitingFor < MTPAckSendWaiting) {
+				// don't send msgs_ack alone, wait for some more requests to put it in a container with them
+				DEBUG_LOG(("MTP Info: dc %1 holding %2 acks for %3ms more").arg(dc).arg(ackSending.size()).arg(MTPAckSendWaiting - waitingFor));
+				ackRequestData = ackSending + ackRequestData;
+				_ackRequestDataSince = ackSendingSince;
+				emit sendAnythingAsync(MTPAckSendWaiting - waitingFor);
+				return;
+			}
+		}
+		statsPacketSent(dc, (toSendCount == 1 && ackRequest), ackSending.size());
+
+		mtpRequest first = pingRequest ? pingRequest : (ackRequest ? ackRequest : (resendRequest ? resendRequest : (stateRequest ? stateRequest : (httpWaitRequest ? httpWaitRequest : (saltsRequest ? saltsRequest : toSend.cbegin().value())))));
 		if (toSendCount == 1 && first->msDate > 0) { // if can send without container
 			toSendRequest = first;
 			if (!prependOnly) {
@@ -903,6 +957,9 @@ void ConnectionPrivate::tryToSend() {
 			if (pingRequest) {
 				_pingMsgId = msgId;
 				needAnyResponse = true;
+			} else if (saltsRequest) {
+				_futureSaltsMsgId = msgId;
+				needAnyResponse = true;
 			} else if (resendRequest || stateRequest) {
 				needAnyResponse = true;
 			}
@@ -914,6 +971,7 @@ void ConnectionPrivate::tryToSend() {
 					QWriteLocker locker2(sessionData->haveSentMutex());
 					mtpRequestMap &haveSent(sessionData->haveSentMap());
 					haveSent.insert(msgId, toSendRequest);
+					statsRequestSent(toSendRequest->requestId);
 
 					if (needsLayer && !toSendRequest->needsLayer) needsLayer = false;
 					if (toSendRequest->after) {
@@ -950,6 +1008,7 @@ void ConnectionPrivate::tryToSend() {
 			if (resendRequest) containerSize += mtpRequestData::messageSize(resendRequest);
 			if (stateRequest) containerSize += mtpRequestData::messageSize(stateRequest);
 			if (httpWaitRequest) containerSize += mtpRequestData::messageSize(httpWaitRequest);
+			if (saltsRequest) containerSize += mtpRequestData::messageSize(saltsRequest);
 			for (mtpPreRequestMap::iterator i = toSend.begin(), e = toSend.end(); i != e; ++i) {
 				containerSize += mtpRequestData::messageSize(i.value());
 				if (needsLayer && i.value()->needsLayer) {
@@ -1014,6 +1073,7 @@ void ConnectionPrivate::tryToSend() {
 							added = true;
 						}
 						haveSent.insert(msgId, req);
+						statsRequestSent(req->requestId);
 
 						needAnyResponse = true;
 					} else {
@@ -1034,6 +1094,10 @@ void ConnectionPrivate::tryToSend() {
 			if (resendRequest) placeToContainer(toSendRequest, bigMsgId, haveSentArr, resendRequest);
 			if (ackRequest) placeToContainer(toSendRequest, bigMsgId, haveSentArr, ackRequest);
 			if (httpWaitRequest) placeToContainer(toSendRequest, bigMsgId, haveSentArr, httpWaitRequest);
+			if (saltsRequest) {
+				_futureSaltsMsgId = placeToContainer(toSendRequest, bigMsgId, haveSentArr, saltsRequest);
+				needAnyResponse = true;
+			}
 
 			mtpMsgId contMsgId = prepareToSend(toSendRequest, bigMsgId);
 			*(mtpMsgId*)(haveSentIdsWrap->data() + 4) = contMsgId;
@@ -1097,6 +1161,7 @@ void ConnectionPrivate::socketStart(bool afterConfig) {
 	MTPDdcOption::Flags flags[2][2] = { { 0 } };
 	string ip[2][2];
 	uint32 port[2][2] = { { 0 } };
+	ShiftedDcId tcpOption[2] = { 0 };
 	{
 		QReadLocker lock(dcOptionsMutex());
 		const auto &options(Global::DcOptions());
@@ -1138,6 +1203,9 @@ void ConnectionPrivate::socketStart(bool afterConfig) {
 						ip[address][protocol] = index->ip;
 						flags[address][protocol] = index->flags;
 						port[address][protocol] = index->port;
+						if (protocol == TcpProtocol) {
+							tcpOption[address] = index.key();
+						}
 						break;
 					}
 				}
@@ -1158,32 +1226,72 @@ void ConnectionPrivate::socketStart(bool afterConfig) {
 		return;
 	}
 
-	if (afterConfig && (_conn4 || _conn6)) return;
+	if (afterConfig && !_testConnections.isEmpty()) return;
 
-	createConn(!noIPv4, !noIPv6);
+	destroyConn();
 	retryTimer.stop();
 	_waitForConnectedTimer.stop();
+	_waitForIPv4Timer.stop();
 
 	setState(ConnectingState);
 	_pingId = _pingMsgId = _pingIdToSend = _pingSendAt = 0;
+	clearFutureSaltsRequest();
 	_pingSender.stop();
 
-	if (!noIPv4) DEBUG_LOG(("MTP Info: creating IPv4 connection to %1:%2 (tcp) and %3:%4 (http)...").arg(ip[IPv4address][TcpProtocol].c_str()).arg(port[IPv4address][TcpProtocol]).arg(ip[IPv4address][HttpProtocol].c_str()).arg(port[IPv4address][HttpProtocol]));
-	if (!noIPv6) DEBUG_LOG(("MTP Info: creating IPv6 connection to [%1]:%2 (tcp) and [%3]:%4 (http)...").arg(ip[IPv6address][TcpProtocol].c_str()).arg(port[IPv6address][TcpProtocol]).arg(ip[IPv4address][HttpProtocol].c_str()).arg(port[IPv4address][HttpProtocol]));
+	// Race the best known endpoints of each address family, the first
+	// one to answer the fake req_pq is used and its handshake time is
+	// remembered, so that next time the fastest endpoint is tried first.
+	for (auto address = 0; address != 2; ++address) {
+		if (address == IPv4address ? noIPv4 : noIPv6) continue;
+
+		auto candidates = dcEndpoints(tcpOption[address]);
+		auto defaultFound = false;
+		for_const (auto &candidate, candidates) {
+			if (candidate.ip == ip[address][TcpProtocol] && uint32(candidate.port) == port[address][TcpProtocol]) {
+				defaultFound = true;
+				break;
+			}
+		}
+		if (!defaultFound) {
+			DcEndpoint endpoint;
+			endpoint.dcIdWithShift = tcpOption[address];
+			endpoint.flags = flags[address][TcpProtocol];
+			endpoint.ip = ip[address][TcpProtocol];
+			endpoint.port = port[address][TcpProtocol];
+			candidates.push_back(endpoint);
+		}
+		if (candidates.size() > MTPRaceEndpointsCount) {
+			candidates.resize(MTPRaceEndpointsCount);
+		}
+		for_const (auto &candidate, candidates) {
+			TestConnection test;
+			test.ipv6 = (address == IPv6address);
+			test.dcIdWithShift = candidate.dcIdWithShift;
+			test.ip = candidate.ip;
+			test.port = candidate.port;
+			createConn(test);
 
-	_waitForConnectedTimer.start(_waitForConnected);
-	if (auto conn = _conn4) {
-		connect(conn, SIGNAL(connected()), this, SLOT(onConnected4()));
-		connect(conn, SIGNAL(disconnected()), this, SLOT(onDisconnected4()));
-		conn->connectTcp(ip[IPv4address][TcpProtocol].c_str(), port[IPv4address][TcpProtocol], flags[IPv4address][TcpProtocol]);
-		conn->connectHttp(ip[IPv4address][HttpProtocol].c_str(), port[IPv4address][HttpProtocol], flags[IPv4address][HttpProtocol]);
+			// Options without tcpo_only flag accept http as well.
+			auto httpToCandidate = candidate.port && !(candidate.flags & MTPDdcOption::Flag::f_tcpo_only);
+			auto &httpIp = httpToCandidate ? candidate.ip : ip[address][HttpProtocol];
+			auto httpPort = httpToCandidate ? uint32(candidate.port) : port[address][HttpProtocol];
+			auto httpFlags = httpToCandidate ? candidate.flags : flags[address][HttpProtocol];
+
+			DEBUG_LOG(("MTP Info: creating %1 connection to %2:%3 (tcp) and %4:%5 (http)...").arg(test.ipv6 ? "IPv6" : "IPv4").arg(candidate.ip.c_str()).arg(candidate.port).arg(httpIp.c_str()).arg(httpPort));
+
+			auto conn = _testConnections.back().data;
+			conn->connectTcp(candidate.ip.c_str(), candidate.port, candidate.flags);
+			conn->connectHttp(httpIp.c_str(), httpPort, httpFlags);
+		}
 	}
-	if (auto conn = _conn6) {
-		connect(conn, SIGNAL(connected()), this, SLOT(onConnected6()));
-		connect(conn, SIGNAL(disconnected()), this, SLOT(onDisconnected6()));
-		conn->connectTcp(ip[IPv6address][TcpProtocol].c_str(), port[IPv6address][TcpProtocol], flags[IPv6address][TcpProtocol]);
-		conn->connectHttp(ip[IPv6address][HttpProtocol].c_str(), port[IPv6address][HttpProtocol], flags[IPv6address][HttpProtocol]);
+	firstSentAt = 0;
+	if (oldConnection) {
+		oldConnection = false;
+		DEBUG_LOG(("This connection marked as not old!"));
 	}
+	oldConnectionTimer.start(MTPConnectionOldTimeout);
+
+	_waitForConnectedTimer.start(_waitForConnected);
 }
 
 void ConnectionPrivate::restart(bool mayBeBadKey) {
@@ -1315,16 +1423,15 @@ void ConnectionPrivate::onWaitConnectedFailed() {
 }
 
 void ConnectionPrivate::onWaitIPv4Failed() {
-	_conn = _conn6;
-	destroyConn(&_conn4);
-
-	if (_conn) {
-		DEBUG_LOG(("MTP Info: can't connect through IPv4, using IPv6 connection."));
+	for (int i = 0, count = _testConnections.size(); i != count; ++i) {
+		if (_testConnections[i].ipv6 && _testConnections[i].connected) {
+			DEBUG_LOG(("MTP Info: can't connect through IPv4, using IPv6 connection."));
 
-		updateAuthKey();
-	} else {
-		restart();
+			return useConnection(i);
+		}
 	}
+	destroyConn();
+	restart();
 }
 
 void ConnectionPrivate::doDisconnect() {
@@ -1473,8 +1580,7 @@ void ConnectionPrivate::handleReceived() {
 
 		auto res = HandleResult::Success; // if no need to handle, then succeed
 		end = data + 8 + (msgLen >> 2);
-		const mtpPrime *sfrom(data + 4);
-		MTP_LOG(dc, ("Recv: ") + mtpTextSerialize(sfrom, end));
+		MTP_LOG_PACKET(dc, "Recv: ", data + 4, end);
 
 		bool needToHandle = false;
 		{
@@ -1489,9 +1595,12 @@ void ConnectionPrivate::handleReceived() {
 			sessionData->receivedIdsSet().shrink();
 		}
 
+		flushResends();
+
 		// send acks
 		uint32 toAckSize = ackRequestData.size();
 		if (toAckSize) {
+			if (!_ackRequestDataSince) _ackRequestDataSince = getms(true);
 			DEBUG_LOG(("MTP Info: will send %1 acks, ids: %2").arg(toAckSize).arg(Logs::vector(ackRequestData)));
 			emit sendAnythingAsync(MTPAckSendWaiting);
 		}
@@ -1625,6 +1734,10 @@ ConnectionPrivate::HandleResult ConnectionPrivate::handleOneReceived(const mtpPr
 		if (resendId == _pingMsgId) {
 			_pingId = 0;
 		}
+		if (resendId == _futureSaltsMsgId) {
+			// The salts request is never resent, allow sending a new one.
+			clearFutureSaltsRequest();
+		}
 		int32 errorCode = data.verror_code.v;
 		if (errorCode == 16 || errorCode == 17 || errorCode == 32 || errorCode == 33 || errorCode == 64) { // can handle
 			bool needResend = (errorCode == 16 || errorCode == 17); // bad msg_id
@@ -1709,6 +1822,10 @@ ConnectionPrivate::HandleResult ConnectionPrivate::handleOneReceived(const mtpPr
 		sessionData->setSalt(serverSalt);
 		unixtimeSet(serverTime);
 
+		// The cached future salts did not help, request them again.
+		clearServerSalts(bareDcId(dc));
+		clearFutureSaltsRequest();
+
 		if (setState(ConnectedState, ConnectingState)) { // maybe only connected
 			if (restarted) {
 				emit resendAllAsync();
@@ -1949,6 +2066,18 @@ ConnectionPrivate::HandleResult ConnectionPrivate::handleOneReceived(const mtpPr
 			sessionData->owner()->notifyLayerInited(true);
 		}
 
+		if (_futureSaltsMsgId && reqMsgId.v == _futureSaltsMsgId) {
+			if (typeId == mtpc_future_salts) {
+				const mtpPrime *saltsFrom = response.constData();
+				MTPFutureSalts salts(saltsFrom, saltsFrom + response.size());
+				handleFutureSalts(salts.c_future_salts());
+			} else {
+				LOG(("MTP Error: bad future salts response type %1 for dc %2").arg(typeId).arg(dc));
+				clearFutureSaltsRequest();
+			}
+			return HandleResult::Success;
+		}
+
 		mtpRequestId requestId = wasSent(reqMsgId.v);
 		if (requestId && requestId != mtpRequestId(0xFFFFFFFF)) {
 			QWriteLocker locker(sessionData->haveReceivedMutex());
@@ -1958,6 +2087,16 @@ ConnectionPrivate::HandleResult ConnectionPrivate::handleOneReceived(const mtpPr
 		}
 	} return HandleResult::Success;
 
+	case mtpc_future_salts: {
+		MTPFutureSalts msg(from, end);
+		const auto &data(msg.c_future_salts());
+		if (!_futureSaltsMsgId || data.vreq_msg_id.v != _futureSaltsMsgId) {
+			DEBUG_LOG(("Message Info: future salts received for unknown msg_id %1").arg(data.vreq_msg_id.v));
+			return HandleResult::Ignored;
+		}
+		handleFutureSalts(data);
+	} return HandleResult::Success;
+
 	case mtpc_new_session_created: {
 		const mtpPrime *start = from;
 		MTPNewSession msg(from, end);
@@ -2105,6 +2244,38 @@ mtpBuffer ConnectionPrivate::ungzip(const mtpPrime *from, const mtpPrime *end) c
 	return result;
 }
 
+bool ConnectionPrivate::applyCachedSalt() {
+	if (!keyId || keyId == AuthKey::RecreateKeyId) {
+		return false;
+	}
+	auto salt = serverSaltFor(bareDcId(dc), keyId, unixtime());
+	if (!salt) {
+		return false;
+	}
+	if (salt != sessionData->getSalt()) {
+		DEBUG_LOG(("MTP Info: using cached server salt %1 for dc %2").arg(salt).arg(dc));
+		sessionData->setSalt(salt);
+	}
+	return true;
+}
+
+void ConnectionPrivate::clearFutureSaltsRequest() {
+	_futureSaltsRequested = false;
+	_futureSaltsRequestedAt = 0;
+	_futureSaltsMsgId = 0;
+}
+
+void ConnectionPrivate::handleFutureSalts(const MTPDfuture_salts &data) {
+	const auto &salts(data.vsalts.c_vector().v);
+	DEBUG_LOG(("Message Info: future salts received, count: %1, server now: %2").arg(salts.size()).arg(data.vnow.v));
+
+	clearFutureSaltsRequest();
+	addServerSalts(bareDcId(dc), keyId, salts, data.vnow.v);
+	applyCachedSalt();
+
+	emit serverSaltsReceivedAsync();
+}
+
 bool ConnectionPrivate::requestsFixTimeSalt(const QVector<MTPlong> &ids, int32 serverTime, uint64 serverSalt) {
 	uint32 idsCount = ids.size();
 
@@ -2263,7 +2434,7 @@ void ConnectionPrivate::handleMsgsStates(const QVector<MTPlong> &ids, const stri
 
 void ConnectionPrivate::resend(quint64 msgId, qint64 msCanWait, bool forceContainer, bool sendMsgStateInfo) {
 	if (msgId == _pingMsgId) return;
-	emit resendAsync(msgId, msCanWait, forceContainer, sendMsgStateInfo);
+	resendMany(QVector<quint64>(1, msgId), msCanWait, forceContainer, sendMsgStateInfo);
 }
 
 void ConnectionPrivate::resendMany(QVector<quint64> msgIds, qint64 msCanWait, bool forceContainer, bool sendMsgStateInfo) {
@@ -2273,74 +2444,98 @@ void ConnectionPrivate::resendMany(QVector<quint64> msgIds, qint64 msCanWait, bo
 			--l;
 		}
 	}
-	emit resendManyAsync(msgIds, msCanWait, forceContainer, sendMsgStateInfo);
+	if (msgIds.isEmpty()) return;
+
+	for (auto &pending : _pendingResends) {
+		if (pending.msCanWait == msCanWait && pending.forceContainer == forceContainer && pending.sendMsgStateInfo == sendMsgStateInfo) {
+			pending.msgIds += msgIds;
+			return;
+		}
+	}
+	_pendingResends.push_back({ msCanWait, forceContainer, sendMsgStateInfo, msgIds });
+}
+
+void ConnectionPrivate::flushResends() {
+	auto resends = base::take(_pendingResends);
+	for_const (auto &pending, resends) {
+		if (pending.msgIds.size() == 1) {
+			emit resendAsync(pending.msgIds.front(), pending.msCanWait, pending.forceContainer, pending.sendMsgStateInfo);
+		} else {
+			emit resendManyAsync(pending.msgIds, pending.msCanWait, pending.forceContainer, pending.sendMsgStateInfo);
+		}
+	}
 }
 
-void ConnectionPrivate::onConnected4() {
+void ConnectionPrivate::onConnected() {
+	auto index = findTestConnection(static_cast<AbstractConnection*>(sender()));
+	if (index < 0) return;
+
 	_waitForConnected = MTPMinConnectDelay;
 	_waitForConnectedTimer.stop();
 
-	_waitForIPv4Timer.stop();
-
 	QReadLocker lockFinished(&sessionDataMutex);
 	if (!sessionData) return;
 
-	disconnect(_conn4, SIGNAL(connected()), this, SLOT(onConnected4()));
-	if (!_conn4->isConnected()) {
-		LOG(("Connection Error: not connected in onConnected4(), state: %1").arg(_conn4->debugState()));
+	auto &test = _testConnections[index];
+	disconnect(test.data, SIGNAL(connected()), this, SLOT(onConnected()));
+	if (!test.data->isConnected()) {
+		LOG(("Connection Error: not connected in onConnected(), state: %1").arg(test.data->debugState()));
 
 		lockFinished.unlock();
 		return restart();
 	}
 
-	_conn = _conn4;
-	destroyConn(&_conn6);
-
-	DEBUG_LOG(("MTP Info: connection through IPv4 succeed."));
+	test.connected = true;
+	if (dcEndpointConnected(test.dcIdWithShift, test.ip, test.port, getms(true) - test.startedAt)) {
+		emit endpointsRankingChangedAsync();
+	}
 
 	lockFinished.unlock();
-	updateAuthKey();
-}
-
-void ConnectionPrivate::onConnected6() {
-	_waitForConnected = MTPMinConnectDelay;
-	_waitForConnectedTimer.stop();
-
-	QReadLocker lockFinished(&sessionDataMutex);
-	if (!sessionData) return;
+	if (test.ipv6 && hasWaitingIPv4()) {
+		DEBUG_LOG(("MTP Info: connection through IPv6 succeed, waiting IPv4 for %1ms.").arg(MTPIPv4ConnectionWaitTimeout));
 
-	disconnect(_conn6, SIGNAL(connected()), this, SLOT(onConnected6()));
-	if (!_conn6->isConnected()) {
-		LOG(("Connection Error: not connected in onConnected(), state: %1").arg(_conn6->debugState()));
-
-		lockFinished.unlock();
-		return restart();
+		if (!_waitForIPv4Timer.isActive()) {
+			_waitForIPv4Timer.start(MTPIPv4ConnectionWaitTimeout);
+		}
+		return;
 	}
+	DEBUG_LOG(("MTP Info: connection through %1 to %2:%3 succeed.").arg(test.ipv6 ? "IPv6" : "IPv4").arg(test.ip.c_str()).arg(test.port));
 
-	DEBUG_LOG(("MTP Info: connection through IPv6 succeed, waiting IPv4 for %1ms.").arg(MTPIPv4ConnectionWaitTimeout));
-
-	_waitForIPv4Timer.start(MTPIPv4ConnectionWaitTimeout);
+	useConnection(index);
 }
 
-void ConnectionPrivate::onDisconnected4() {
-	if (_conn && _conn == _conn6) return; // disconnected the unused
+void ConnectionPrivate::useConnection(int index) {
+	_waitForIPv4Timer.stop();
 
-	if (_conn || !_conn6) {
-		destroyConn();
-		restart();
-	} else {
-		destroyConn(&_conn4);
+	auto chosen = _testConnections[index].data;
+	for (auto i = _testConnections.size(); i != 0;) {
+		auto conn = _testConnections[--i].data;
+		if (conn != chosen) {
+			destroyConn(conn);
+		}
+	}
+	{
+		QWriteLocker lock(&stateConnMutex);
+		_conn = chosen;
 	}
+	updateAuthKey();
 }
 
-void ConnectionPrivate::onDisconnected6() {
-	if (_conn && _conn == _conn4) return; // disconnected the unused
+void ConnectionPrivate::onDisconnected() {
+	auto conn = static_cast<AbstractConnection*>(sender());
+	auto index = findTestConnection(conn);
+	if (index < 0) return;
+	if (_conn && _conn != conn) return; // disconnected the unused
 
-	if (_conn || !_conn4) {
+	auto &test = _testConnections[index];
+	if (!test.connected && dcEndpointFailed(test.dcIdWithShift, test.ip, test.port)) {
+		emit endpointsRankingChangedAsync();
+	}
+	if (_conn || _testConnections.size() == 1) {
 		destroyConn();
 		restart();
 	} else {
-		destroyConn(&_conn6);
+		destroyConn(conn);
 	}
 }
 
@@ -2807,6 +3002,7 @@ void ConnectionPrivate::authKeyCreated() {
 
 	connect(_conn, SIGNAL(receivedData()), this, SLOT(handleReceived()));
 
+	applyCachedSalt();
 	if (sessionData->getSalt()) { // else receive salt in bad_server_salt first, then try to send all the requests
 		setState(ConnectedState);
 		if (restarted) {
@@ -2836,31 +3032,25 @@ void ConnectionPrivate::clearAuthKeyData() {
 	}
 }
 
-void ConnectionPrivate::onError4(bool mayBeBadKey) {
-	if (_conn && _conn == _conn6) return; // error in the unused
+void ConnectionPrivate::onError(bool mayBeBadKey) {
+	auto conn = static_cast<AbstractConnection*>(sender());
+	auto index = findTestConnection(conn);
+	if (index < 0) return;
+	if (_conn && _conn != conn) return; // error in the unused
 
-	if (_conn || !_conn6) {
-		destroyConn();
-		_waitForConnectedTimer.stop();
-
-		MTP_LOG(dc, ("Restarting after error in IPv4 connection, maybe bad key: %1...").arg(Logs::b(mayBeBadKey)));
-		return restart(mayBeBadKey);
-	} else {
-		destroyConn(&_conn4);
+	auto &test = _testConnections[index];
+	if (!test.connected && dcEndpointFailed(test.dcIdWithShift, test.ip, test.port)) {
+		emit endpointsRankingChangedAsync();
 	}
-}
-
-void ConnectionPrivate::onError6(bool mayBeBadKey) {
-	if (_conn && _conn == _conn4) return; // error in the unused
-
-	if (_conn || !_conn4) {
+	if (_conn || _testConnections.size() == 1) {
+		auto ipv6 = test.ipv6;
 		destroyConn();
 		_waitForConnectedTimer.stop();
 
-		MTP_LOG(dc, ("Restarting after error in IPv6 connection, maybe bad key: %1...").arg(Logs::b(mayBeBadKey)));
+		MTP_LOG(dc, ("Restarting after error in %1 connection, maybe bad key: %2...").arg(ipv6 ? "IPv6" : "IPv4").arg(Logs::b(mayBeBadKey)));
 		return restart(mayBeBadKey);
 	} else {
-		destroyConn(&_conn6);
+		destroyConn(conn);
 	}
 }
 
@@ -2967,7 +3157,7 @@ bool ConnectionPrivate::sendRequest(mtpRequest &request, bool needAnyResponse, Q
 	memcpy(request->data() + 2, &session, 2 * sizeof(mtpPrime));
 
 	const mtpPrime *from = request->constData() + 4;
-	MTP_LOG(dc, ("Send: ") + mtpTextSerialize(from, from + messageSize));
+	MTP_LOG_PACKET(dc, "Send: ", from, from + messageSize);
 
 	uchar encryptedSHA[20];
 	MTPint128 &msgKey(*(MTPint128*)(encryptedSHA + 4));
@@ -3029,7 +3219,7 @@ void ConnectionPrivate::unlockKey() {
 }
 
 ConnectionPrivate::~ConnectionPrivate() {
-	t_assert(_finished && _conn == nullptr && _conn4 == nullptr && _conn6 == nullptr);
+	t_assert(_finished && _conn == nullptr && _testConnections.isEmpty());
 }
 
 void ConnectionPrivate::stop() {
@@ -103,6 +103,8 @@ signals:
 	void resendAsync(quint64 msgId, qint64 msCanWait, bool forceContainer, bool sendMsgStateInfo);
 	void resendManyAsync(QVector<quint64> msgIds, qint64 msCanWait, bool forceContainer, bool sendMsgStateInfo);
 	void resendAllAsync();
+	void serverSaltsReceivedAsync();
+	void endpointsRankingChangedAsync();
 
 	void finished(Connection *connection);
 
@@ -126,12 +128,9 @@ public slots:
 	void onReadyData();
 	void socketStart(bool afterConfig = false);
 
-	void onConnected4();
-	void onConnected6();
-	void onDisconnected4();
-	void onDisconnected6();
-	void onError4(bool mayBeBadKey = false);
-	void onError6(bool mayBeBadKey = false);
+	void onConnected();
+	void onDisconnected();
+	void onError(bool mayBeBadKey = false);
 
 	void doFinish();
 
@@ -154,8 +153,20 @@ private:
 
 	void doDisconnect();
 
-	void createConn(bool createIPv4, bool createIPv6);
-	void destroyConn(AbstractConnection **conn = 0); // 0 - destory all
+	struct TestConnection {
+		AbstractConnection *data = nullptr;
+		bool ipv6 = false;
+		ShiftedDcId dcIdWithShift = 0; // endpoint, used for the ranking
+		std::string ip;
+		int32 port = 0;
+		TimeMs startedAt = 0;
+		bool connected = false;
+	};
+	void createConn(const TestConnection &test);
+	void destroyConn(AbstractConnection *conn = nullptr); // nullptr - destroy all
+	int findTestConnection(AbstractConnection *conn) const;
+	bool hasWaitingIPv4() const;
+	void useConnection(int index);
 
 	mtpMsgId placeToContainer(mtpRequest &toSendRequest, mtpMsgId &bigMsgId, mtpMsgId *&haveSentArr, mtpRequest &req);
 	mtpMsgId prepareToSend(mtpRequest &request, mtpMsgId currentLastId);
@@ -186,8 +197,7 @@ private:
 	ShiftedDcId dc = 0;
 	Connection *_owner = nullptr;
 	AbstractConnection *_conn = nullptr;
-	AbstractConnection *_conn4 = nullptr;
-	AbstractConnection *_conn6 = nullptr;;
+	QVector<TestConnection> _testConnections;
 
 	SingleTimer retryTimer; // exp retry timer
 	int retryTimeout = 1;
@@ -201,6 +211,7 @@ private:
 	TimeMs firstSentAt = -1;
 
 	QVector<MTPlong> ackRequestData, resendRequestData;
+	TimeMs _ackRequestDataSince = 0; // when the oldest of ackRequestData was received
 
 	// if badTime received - search for ids in sessionData->haveSent and sessionData->wereAcked and sync time/salt, return true if found
 	bool requestsFixTimeSalt(const QVector<MTPlong> &ids, int32 serverTime, uint64 serverSalt);
@@ -214,9 +225,27 @@ private:
 	mtpMsgId _pingMsgId = 0;
 	SingleTimer _pingSender;
 
+	// take the salt for current time from the future salts cache, if we have it
+	bool applyCachedSalt();
+	void handleFutureSalts(const MTPDfuture_salts &data);
+	void clearFutureSaltsRequest();
+	bool _futureSaltsRequested = false;
+	TimeMs _futureSaltsRequestedAt = 0;
+	mtpMsgId _futureSaltsMsgId = 0;
+
 	void resend(quint64 msgId, qint64 msCanWait = 0, bool forceContainer = false, bool sendMsgStateInfo = false);
 	void resendMany(QVector<quint64> msgIds, qint64 msCanWait = 0, bool forceContainer = false, bool sendMsgStateInfo = false);
 
+	// resend requests are grouped by their parameters and passed to the session once per received packet
+	struct PendingResend {
+		qint64 msCanWait;
+		bool forceContainer;
+		bool sendMsgStateInfo;
+		QVector<quint64> msgIds;
+	};
+	QVector<PendingResend> _pendingResends;
+	void flushResends();
+
 	template <typename TRequest>
 	void sendRequestNotSecure(const TRequest &request);
 
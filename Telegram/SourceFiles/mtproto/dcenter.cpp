@@ -38,6 +38,31 @@ namespace {
 	typedef QMap<int32, AuthKeyPtr> _KeysMapForWrite;
 	_KeysMapForWrite _keysMapForWrite;
 	QMutex _keysMapForWriteMutex;
+
+	ServerSaltsMap _serverSalts;
+	QMutex _serverSaltsMutex;
+
+	DcEndpoints _dcEndpoints;
+	QMutex _dcEndpointsMutex;
+
+	int32 dcEndpointScore(const DcEndpoint &endpoint) {
+		auto result = endpoint.rtt ? endpoint.rtt : int32(MTPUnknownEndpointRtt);
+		return result << qMin(endpoint.failures, 4);
+	}
+
+	// Indices of the endpoints of a dc in the order they are tried.
+	QVector<int> dcEndpointsRanking(ShiftedDcId dcIdWithShift) {
+		QVector<int> result;
+		for (auto i = 0, count = _dcEndpoints.size(); i != count; ++i) {
+			if (_dcEndpoints[i].dcIdWithShift == dcIdWithShift) {
+				result.push_back(i);
+			}
+		}
+		std::stable_sort(result.begin(), result.end(), [](int a, int b) {
+			return dcEndpointScore(_dcEndpoints[a]) < dcEndpointScore(_dcEndpoints[b]);
+		});
+		return result;
+	}
 } // namespace
 
 int32 authed() {
@@ -119,6 +144,7 @@ void Dcenter::setKey(const AuthKeyPtr &key) {
 	DEBUG_LOG(("AuthKey Info: MTProtoDC::setKey(%1), emitting authKeyCreated, dc %2").arg(key ? key->keyId() : 0).arg(_id));
 	_key = key;
 	_connectionInited = false;
+	clearServerSalts(_id);
 	emit authKeyCreated();
 
 	QMutexLocker lock(&_keysMapForWriteMutex);
@@ -156,7 +182,7 @@ void configLoaded(const MTPConfig &result) {
 
 	DEBUG_LOG(("MTP Info: got config, chat_size_max: %1, date: %2, test_mode: %3, this_dc: %4, dc_options.length: %5").arg(data.vchat_size_max.v).arg(data.vdate.v).arg(mtpIsTrue(data.vtest_mode)).arg(data.vthis_dc.v).arg(data.vdc_options.c_vector().v.size()));
 
-	updateDcOptions(data.vdc_options.c_vector().v);
+	updateDcOptions(data.vdc_options.c_vector().v, DcOptionsUpdate::ReplaceAll);
 
 	Global::SetChatSizeMax(data.vchat_size_max.v);
 	Global::SetMegagroupSizeMax(data.vmegagroup_size_max.v);
@@ -191,7 +217,9 @@ bool configFailed(const RPCError &error) {
 
 };
 
-void updateDcOptions(const QVector<MTPDcOption> &options) {
+void updateDcOptions(const QVector<MTPDcOption> &options, DcOptionsUpdate type) {
+	updateDcEndpoints(options, type);
+
 	QSet<int32> already, restart;
 	{
 		MTP::DcOptions opts;
@@ -310,5 +338,174 @@ void setAuthKey(int32 dcId, AuthKeyPtr key) {
 	gDCs.insert(dcId, dc);
 }
 
+void updateDcEndpoints(const QVector<MTPDcOption> &options, DcOptionsUpdate type) {
+	QMutexLocker lock(&_dcEndpointsMutex);
+	auto was = (type == DcOptionsUpdate::ReplaceAll) ? base::take(_dcEndpoints) : DcEndpoints();
+	auto findIn = [](const DcEndpoints &list, ShiftedDcId dcIdWithShift, const std::string &ip, int32 port) {
+		for (auto i = 0, count = list.size(); i != count; ++i) {
+			auto &endpoint = list[i];
+			if (endpoint.dcIdWithShift == dcIdWithShift && endpoint.ip == ip && endpoint.port == port) {
+				return i;
+			}
+		}
+		return -1;
+	};
+
+	_dcEndpoints.reserve(_dcEndpoints.size() + options.size());
+	for_const (auto &option, options) {
+		auto &optionData = option.c_dcOption();
+		DcEndpoint endpoint;
+		endpoint.dcIdWithShift = MTP::shiftDcId(optionData.vid.v, optionData.vflags.v);
+		endpoint.flags = optionData.vflags.v;
+		endpoint.ip = optionData.vip_address.c_string().v;
+		endpoint.port = optionData.vport.v;
+
+		// A merged option keeps its place and its measurements.
+		auto already = findIn(_dcEndpoints, endpoint.dcIdWithShift, endpoint.ip, endpoint.port);
+		if (already >= 0) {
+			_dcEndpoints[already].flags = endpoint.flags;
+			continue;
+		}
+		auto known = findIn(was, endpoint.dcIdWithShift, endpoint.ip, endpoint.port);
+		if (known >= 0) {
+			endpoint.rtt = was[known].rtt;
+			endpoint.failures = was[known].failures;
+		}
+		_dcEndpoints.push_back(endpoint);
+	}
+}
+
+DcEndpoints dcEndpoints(ShiftedDcId dcIdWithShift) {
+	DcEndpoints result;
+	{
+		QMutexLocker lock(&_dcEndpointsMutex);
+		for_const (auto &endpoint, _dcEndpoints) {
+			if (endpoint.dcIdWithShift == dcIdWithShift) {
+				result.push_back(endpoint);
+			}
+		}
+	}
+	std::stable_sort(result.begin(), result.end(), [](const DcEndpoint &a, const DcEndpoint &b) {
+		return dcEndpointScore(a) < dcEndpointScore(b);
+	});
+	return result;
+}
+
+bool dcEndpointConnected(ShiftedDcId dcIdWithShift, const std::string &ip, int32 port, int32 ms) {
+	QMutexLocker lock(&_dcEndpointsMutex);
+	auto was = dcEndpointsRanking(dcIdWithShift);
+	for (auto &endpoint : _dcEndpoints) {
+		if (endpoint.dcIdWithShift == dcIdWithShift && endpoint.ip == ip && endpoint.port == port) {
+			ms = qMax(ms, 1);
+			endpoint.rtt = endpoint.rtt ? ((endpoint.rtt * 3 + ms) / 4) : ms;
+			endpoint.failures = 0;
+			DEBUG_LOG(("MTP Info: endpoint %1:%2 of dc %3 connected in %4ms, smoothed %5ms").arg(ip.c_str()).arg(port).arg(dcIdWithShift).arg(ms).arg(endpoint.rtt));
+			return (dcEndpointsRanking(dcIdWithShift) != was);
+		}
+	}
+	return false;
+}
+
+bool dcEndpointFailed(ShiftedDcId dcIdWithShift, const std::string &ip, int32 port) {
+	QMutexLocker lock(&_dcEndpointsMutex);
+	auto was = dcEndpointsRanking(dcIdWithShift);
+	for (auto &endpoint : _dcEndpoints) {
+		if (endpoint.dcIdWithShift == dcIdWithShift && endpoint.ip == ip && endpoint.port == port) {
+			++endpoint.failures;
+			DEBUG_LOG(("MTP Info: endpoint %1:%2 of dc %3 failed, %4 failures in a row").arg(ip.c_str()).arg(port).arg(dcIdWithShift).arg(endpoint.failures));
+			return (dcEndpointsRanking(dcIdWithShift) != was);
+		}
+	}
+	return false;
+}
+
+DcEndpoints getDcEndpoints() {
+	QMutexLocker lock(&_dcEndpointsMutex);
+	return _dcEndpoints;
+}
+
+void setDcEndpoints(const DcEndpoints &endpoints) {
+	QMutexLocker lock(&_dcEndpointsMutex);
+	_dcEndpoints = endpoints;
+}
+
+void addServerSalts(int32 dcId, uint64 keyId, const QVector<MTPfutureSalt> &salts, int32 serverNow) {
+	// Server salts validity is in server time, convert it to our unixtime.
+	auto delta = unixtime() - serverNow;
+
+	QMutexLocker lock(&_serverSaltsMutex);
+	auto &data = _serverSalts[dcId];
+	if (data.keyId != keyId) {
+		data.keyId = keyId;
+		data.salts.clear();
+	}
+
+	auto now = unixtime();
+	QMap<int32, ServerSalt> sorted;
+	for_const (auto &salt, data.salts) {
+		if (salt.validUntil > now) {
+			sorted.insert(salt.validSince, salt);
+		}
+	}
+	for_const (auto &salt, salts) {
+		auto &saltData = salt.c_future_salt();
+		ServerSalt received;
+		received.validSince = saltData.vvalid_since.v + delta;
+		received.validUntil = saltData.vvalid_until.v + delta;
+		received.salt = saltData.vsalt.v;
+		if (received.validUntil > now) {
+			sorted.insert(received.validSince, received);
+		}
+	}
+	data.salts = sorted.values().toVector();
+
+	DEBUG_LOG(("MTP Info: server salts for dc %1 updated, %2 salts known, valid until %3").arg(dcId).arg(data.salts.size()).arg(data.salts.isEmpty() ? 0 : data.salts.back().validUntil));
+}
+
+uint64 serverSaltFor(int32 dcId, uint64 keyId, int32 unixtime) {
+	QMutexLocker lock(&_serverSaltsMutex);
+	auto i = _serverSalts.constFind(dcId);
+	if (i == _serverSalts.cend() || i->keyId != keyId) {
+		return 0;
+	}
+
+	// Prefer the salt that stays valid for the longest time from now.
+	uint64 result = 0;
+	for_const (auto &salt, i->salts) {
+		if (salt.validSince > unixtime) {
+			break;
+		} else if (salt.validUntil > unixtime + MTPServerSaltValidityMargin) {
+			result = salt.salt;
+		}
+	}
+	return result;
+}
+
+bool serverSaltsNeeded(int32 dcId, uint64 keyId, int32 unixtime) {
+	QMutexLocker lock(&_serverSaltsMutex);
+	auto i = _serverSalts.constFind(dcId);
+	if (i == _serverSalts.cend() || i->keyId != keyId || i->salts.isEmpty()) {
+		return true;
+	}
+	return (i->salts.back().validUntil < unixtime + MTPServerSaltsRequestBefore);
+}
+
+void clearServerSalts(int32 dcId) {
+	QMutexLocker lock(&_serverSaltsMutex);
+	_serverSalts.remove(dcId);
+}
+
+ServerSaltsMap getServerSalts() {
+	QMutexLocker lock(&_serverSaltsMutex);
+	return _serverSalts;
+}
+
+void setServerSalts(int32 dcId, uint64 keyId, const ServerSalts &salts) {
+	QMutexLocker lock(&_serverSaltsMutex);
+	auto &data = _serverSalts[dcId];
+	data.keyId = keyId;
+	data.salts = salts;
+}
+
 } // namespace internal
 } // namespace MTP
@@ -101,8 +101,56 @@ void authed(int32 uid);
 AuthKeysMap getAuthKeys();
 void setAuthKey(int32 dc, AuthKeyPtr key);
 
-void updateDcOptions(const QVector<MTPDcOption> &options);
+// The help.getConfig result has the full list of options, while an updateDcOptions
+// push has only the changed ones, they are merged into the known endpoints then.
+enum class DcOptionsUpdate {
+	Merge,
+	ReplaceAll,
+};
+void updateDcOptions(const QVector<MTPDcOption> &options, DcOptionsUpdate type = DcOptionsUpdate::Merge);
 QReadWriteLock *dcOptionsMutex();
 
+// All known connection endpoints of the dcs with the measured handshake time.
+struct DcEndpoint {
+	ShiftedDcId dcIdWithShift = 0; // bare dc id shifted by the option flags
+	MTPDdcOption::Flags flags = 0;
+	std::string ip;
+	int32 port = 0;
+	int32 rtt = 0; // smoothed handshake time in ms, 0 if never measured
+	int32 failures = 0; // failed connection attempts in a row
+};
+using DcEndpoints = QVector<DcEndpoint>;
+
+void updateDcEndpoints(const QVector<MTPDcOption> &options, DcOptionsUpdate type);
+DcEndpoints dcEndpoints(ShiftedDcId dcIdWithShift); // best first
+
+// Both return true if the order in which the dc endpoints are tried has changed.
+bool dcEndpointConnected(ShiftedDcId dcIdWithShift, const std::string &ip, int32 port, int32 ms);
+bool dcEndpointFailed(ShiftedDcId dcIdWithShift, const std::string &ip, int32 port);
+
+DcEndpoints getDcEndpoints();
+void setDcEndpoints(const DcEndpoints &endpoints);
+
+// Future server salts received by get_future_salts, kept per auth key.
+struct ServerSalt {
+	int32 validSince = 0;
+	int32 validUntil = 0;
+	uint64 salt = 0;
+};
+using ServerSalts = QVector<ServerSalt>; // sorted by validSince
+struct ServerSaltsData {
+	uint64 keyId = 0;
+	ServerSalts salts;
+};
+using ServerSaltsMap = QMap<int32, ServerSaltsData>; // bare dc id -> salts
+
+void addServerSalts(int32 dcId, uint64 keyId, const QVector<MTPfutureSalt> &salts, int32 serverNow);
+uint64 serverSaltFor(int32 dcId, uint64 keyId, int32 unixtime); // 0 if not known
+bool serverSaltsNeeded(int32 dcId, uint64 keyId, int32 unixtime);
+void clearServerSalts(int32 dcId);
+
+ServerSaltsMap getServerSalts();
+void setServerSalts(int32 dcId, uint64 keyId, const ServerSalts &salts);
+
 } // namespace internal
 } // namespace MTP
@@ -22,6 +22,8 @@ Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
 
 #include "mtproto/facade.h"
 
+#include "mtproto/packet_log.h"
+#include "mtproto/rpc_stats.h"
 #include "localstorage.h"
 
 namespace MTP {
@@ -225,6 +227,7 @@ namespace {
 			} else {
 				secs = m.captured(1).toInt();
 //				if (secs >= 60) return false;
+				internal::statsRequestFloodWait(requestId, secs);
 			}
 			auto sendAt = getms(true) + secs * 1000 + 10;
 			DelayedRequestsList::iterator i = delayedRequests.begin(), e = delayedRequests.end();
@@ -400,11 +403,13 @@ void registerRequest(mtpRequestId requestId, int32 dcWithShift) {
 		QMutexLocker locker(&requestByDCLock);
 		requestsByDC.insert(requestId, dcWithShift);
 	}
+	statsRequestRegistered(requestId, dcWithShift);
 	internal::performDelayedClear(); // need to do it somewhere...
 }
 
 void unregisterRequest(mtpRequestId requestId) {
 	requestsDelays.remove(requestId);
+	statsRequestUnregistered(requestId);
 
 	{
 		QWriteLocker locker(&requestMapLock);
@@ -418,6 +423,7 @@ void unregisterRequest(mtpRequestId requestId) {
 mtpRequestId storeRequest(mtpRequest &request, const RPCResponseHandler &parser) {
 	mtpRequestId res = reqid();
 	request->requestId = res;
+	statsRequestStored(res, request);
 	if (parser.onDone || parser.onFail) {
 		QMutexLocker locker(&parserMapLock);
 		parserMap.insert(res, parser);
@@ -560,6 +566,7 @@ void execCallback(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *
 	} else {
 		DEBUG_LOG(("RPC Info: parser not found for %1").arg(requestId));
 	}
+	statsRequestAnswered(requestId, (end - from) * sizeof(mtpPrime), (from < end) && (*from == mtpc_rpc_error));
 	unregisterRequest(requestId);
 }
 
@@ -842,6 +849,8 @@ void finish() {
 	}
 	quittingConnections.clear();
 
+	internal::finishPacketLog();
+
 	delete _globalSlotCarrier;
 	_globalSlotCarrier = nullptr;
 
@@ -899,6 +908,22 @@ void setKey(int32 dc, AuthKeyPtr key) {
 	return internal::setAuthKey(dc, key);
 }
 
+internal::DcEndpoints getDcEndpoints() {
+	return internal::getDcEndpoints();
+}
+
+void setDcEndpoints(const internal::DcEndpoints &endpoints) {
+	return internal::setDcEndpoints(endpoints);
+}
+
+internal::ServerSaltsMap getServerSalts() {
+	return internal::getServerSalts();
+}
+
+void setServerSalts(int32 dc, uint64 keyId, const internal::ServerSalts &salts) {
+	return internal::setServerSalts(dc, keyId, salts);
+}
+
 QReadWriteLock *dcOptionsMutex() {
 	return internal::dcOptionsMutex();
 }
@@ -222,6 +222,12 @@ void updateDcOptions(const QVector<MTPDcOption> &options);
 AuthKeysMap getKeys();
 void setKey(int32 dc, AuthKeyPtr key);
 
+internal::DcEndpoints getDcEndpoints();
+void setDcEndpoints(const internal::DcEndpoints &endpoints);
+
+internal::ServerSaltsMap getServerSalts();
+void setServerSalts(int32 dc, uint64 keyId, const internal::ServerSalts &salts);
+
 QReadWriteLock *dcOptionsMutex();
 
 struct DcOption {
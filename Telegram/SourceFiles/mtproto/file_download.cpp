@@ -27,6 +27,7 @@ Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
 
 #include "application.h"
 #include "localstorage.h"
+#include "core/task_queue.h"
 
 namespace {
 	int32 GlobalPriority = 1;
@@ -37,6 +38,19 @@ namespace {
 		int64 v[MTPDownloadSessionsCount];
 	};
 	QMap<int32, DataRequested> DataRequestedMap;
+
+	// Usually the image is painted in one or two sizes, like a message
+	// thumbnail and a reply preview.
+	constexpr auto kMaxImageTargetSizes = 4;
+
+	QByteArray imageFormatByType(mtpTypeId type) {
+		switch (type) {
+		case mtpc_storage_fileGif: return "GIF";
+		case mtpc_storage_fileJpeg: return "JPG";
+		case mtpc_storage_filePng: return "PNG";
+		}
+		return QByteArray();
+	}
 }
 
 struct FileLoaderQueue {
@@ -86,13 +100,7 @@ QPixmap FileLoader::imagePixmap(const QSize &shrinkBox) const {
 }
 
 void FileLoader::readImage(const QSize &shrinkBox) const {
-	QByteArray format;
-	switch (_type) {
-	case mtpc_storage_fileGif: format = "GIF"; break;
-	case mtpc_storage_fileJpeg: format = "JPG"; break;
-	case mtpc_storage_filePng: format = "PNG"; break;
-	default: format = QByteArray(); break;
-	}
+	auto format = imageFormatByType(_type);
 	QImage image = App::readImage(_data, &format, false);
 	if (!image.isNull()) {
 		if (!shrinkBox.isEmpty() && (image.width() > shrinkBox.width() || image.height() > shrinkBox.height())) {
@@ -104,6 +112,90 @@ void FileLoader::readImage(const QSize &shrinkBox) const {
 	}
 }
 
+void FileLoader::addImageTargetSize(int width, int height) {
+	if (_imageDecoding || !_imagePixmap.isNull() || width <= 0) return;
+
+	auto size = qMakePair(width, height);
+	if (_imageTargetSizes.size() < kMaxImageTargetSizes && !_imageTargetSizes.contains(size)) {
+		_imageTargetSizes.push_back(size);
+	}
+}
+
+bool FileLoader::startImageDecode() {
+	if (_locationType != UnknownFileLocation || _data.isEmpty() || !_imagePixmap.isNull()) {
+		return false;
+	}
+
+	// Decode (and shrink) the image on a worker thread, done() stays false until
+	// the pixmap is ready, so the placeholder is painted meanwhile.
+	auto format = imageFormatByType(_type);
+	_imageDecoding = true;
+	base::TaskQueue::Normal().Put([weak = QPointer<FileLoader>(this), data = _data, format, shrinkBox = _imageShrinkBox, targets = base::take(_imageTargetSizes)]() mutable {
+		auto prescaled = PrescaledImages();
+		auto fullSize = QSize();
+
+		// Skip the full size decode if all the requested sizes can be decoded right away.
+		if (shrinkBox.isEmpty() && !targets.isEmpty()) {
+			auto size = Images::readSize(data, format);
+			for_const (auto &target, targets) {
+				auto scaled = Images::readScaled(data, format, size.width(), size.height(), target.first, target.second);
+				if (scaled.isNull()) {
+					prescaled.clear();
+					break;
+				}
+				prescaled.insert(target, std_::move(scaled));
+			}
+			if (!prescaled.isEmpty()) {
+				fullSize = size;
+			}
+		}
+
+		auto image = QImage();
+		if (fullSize.isEmpty()) {
+			image = App::readImage(data, &format, false);
+			if (!image.isNull() && !shrinkBox.isEmpty() && (image.width() > shrinkBox.width() || image.height() > shrinkBox.height())) {
+				image = image.scaled(shrinkBox, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+			}
+
+			// Same scaling as Images::prepare() does for the Smooth option.
+			if (!image.isNull()) {
+				for_const (auto &target, targets) {
+					auto w = target.first, h = target.second;
+					if (w >= image.width() && (h <= 0 || h >= image.height())) {
+						continue;
+					}
+					prescaled.insert(target, (h <= 0)
+						? image.scaledToWidth(w, Qt::SmoothTransformation)
+						: image.scaled(w, h, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+				}
+			}
+		}
+		base::TaskQueue::Main().Put([weak, image, format, prescaled, fullSize]() mutable {
+			if (weak) {
+				weak->imageDecoded(std_::move(image), format, std_::move(prescaled), fullSize);
+			}
+		});
+	});
+	return true;
+}
+
+void FileLoader::imageDecoded(QImage &&image, const QByteArray &format, PrescaledImages &&prescaled, const QSize &fullSize) {
+	if (!_imageDecoding) return; // cancelled while decoding
+
+	_imageDecoding = false;
+	if (!image.isNull()) {
+		_imagePixmap = App::pixmapFromImageInPlace(std_::move(image));
+		_imageFormat = format;
+		_imagePrescaled = std_::move(prescaled);
+	} else if (!fullSize.isEmpty()) {
+		_imageFormat = format;
+		_imageFullSize = fullSize;
+		_imagePrescaled = std_::move(prescaled);
+	}
+	emit progress(this);
+	FileDownload::ImageLoaded().notify();
+}
+
 float64 FileLoader::currentProgress() const {
 	if (_complete) return 1.;
 	if (!fullSize()) return 0.;
@@ -320,6 +412,7 @@ void FileLoader::cancel(bool fail) {
 	cancelRequests();
 	_type = mtpc_storage_fileUnknown;
 	_complete = true;
+	_imageDecoding = false;
 	if (_fileIsOpen) {
 		_file.close();
 		_fileIsOpen = false;
@@ -532,6 +625,9 @@ void mtpFileLoader::partLoaded(int32 offset, const MTPupload_File &result, mtpRe
 	} else {
 		if (DebugLogging::FileLoader() && _id) DEBUG_LOG(("FileLoader(%1): not done yet, _lastComplete=%2, _size=%3, _nextRequestOffset=%4, _requests=%5").arg(_id).arg(Logs::b(_lastComplete)).arg(_size).arg(_nextRequestOffset).arg(serializereqs(_requests)));
 	}
+	if (_complete && startImageDecode()) {
+		return loadNext();
+	}
 	emit progress(this);
 	if (_complete) {
 		FileDownload::ImageLoaded().notify();
@@ -663,6 +759,9 @@ void webFileLoader::onFinished(const QByteArray &data) {
 	if (_localStatus == LocalNotFound || _localStatus == LocalFailed) {
 		Local::writeWebFile(_url, _data);
 	}
+	if (startImageDecode()) {
+		return loadNext();
+	}
 	emit progress(this);
 	FileDownload::ImageLoaded().notify();
 	loadNext();
@@ -116,7 +116,7 @@ public:
 
 	FileLoader(const QString &toFile, int32 size, LocationType locationType, LoadToCacheSetting, LoadFromCloudSetting fromCloud, bool autoLoading);
 	bool done() const {
-		return _complete;
+		return _complete && !_imageDecoding;
 	}
 	mtpTypeId fileType() const {
 		return _type;
@@ -126,6 +126,26 @@ public:
 	}
 	QByteArray imageFormat(const QSize &shrinkBox = QSize()) const;
 	QPixmap imagePixmap(const QSize &shrinkBox = QSize()) const;
+	void setImageShrinkBox(const QSize &shrinkBox) {
+		_imageShrinkBox = shrinkBox;
+	}
+
+	// Sizes the image was requested to be painted in while loading, the decode
+	// task prepares the smoothly scaled variants for them right away.
+	using PrescaledImages = QMap<QPair<int, int>, QImage>;
+	void addImageTargetSize(int width, int height);
+	PrescaledImages takeImagePrescaled() {
+		return base::take(_imagePrescaled);
+	}
+
+	// A large JPEG that was requested only in much smaller sizes is decoded right
+	// into them, bytes() are left for the full size decode then.
+	bool imagePrescaledOnly() const {
+		return !_imageFullSize.isEmpty();
+	}
+	QSize imageFullSize() const {
+		return _imageFullSize;
+	}
 	QString fileName() const {
 		return _fname;
 	}
@@ -181,6 +201,8 @@ signals:
 
 protected:
 	void readImage(const QSize &shrinkBox) const;
+	bool startImageDecode();
+	void imageDecoded(QImage &&image, const QByteArray &format, PrescaledImages &&prescaled, const QSize &fullSize);
 
 	FileLoader *_prev = nullptr;
 	FileLoader *_next = nullptr;
@@ -219,6 +241,11 @@ protected:
 	TaskId _localTaskId = 0;
 	mutable QByteArray _imageFormat;
 	mutable QPixmap _imagePixmap;
+	QSize _imageShrinkBox;
+	QVector<QPair<int, int>> _imageTargetSizes;
+	PrescaledImages _imagePrescaled;
+	QSize _imageFullSize; // not empty if only the prescaled variants were decoded
+	bool _imageDecoding = false;
 
 };
 
@@ -64,6 +64,7 @@ creatorProxyText = '';
 inlineMethods = '';
 textSerializeInit = '';
 textSerializeMethods = '';
+typeNames = '';
 forwards = '';
 forwTypedefs = '';
 out = open('scheme_auto.h', 'w')
@@ -536,10 +537,22 @@ def addTextSerializeInit(lst, dct):
       result += '\t\t_serializers.insert(mtpc_' + name + ', _serialize_' + name + ');\n';
   return result;
 
+# type names for the logs and stats
+def addTypeNames(lst, dct):
+  result = '';
+  for restype in lst:
+    v = dct[restype];
+    for data in v:
+      name = data[0];
+      result += '\tcase mtpc_' + name + ': return "' + name + '";\n';
+  return result;
+
 textSerializeMethods += addTextSerialize(typesList, typesDict, 'D');
 textSerializeInit += addTextSerializeInit(typesList, typesDict) + '\n';
 textSerializeMethods += addTextSerialize(funcsList, funcsDict, '');
 textSerializeInit += addTextSerializeInit(funcsList, funcsDict) + '\n';
+typeNames += addTypeNames(typesList, typesDict);
+typeNames += addTypeNames(funcsList, funcsDict);
 
 for restype in typesList:
   v = typesDict[restype];
@@ -955,6 +968,7 @@ out.write('\n// RPC methods\n' + funcsText);
 out.write('\n// Creator proxy class definition\nnamespace MTP {\nnamespace internal {\n\nclass TypeCreator {\npublic:\n' + creatorProxyText + '\t};\n\n} // namespace internal\n} // namespace MTP\n');
 out.write('\n// Inline methods definition\n' + inlineMethods);
 out.write('\n// Human-readable text serialization\nvoid mtpTextSerializeType(MTPStringLogger &to, const mtpPrime *&from, const mtpPrime *end, mtpPrime cons, uint32 level, mtpPrime vcons);\n');
+out.write('\n// Constructor or method name by its type id, nullptr for unknown ids\nconst char *mtpTypeName(mtpTypeId type);\n');
 
 outCpp = open('scheme_auto.cpp', 'w');
 outCpp.write('/*\n');
@@ -986,5 +1000,6 @@ outCpp.write('\tvoid initTextSerializers() {\n');
 outCpp.write(textSerializeInit);
 outCpp.write('\t}\n}\n');
 outCpp.write(textSerializeFull + '\n');
+outCpp.write('\nconst char *mtpTypeName(mtpTypeId type) {\n\tswitch (type) {\n' + typeNames + '\t}\n\treturn nullptr;\n}\n');
 
 print('Done, written {0} constructors, {1} functions.'.format(consts, funcs));
@@ -0,0 +1,96 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
+*/
+#include "stdafx.h"
+
+#include "mtproto/packet_log.h"
+#include "core/task_queue.h"
+
+namespace MTP {
+namespace internal {
+namespace {
+
+QMutex PendingMutex;
+QWaitCondition PendingFinished;
+int PendingCount = 0;
+int PendingBytes = 0;
+int DroppedCount = 0;
+
+base::TaskQueue &PacketLogQueue() {
+	static base::TaskQueue Queue { base::TaskQueue::Priority::Background };
+	return Queue;
+}
+
+void packetWritten(int bytes) {
+	QMutexLocker lock(&PendingMutex);
+	--PendingCount;
+	PendingBytes -= bytes;
+	if (!PendingCount) {
+		PendingFinished.wakeAll();
+	}
+}
+
+} // namespace
+
+void logPacket(int32 dc, const char *prefix, const mtpPrime *from, const mtpPrime *end) {
+	if (end <= from) return;
+
+	auto size = int(end - from);
+	auto bytes = size * int(sizeof(mtpPrime));
+	auto dropped = 0;
+	{
+		QMutexLocker lock(&PendingMutex);
+		if (PendingCount >= MTPPacketLogQueueCount || PendingBytes + bytes > MTPPacketLogQueueBytes) {
+			++DroppedCount;
+			return;
+		}
+		++PendingCount;
+		PendingBytes += bytes;
+		dropped = base::take(DroppedCount);
+	}
+
+	auto packet = QVector<mtpPrime>(size);
+	memcpy(packet.data(), from, bytes);
+	auto queued = getms(true);
+	PacketLogQueue().Put([dc, prefix, packet, bytes, dropped, queued] {
+		if (dropped) {
+			Logs::writeMtp(dc, QString("Log Info: %1 packets were not logged, too many were waiting to be serialized.").arg(dropped));
+		}
+		auto delay = getms(true) - queued;
+		auto start = packet.constData();
+		auto text = mtpTextSerialize(start, start + packet.size());
+		if (delay > 0) {
+			Logs::writeMtp(dc, QString("%1(%2 ms ago) %3").arg(prefix).arg(delay).arg(text));
+		} else {
+			Logs::writeMtp(dc, prefix + text);
+		}
+		packetWritten(bytes);
+	});
+}
+
+void finishPacketLog() {
+	QMutexLocker lock(&PendingMutex);
+	while (PendingCount > 0) {
+		PendingFinished.wait(&PendingMutex);
+	}
+}
+
+} // namespace internal
+} // namespace MTP
@@ -0,0 +1,37 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
+*/
+#pragma once
+
+namespace MTP {
+namespace internal {
+
+// Copies the packet and serializes it to the mtp log on a background queue.
+// While too many packets wait there the new ones are dropped and counted.
+// The prefix must be a string literal, it is used after the call returns.
+void logPacket(int32 dc, const char *prefix, const mtpPrime *from, const mtpPrime *end);
+
+// Waits till the queued packets are written.
+void finishPacketLog();
+
+} // namespace internal
+} // namespace MTP
+
+#define MTP_LOG_PACKET(dc, prefix, from, end) { if (cDebug() || !Logs::started()) MTP::internal::logPacket(dc, prefix, from, end); }
@@ -0,0 +1,296 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
+*/
+#include "stdafx.h"
+
+#include "mtproto/rpc_stats.h"
+
+namespace MTP {
+namespace {
+
+constexpr auto kBucketsCount = 16;
+
+// Bucket i holds values in [2^(i-1), 2^i), the last one holds everything larger.
+int bucketIndex(int64 value) {
+	auto result = 0;
+	while (value > 0 && result + 1 < kBucketsCount) {
+		value >>= 1;
+		++result;
+	}
+	return result;
+}
+
+struct Histogram {
+	void add(int64 value) {
+		++buckets[bucketIndex(value)];
+		++count;
+		total += value;
+		if (value > maximum) maximum = value;
+	}
+
+	int64 buckets[kBucketsCount] = { 0 };
+	int64 count = 0;
+	int64 total = 0;
+	int64 maximum = 0;
+};
+
+struct MethodStats {
+	int64 count = 0;
+	int64 errors = 0;
+	int64 retries = 0;
+	int64 floodWaits = 0;
+	int64 floodWaitSeconds = 0;
+	Histogram latency; // ms
+	Histogram size; // bytes
+};
+
+struct PendingRequest {
+	mtpTypeId method = 0;
+	DcId dcId = 0;
+	TimeMs sentAt = 0; // first time the request was written to a connection
+	int32 retries = 0;
+	int32 floodWaits = 0;
+	int32 floodWaitSeconds = 0;
+};
+
+struct PacketStats {
+	int64 ackOnly = 0;
+	int64 payload = 0;
+	int64 acks = 0;
+};
+
+using StatsKey = QPair<DcId, mtpTypeId>;
+QMap<StatsKey, MethodStats> Stats;
+QMap<DcId, PacketStats> Packets;
+QMap<mtpRequestId, PendingRequest> Pending;
+TimeMs StatsStartedAt = 0;
+QMutex StatsMutex;
+
+QString methodName(mtpTypeId method) {
+	if (auto name = mtpTypeName(method)) {
+		return QString::fromLatin1(name);
+	}
+	return qsl("0x%1").arg(uint32(method), 8, 16, QChar('0'));
+}
+
+// The method of a request, skipping the invokeAfterMsg(s) wrappers of dependent requests.
+mtpTypeId requestMethod(const mtpRequest &request) {
+	auto from = request->constData() + 8, end = request->constData() + request->size();
+	while (from < end) {
+		switch (*from) {
+		case mtpc_invokeAfterMsg: from += 3; break; // cons + msg_id
+		case mtpc_invokeAfterMsgs: {
+			if (from + 3 > end) return 0;
+			from += 3 + 2 * from[2]; // cons + vector cons + count + msg_ids
+		} break;
+		default: return *from;
+		}
+	}
+	return 0;
+}
+
+QJsonObject histogramToJson(const Histogram &histogram, int64 count) {
+	QJsonArray buckets;
+	for (auto i = 0; i != kBucketsCount; ++i) {
+		buckets.append(double(histogram.buckets[i]));
+	}
+	QJsonObject result;
+	result.insert(qsl("buckets"), buckets);
+	result.insert(qsl("average"), count ? double(histogram.total) / count : 0.);
+	result.insert(qsl("max"), double(histogram.maximum));
+	return result;
+}
+
+int64 histogramPercentile(const Histogram &histogram, int64 count, int percent) {
+	auto needed = (count * percent + 99) / 100, accumulated = 0LL;
+	for (auto i = 0; i != kBucketsCount; ++i) {
+		accumulated += histogram.buckets[i];
+		if (accumulated >= needed) {
+			return (i + 1 < kBucketsCount) ? (1LL << i) : histogram.maximum;
+		}
+	}
+	return histogram.maximum;
+}
+
+} // namespace
+
+namespace internal {
+
+void statsRequestStored(mtpRequestId requestId, const mtpRequest &request) {
+	auto method = requestMethod(request);
+	if (!method) return;
+
+	QMutexLocker lock(&StatsMutex);
+	if (!StatsStartedAt) StatsStartedAt = getms(true);
+
+	Pending[requestId].method = method;
+}
+
+void statsRequestRegistered(mtpRequestId requestId, int32 dcWithShift) {
+	QMutexLocker lock(&StatsMutex);
+	auto i = Pending.find(requestId);
+	if (i != Pending.end()) {
+		i->dcId = bareDcId(qAbs(dcWithShift));
+	}
+}
+
+void statsRequestSent(mtpRequestId requestId) {
+	QMutexLocker lock(&StatsMutex);
+	auto i = Pending.find(requestId);
+	if (i != Pending.end() && !i->sentAt) {
+		i->sentAt = getms(true);
+	}
+}
+
+void statsRequestResent(mtpRequestId requestId) {
+	QMutexLocker lock(&StatsMutex);
+	auto i = Pending.find(requestId);
+	if (i != Pending.end()) {
+		++i->retries;
+	}
+}
+
+void statsRequestFloodWait(mtpRequestId requestId, int32 seconds) {
+	QMutexLocker lock(&StatsMutex);
+	auto i = Pending.find(requestId);
+	if (i != Pending.end()) {
+		++i->floodWaits;
+		i->floodWaitSeconds += seconds;
+	}
+}
+
+void statsRequestAnswered(mtpRequestId requestId, int32 bytes, bool error) {
+	QMutexLocker lock(&StatsMutex);
+	auto i = Pending.find(requestId);
+	if (i == Pending.end()) {
+		return;
+	}
+	auto &stats = Stats[qMakePair(i->dcId, i->method)];
+	++stats.count;
+	if (error) ++stats.errors;
+	stats.retries += i->retries;
+	stats.floodWaits += i->floodWaits;
+	stats.floodWaitSeconds += i->floodWaitSeconds;
+	if (i->sentAt) {
+		stats.latency.add(getms(true) - i->sentAt);
+	}
+	stats.size.add(bytes);
+	Pending.erase(i);
+}
+
+void statsRequestUnregistered(mtpRequestId requestId) {
+	QMutexLocker lock(&StatsMutex);
+	Pending.remove(requestId);
+}
+
+void statsPacketSent(int32 dcWithShift, bool ackOnly, int32 acksCount) {
+	QMutexLocker lock(&StatsMutex);
+	if (!StatsStartedAt) StatsStartedAt = getms(true);
+
+	auto &packets = Packets[bareDcId(qAbs(dcWithShift))];
+	if (ackOnly) {
+		++packets.ackOnly;
+	} else {
+		++packets.payload;
+	}
+	packets.acks += acksCount;
+}
+
+} // namespace internal
+
+void logRpcStats() {
+	QMutexLocker lock(&StatsMutex);
+	LOG(("RPC Stats: %1 methods for %2 seconds, %3 requests pending").arg(Stats.size()).arg(StatsStartedAt ? (getms(true) - StatsStartedAt) / 1000 : 0).arg(Pending.size()));
+	for (auto i = Stats.cbegin(), e = Stats.cend(); i != e; ++i) {
+		auto &stats = i.value();
+		auto count = qMax(stats.count, 1LL);
+		auto latencyCount = qMax(stats.latency.count, 1LL);
+		LOG(("RPC Stats: dc %1 %2 - count %3, errors %4, retries %5, flood waits %6 (%7 s), latency avg %8 ms, p50 %9 ms, p90 %10 ms, max %11 ms, size avg %12, max %13"
+			).arg(i.key().first
+			).arg(methodName(i.key().second)
+			).arg(stats.count
+			).arg(stats.errors
+			).arg(stats.retries
+			).arg(stats.floodWaits
+			).arg(stats.floodWaitSeconds
+			).arg(stats.latency.total / latencyCount
+			).arg(histogramPercentile(stats.latency, stats.latency.count, 50)
+			).arg(histogramPercentile(stats.latency, stats.latency.count, 90)
+			).arg(stats.latency.maximum
+			).arg(stats.size.total / count
+			).arg(stats.size.maximum));
+	}
+	for (auto i = Packets.cbegin(), e = Packets.cend(); i != e; ++i) {
+		LOG(("RPC Stats: dc %1 packets - ack only %2, with payload %3, acks sent %4").arg(i.key()).arg(i->ackOnly).arg(i->payload).arg(i->acks));
+	}
+}
+
+QString writeRpcStats() {
+	QJsonArray methods, packets;
+	{
+		QMutexLocker lock(&StatsMutex);
+		for (auto i = Stats.cbegin(), e = Stats.cend(); i != e; ++i) {
+			auto &stats = i.value();
+			QJsonObject method;
+			method.insert(qsl("dc"), i.key().first);
+			method.insert(qsl("method"), methodName(i.key().second));
+			method.insert(qsl("count"), double(stats.count));
+			method.insert(qsl("errors"), double(stats.errors));
+			method.insert(qsl("retries"), double(stats.retries));
+			method.insert(qsl("flood_waits"), double(stats.floodWaits));
+			method.insert(qsl("flood_wait_seconds"), double(stats.floodWaitSeconds));
+			method.insert(qsl("latency_ms"), histogramToJson(stats.latency, stats.latency.count));
+			method.insert(qsl("size_bytes"), histogramToJson(stats.size, stats.count));
+			methods.append(method);
+		}
+		for (auto i = Packets.cbegin(), e = Packets.cend(); i != e; ++i) {
+			QJsonObject dc;
+			dc.insert(qsl("dc"), i.key());
+			dc.insert(qsl("ack_only"), double(i->ackOnly));
+			dc.insert(qsl("payload"), double(i->payload));
+			dc.insert(qsl("acks"), double(i->acks));
+			packets.append(dc);
+		}
+	}
+	QJsonObject result;
+	result.insert(qsl("buckets"), qsl("bucket i counts values in [2^(i-1), 2^i)"));
+	result.insert(qsl("methods"), methods);
+	result.insert(qsl("packets"), packets);
+
+	QDir().mkpath(cWorkingDir() + qstr("DebugLogs"));
+	auto path = cWorkingDir() + qsl("DebugLogs/rpc_stats_%1.json").arg(QDateTime::currentDateTime().toString(qsl("yyyyMMdd_HHmmss")));
+	QFile f(path);
+	if (!f.open(QIODevice::WriteOnly)) {
+		LOG(("RPC Stats Error: could not open '%1' for writing").arg(path));
+		return QString();
+	}
+	f.write(QJsonDocument(result).toJson());
+	LOG(("RPC Stats: written to '%1'").arg(path));
+	return path;
+}
+
+void clearRpcStats() {
+	QMutexLocker lock(&StatsMutex);
+	Stats.clear();
+	Packets.clear();
+	StatsStartedAt = getms(true);
+}
+
+} // namespace MTP
@@ -0,0 +1,45 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
+*/
+#pragma once
+
+namespace MTP {
+namespace internal {
+
+// Per method and per dc statistics of the rpc requests:
+// latency, response size, retries and flood waits.
+void statsRequestStored(mtpRequestId requestId, const mtpRequest &request);
+void statsRequestRegistered(mtpRequestId requestId, int32 dcWithShift);
+void statsRequestSent(mtpRequestId requestId); // latency is counted from the first send
+void statsRequestResent(mtpRequestId requestId);
+void statsRequestFloodWait(mtpRequestId requestId, int32 seconds);
+void statsRequestAnswered(mtpRequestId requestId, int32 bytes, bool error);
+void statsRequestUnregistered(mtpRequestId requestId);
+
+// Sent packets count: the ones with only msgs_ack inside and all the others.
+void statsPacketSent(int32 dcWithShift, bool ackOnly, int32 acksCount);
+
+} // namespace internal
+
+void logRpcStats();
+QString writeRpcStats(); // returns the written json file path or an empty string
+void clearRpcStats();
+
+} // namespace MTP
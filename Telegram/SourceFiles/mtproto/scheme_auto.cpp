@@ -10576,3 +10576,753 @@ void mtpTextSerializeType(MTPStringLogger &to, const mtpPrime *&from, const mtpP
 	}
 }
 
+
+const char *mtpTypeName(mtpTypeId type) {
+	switch (type) {
+	case mtpc_resPQ: return "resPQ";
+	case mtpc_p_q_inner_data: return "p_q_inner_data";
+	case mtpc_server_DH_params_fail: return "server_DH_params_fail";
+	case mtpc_server_DH_params_ok: return "server_DH_params_ok";
+	case mtpc_server_DH_inner_data: return "server_DH_inner_data";
+	case mtpc_client_DH_inner_data: return "client_DH_inner_data";
+	case mtpc_dh_gen_ok: return "dh_gen_ok";
+	case mtpc_dh_gen_retry: return "dh_gen_retry";
+	case mtpc_dh_gen_fail: return "dh_gen_fail";
+	case mtpc_msgs_ack: return "msgs_ack";
+	case mtpc_bad_msg_notification: return "bad_msg_notification";
+	case mtpc_bad_server_salt: return "bad_server_salt";
+	case mtpc_msgs_state_req: return "msgs_state_req";
+	case mtpc_msgs_state_info: return "msgs_state_info";
+	case mtpc_msgs_all_info: return "msgs_all_info";
+	case mtpc_msg_detailed_info: return "msg_detailed_info";
+	case mtpc_msg_new_detailed_info: return "msg_new_detailed_info";
+	case mtpc_msg_resend_req: return "msg_resend_req";
+	case mtpc_rpc_error: return "rpc_error";
+	case mtpc_rpc_answer_unknown: return "rpc_answer_unknown";
+	case mtpc_rpc_answer_dropped_running: return "rpc_answer_dropped_running";
+	case mtpc_rpc_answer_dropped: return "rpc_answer_dropped";
+	case mtpc_future_salt: return "future_salt";
+	case mtpc_future_salts: return "future_salts";
+	case mtpc_pong: return "pong";
+	case mtpc_destroy_session_ok: return "destroy_session_ok";
+	case mtpc_destroy_session_none: return "destroy_session_none";
+	case mtpc_new_session_created: return "new_session_created";
+	case mtpc_http_wait: return "http_wait";
+	case mtpc_boolFalse: return "boolFalse";
+	case mtpc_boolTrue: return "boolTrue";
+	case mtpc_true: return "true";
+	case mtpc_error: return "error";
+	case mtpc_null: return "null";
+	case mtpc_inputPeerEmpty: return "inputPeerEmpty";
+	case mtpc_inputPeerSelf: return "inputPeerSelf";
+	case mtpc_inputPeerChat: return "inputPeerChat";
+	case mtpc_inputPeerUser: return "inputPeerUser";
+	case mtpc_inputPeerChannel: return "inputPeerChannel";
+	case mtpc_inputUserEmpty: return "inputUserEmpty";
+	case mtpc_inputUserSelf: return "inputUserSelf";
+	case mtpc_inputUser: return "inputUser";
+	case mtpc_inputPhoneContact: return "inputPhoneContact";
+	case mtpc_inputFile: return "inputFile";
+	case mtpc_inputFileBig: return "inputFileBig";
+	case mtpc_inputMediaEmpty: return "inputMediaEmpty";
+	case mtpc_inputMediaUploadedPhoto: return "inputMediaUploadedPhoto";
+	case mtpc_inputMediaPhoto: return "inputMediaPhoto";
+	case mtpc_inputMediaGeoPoint: return "inputMediaGeoPoint";
+	case mtpc_inputMediaContact: return "inputMediaContact";
+	case mtpc_inputMediaUploadedDocument: return "inputMediaUploadedDocument";
+	case mtpc_inputMediaUploadedThumbDocument: return "inputMediaUploadedThumbDocument";
+	case mtpc_inputMediaDocument: return "inputMediaDocument";
+	case mtpc_inputMediaVenue: return "inputMediaVenue";
+	case mtpc_inputMediaGifExternal: return "inputMediaGifExternal";
+	case mtpc_inputMediaPhotoExternal: return "inputMediaPhotoExternal";
+	case mtpc_inputMediaDocumentExternal: return "inputMediaDocumentExternal";
+	case mtpc_inputMediaGame: return "inputMediaGame";
+	case mtpc_inputChatPhotoEmpty: return "inputChatPhotoEmpty";
+	case mtpc_inputChatUploadedPhoto: return "inputChatUploadedPhoto";
+	case mtpc_inputChatPhoto: return "inputChatPhoto";
+	case mtpc_inputGeoPointEmpty: return "inputGeoPointEmpty";
+	case mtpc_inputGeoPoint: return "inputGeoPoint";
+	case mtpc_inputPhotoEmpty: return "inputPhotoEmpty";
+	case mtpc_inputPhoto: return "inputPhoto";
+	case mtpc_inputFileLocation: return "inputFileLocation";
+	case mtpc_inputEncryptedFileLocation: return "inputEncryptedFileLocation";
+	case mtpc_inputDocumentFileLocation: return "inputDocumentFileLocation";
+	case mtpc_inputAppEvent: return "inputAppEvent";
+	case mtpc_peerUser: return "peerUser";
+	case mtpc_peerChat: return "peerChat";
+	case mtpc_peerChannel: return "peerChannel";
+	case mtpc_storage_fileUnknown: return "storage_fileUnknown";
+	case mtpc_storage_fileJpeg: return "storage_fileJpeg";
+	case mtpc_storage_fileGif: return "storage_fileGif";
+	case mtpc_storage_filePng: return "storage_filePng";
+	case mtpc_storage_filePdf: return "storage_filePdf";
+	case mtpc_storage_fileMp3: return "storage_fileMp3";
+	case mtpc_storage_fileMov: return "storage_fileMov";
+	case mtpc_storage_filePartial: return "storage_filePartial";
+	case mtpc_storage_fileMp4: return "storage_fileMp4";
+	case mtpc_storage_fileWebp: return "storage_fileWebp";
+	case mtpc_fileLocationUnavailable: return "fileLocationUnavailable";
+	case mtpc_fileLocation: return "fileLocation";
+	case mtpc_userEmpty: return "userEmpty";
+	case mtpc_user: return "user";
+	case mtpc_userProfilePhotoEmpty: return "userProfilePhotoEmpty";
+	case mtpc_userProfilePhoto: return "userProfilePhoto";
+	case mtpc_userStatusEmpty: return "userStatusEmpty";
+	case mtpc_userStatusOnline: return "userStatusOnline";
+	case mtpc_userStatusOffline: return "userStatusOffline";
+	case mtpc_userStatusRecently: return "userStatusRecently";
+	case mtpc_userStatusLastWeek: return "userStatusLastWeek";
+	case mtpc_userStatusLastMonth: return "userStatusLastMonth";
+	case mtpc_chatEmpty: return "chatEmpty";
+	case mtpc_chat: return "chat";
+	case mtpc_chatForbidden: return "chatForbidden";
+	case mtpc_channel: return "channel";
+	case mtpc_channelForbidden: return "channelForbidden";
+	case mtpc_chatFull: return "chatFull";
+	case mtpc_channelFull: return "channelFull";
+	case mtpc_chatParticipant: return "chatParticipant";
+	case mtpc_chatParticipantCreator: return "chatParticipantCreator";
+	case mtpc_chatParticipantAdmin: return "chatParticipantAdmin";
+	case mtpc_chatParticipantsForbidden: return "chatParticipantsForbidden";
+	case mtpc_chatParticipants: return "chatParticipants";
+	case mtpc_chatPhotoEmpty: return "chatPhotoEmpty";
+	case mtpc_chatPhoto: return "chatPhoto";
+	case mtpc_messageEmpty: return "messageEmpty";
+	case mtpc_message: return "message";
+	case mtpc_messageService: return "messageService";
+	case mtpc_messageMediaEmpty: return "messageMediaEmpty";
+	case mtpc_messageMediaPhoto: return "messageMediaPhoto";
+	case mtpc_messageMediaGeo: return "messageMediaGeo";
+	case mtpc_messageMediaContact: return "messageMediaContact";
+	case mtpc_messageMediaUnsupported: return "messageMediaUnsupported";
+	case mtpc_messageMediaDocument: return "messageMediaDocument";
+	case mtpc_messageMediaWebPage: return "messageMediaWebPage";
+	case mtpc_messageMediaVenue: return "messageMediaVenue";
+	case mtpc_messageMediaGame: return "messageMediaGame";
+	case mtpc_messageActionEmpty: return "messageActionEmpty";
+	case mtpc_messageActionChatCreate: return "messageActionChatCreate";
+	case mtpc_messageActionChatEditTitle: return "messageActionChatEditTitle";
+	case mtpc_messageActionChatEditPhoto: return "messageActionChatEditPhoto";
+	case mtpc_messageActionChatDeletePhoto: return "messageActionChatDeletePhoto";
+	case mtpc_messageActionChatAddUser: return "messageActionChatAddUser";
+	case mtpc_messageActionChatDeleteUser: return "messageActionChatDeleteUser";
+	case mtpc_messageActionChatJoinedByLink: return "messageActionChatJoinedByLink";
+	case mtpc_messageActionChannelCreate: return "messageActionChannelCreate";
+	case mtpc_messageActionChatMigrateTo: return "messageActionChatMigrateTo";
+	case mtpc_messageActionChannelMigrateFrom: return "messageActionChannelMigrateFrom";
+	case mtpc_messageActionPinMessage: return "messageActionPinMessage";
+	case mtpc_messageActionHistoryClear: return "messageActionHistoryClear";
+	case mtpc_messageActionGameScore: return "messageActionGameScore";
+	case mtpc_messageActionPhoneCall: return "messageActionPhoneCall";
+	case mtpc_dialog: return "dialog";
+	case mtpc_photoEmpty: return "photoEmpty";
+	case mtpc_photo: return "photo";
+	case mtpc_photoSizeEmpty: return "photoSizeEmpty";
+	case mtpc_photoSize: return "photoSize";
+	case mtpc_photoCachedSize: return "photoCachedSize";
+	case mtpc_geoPointEmpty: return "geoPointEmpty";
+	case mtpc_geoPoint: return "geoPoint";
+	case mtpc_auth_checkedPhone: return "auth_checkedPhone";
+	case mtpc_auth_sentCode: return "auth_sentCode";
+	case mtpc_auth_authorization: return "auth_authorization";
+	case mtpc_auth_exportedAuthorization: return "auth_exportedAuthorization";
+	case mtpc_inputNotifyPeer: return "inputNotifyPeer";
+	case mtpc_inputNotifyUsers: return "inputNotifyUsers";
+	case mtpc_inputNotifyChats: return "inputNotifyChats";
+	case mtpc_inputNotifyAll: return "inputNotifyAll";
+	case mtpc_inputPeerNotifyEventsEmpty: return "inputPeerNotifyEventsEmpty";
+	case mtpc_inputPeerNotifyEventsAll: return "inputPeerNotifyEventsAll";
+	case mtpc_inputPeerNotifySettings: return "inputPeerNotifySettings";
+	case mtpc_peerNotifyEventsEmpty: return "peerNotifyEventsEmpty";
+	case mtpc_peerNotifyEventsAll: return "peerNotifyEventsAll";
+	case mtpc_peerNotifySettingsEmpty: return "peerNotifySettingsEmpty";
+	case mtpc_peerNotifySettings: return "peerNotifySettings";
+	case mtpc_peerSettings: return "peerSettings";
+	case mtpc_wallPaper: return "wallPaper";
+	case mtpc_wallPaperSolid: return "wallPaperSolid";
+	case mtpc_inputReportReasonSpam: return "inputReportReasonSpam";
+	case mtpc_inputReportReasonViolence: return "inputReportReasonViolence";
+	case mtpc_inputReportReasonPornography: return "inputReportReasonPornography";
+	case mtpc_inputReportReasonOther: return "inputReportReasonOther";
+	case mtpc_userFull: return "userFull";
+	case mtpc_contact: return "contact";
+	case mtpc_importedContact: return "importedContact";
+	case mtpc_contactBlocked: return "contactBlocked";
+	case mtpc_contactStatus: return "contactStatus";
+	case mtpc_contacts_link: return "contacts_link";
+	case mtpc_contacts_contactsNotModified: return "contacts_contactsNotModified";
+	case mtpc_contacts_contacts: return "contacts_contacts";
+	case mtpc_contacts_importedContacts: return "contacts_importedContacts";
+	case mtpc_contacts_blocked: return "contacts_blocked";
+	case mtpc_contacts_blockedSlice: return "contacts_blockedSlice";
+	case mtpc_messages_dialogs: return "messages_dialogs";
+	case mtpc_messages_dialogsSlice: return "messages_dialogsSlice";
+	case mtpc_messages_messages: return "messages_messages";
+	case mtpc_messages_messagesSlice: return "messages_messagesSlice";
+	case mtpc_messages_channelMessages: return "messages_channelMessages";
+	case mtpc_messages_chats: return "messages_chats";
+	case mtpc_messages_chatsSlice: return "messages_chatsSlice";
+	case mtpc_messages_chatFull: return "messages_chatFull";
+	case mtpc_messages_affectedHistory: return "messages_affectedHistory";
+	case mtpc_inputMessagesFilterEmpty: return "inputMessagesFilterEmpty";
+	case mtpc_inputMessagesFilterPhotos: return "inputMessagesFilterPhotos";
+	case mtpc_inputMessagesFilterVideo: return "inputMessagesFilterVideo";
+	case mtpc_inputMessagesFilterPhotoVideo: return "inputMessagesFilterPhotoVideo";
+	case mtpc_inputMessagesFilterPhotoVideoDocuments: return "inputMessagesFilterPhotoVideoDocuments";
+	case mtpc_inputMessagesFilterDocument: return "inputMessagesFilterDocument";
+	case mtpc_inputMessagesFilterUrl: return "inputMessagesFilterUrl";
+	case mtpc_inputMessagesFilterGif: return "inputMessagesFilterGif";
+	case mtpc_inputMessagesFilterVoice: return "inputMessagesFilterVoice";
+	case mtpc_inputMessagesFilterMusic: return "inputMessagesFilterMusic";
+	case mtpc_inputMessagesFilterChatPhotos: return "inputMessagesFilterChatPhotos";
+	case mtpc_inputMessagesFilterPhoneCalls: return "inputMessagesFilterPhoneCalls";
+	case mtpc_updateNewMessage: return "updateNewMessage";
+	case mtpc_updateMessageID: return "updateMessageID";
+	case mtpc_updateDeleteMessages: return "updateDeleteMessages";
+	case mtpc_updateUserTyping: return "updateUserTyping";
+	case mtpc_updateChatUserTyping: return "updateChatUserTyping";
+	case mtpc_updateChatParticipants: return "updateChatParticipants";
+	case mtpc_updateUserStatus: return "updateUserStatus";
+	case mtpc_updateUserName: return "updateUserName";
+	case mtpc_updateUserPhoto: return "updateUserPhoto";
+	case mtpc_updateContactRegistered: return "updateContactRegistered";
+	case mtpc_updateContactLink: return "updateContactLink";
+	case mtpc_updateNewEncryptedMessage: return "updateNewEncryptedMessage";
+	case mtpc_updateEncryptedChatTyping: return "updateEncryptedChatTyping";
+	case mtpc_updateEncryption: return "updateEncryption";
+	case mtpc_updateEncryptedMessagesRead: return "updateEncryptedMessagesRead";
+	case mtpc_updateChatParticipantAdd: return "updateChatParticipantAdd";
+	case mtpc_updateChatParticipantDelete: return "updateChatParticipantDelete";
+	case mtpc_updateDcOptions: return "updateDcOptions";
+	case mtpc_updateUserBlocked: return "updateUserBlocked";
+	case mtpc_updateNotifySettings: return "updateNotifySettings";
+	case mtpc_updateServiceNotification: return "updateServiceNotification";
+	case mtpc_updatePrivacy: return "updatePrivacy";
+	case mtpc_updateUserPhone: return "updateUserPhone";
+	case mtpc_updateReadHistoryInbox: return "updateReadHistoryInbox";
+	case mtpc_updateReadHistoryOutbox: return "updateReadHistoryOutbox";
+	case mtpc_updateWebPage: return "updateWebPage";
+	case mtpc_updateReadMessagesContents: return "updateReadMessagesContents";
+	case mtpc_updateChannelTooLong: return "updateChannelTooLong";
+	case mtpc_updateChannel: return "updateChannel";
+	case mtpc_updateNewChannelMessage: return "updateNewChannelMessage";
+	case mtpc_updateReadChannelInbox: return "updateReadChannelInbox";
+	case mtpc_updateDeleteChannelMessages: return "updateDeleteChannelMessages";
+	case mtpc_updateChannelMessageViews: return "updateChannelMessageViews";
+	case mtpc_updateChatAdmins: return "updateChatAdmins";
+	case mtpc_updateChatParticipantAdmin: return "updateChatParticipantAdmin";
+	case mtpc_updateNewStickerSet: return "updateNewStickerSet";
+	case mtpc_updateStickerSetsOrder: return "updateStickerSetsOrder";
+	case mtpc_updateStickerSets: return "updateStickerSets";
+	case mtpc_updateSavedGifs: return "updateSavedGifs";
+	case mtpc_updateBotInlineQuery: return "updateBotInlineQuery";
+	case mtpc_updateBotInlineSend: return "updateBotInlineSend";
+	case mtpc_updateEditChannelMessage: return "updateEditChannelMessage";
+	case mtpc_updateChannelPinnedMessage: return "updateChannelPinnedMessage";
+	case mtpc_updateBotCallbackQuery: return "updateBotCallbackQuery";
+	case mtpc_updateEditMessage: return "updateEditMessage";
+	case mtpc_updateInlineBotCallbackQuery: return "updateInlineBotCallbackQuery";
+	case mtpc_updateReadChannelOutbox: return "updateReadChannelOutbox";
+	case mtpc_updateDraftMessage: return "updateDraftMessage";
+	case mtpc_updateReadFeaturedStickers: return "updateReadFeaturedStickers";
+	case mtpc_updateRecentStickers: return "updateRecentStickers";
+	case mtpc_updateConfig: return "updateConfig";
+	case mtpc_updatePtsChanged: return "updatePtsChanged";
+	case mtpc_updateChannelWebPage: return "updateChannelWebPage";
+	case mtpc_updatePhoneCall: return "updatePhoneCall";
+	case mtpc_updateDialogPinned: return "updateDialogPinned";
+	case mtpc_updatePinnedDialogs: return "updatePinnedDialogs";
+	case mtpc_updates_state: return "updates_state";
+	case mtpc_updates_differenceEmpty: return "updates_differenceEmpty";
+	case mtpc_updates_difference: return "updates_difference";
+	case mtpc_updates_differenceSlice: return "updates_differenceSlice";
+	case mtpc_updates_differenceTooLong: return "updates_differenceTooLong";
+	case mtpc_updatesTooLong: return "updatesTooLong";
+	case mtpc_updateShortMessage: return "updateShortMessage";
+	case mtpc_updateShortChatMessage: return "updateShortChatMessage";
+	case mtpc_updateShort: return "updateShort";
+	case mtpc_updatesCombined: return "updatesCombined";
+	case mtpc_updates: return "updates";
+	case mtpc_updateShortSentMessage: return "updateShortSentMessage";
+	case mtpc_photos_photos: return "photos_photos";
+	case mtpc_photos_photosSlice: return "photos_photosSlice";
+	case mtpc_photos_photo: return "photos_photo";
+	case mtpc_upload_file: return "upload_file";
+	case mtpc_dcOption: return "dcOption";
+	case mtpc_config: return "config";
+	case mtpc_nearestDc: return "nearestDc";
+	case mtpc_help_appUpdate: return "help_appUpdate";
+	case mtpc_help_noAppUpdate: return "help_noAppUpdate";
+	case mtpc_help_inviteText: return "help_inviteText";
+	case mtpc_encryptedChatEmpty: return "encryptedChatEmpty";
+	case mtpc_encryptedChatWaiting: return "encryptedChatWaiting";
+	case mtpc_encryptedChatRequested: return "encryptedChatRequested";
+	case mtpc_encryptedChat: return "encryptedChat";
+	case mtpc_encryptedChatDiscarded: return "encryptedChatDiscarded";
+	case mtpc_inputEncryptedChat: return "inputEncryptedChat";
+	case mtpc_encryptedFileEmpty: return "encryptedFileEmpty";
+	case mtpc_encryptedFile: return "encryptedFile";
+	case mtpc_inputEncryptedFileEmpty: return "inputEncryptedFileEmpty";
+	case mtpc_inputEncryptedFileUploaded: return "inputEncryptedFileUploaded";
+	case mtpc_inputEncryptedFile: return "inputEncryptedFile";
+	case mtpc_inputEncryptedFileBigUploaded: return "inputEncryptedFileBigUploaded";
+	case mtpc_encryptedMessage: return "encryptedMessage";
+	case mtpc_encryptedMessageService: return "encryptedMessageService";
+	case mtpc_messages_dhConfigNotModified: return "messages_dhConfigNotModified";
+	case mtpc_messages_dhConfig: return "messages_dhConfig";
+	case mtpc_messages_sentEncryptedMessage: return "messages_sentEncryptedMessage";
+	case mtpc_messages_sentEncryptedFile: return "messages_sentEncryptedFile";
+	case mtpc_inputDocumentEmpty: return "inputDocumentEmpty";
+	case mtpc_inputDocument: return "inputDocument";
+	case mtpc_documentEmpty: return "documentEmpty";
+	case mtpc_document: return "document";
+	case mtpc_help_support: return "help_support";
+	case mtpc_notifyPeer: return "notifyPeer";
+	case mtpc_notifyUsers: return "notifyUsers";
+	case mtpc_notifyChats: return "notifyChats";
+	case mtpc_notifyAll: return "notifyAll";
+	case mtpc_sendMessageTypingAction: return "sendMessageTypingAction";
+	case mtpc_sendMessageCancelAction: return "sendMessageCancelAction";
+	case mtpc_sendMessageRecordVideoAction: return "sendMessageRecordVideoAction";
+	case mtpc_sendMessageUploadVideoAction: return "sendMessageUploadVideoAction";
+	case mtpc_sendMessageRecordAudioAction: return "sendMessageRecordAudioAction";
+	case mtpc_sendMessageUploadAudioAction: return "sendMessageUploadAudioAction";
+	case mtpc_sendMessageUploadPhotoAction: return "sendMessageUploadPhotoAction";
+	case mtpc_sendMessageUploadDocumentAction: return "sendMessageUploadDocumentAction";
+	case mtpc_sendMessageGeoLocationAction: return "sendMessageGeoLocationAction";
+	case mtpc_sendMessageChooseContactAction: return "sendMessageChooseContactAction";
+	case mtpc_sendMessageGamePlayAction: return "sendMessageGamePlayAction";
+	case mtpc_contacts_found: return "contacts_found";
+	case mtpc_inputPrivacyKeyStatusTimestamp: return "inputPrivacyKeyStatusTimestamp";
+	case mtpc_inputPrivacyKeyChatInvite: return "inputPrivacyKeyChatInvite";
+	case mtpc_inputPrivacyKeyPhoneCall: return "inputPrivacyKeyPhoneCall";
+	case mtpc_privacyKeyStatusTimestamp: return "privacyKeyStatusTimestamp";
+	case mtpc_privacyKeyChatInvite: return "privacyKeyChatInvite";
+	case mtpc_privacyKeyPhoneCall: return "privacyKeyPhoneCall";
+	case mtpc_inputPrivacyValueAllowContacts: return "inputPrivacyValueAllowContacts";
+	case mtpc_inputPrivacyValueAllowAll: return "inputPrivacyValueAllowAll";
+	case mtpc_inputPrivacyValueAllowUsers: return "inputPrivacyValueAllowUsers";
+	case mtpc_inputPrivacyValueDisallowContacts: return "inputPrivacyValueDisallowContacts";
+	case mtpc_inputPrivacyValueDisallowAll: return "inputPrivacyValueDisallowAll";
+	case mtpc_inputPrivacyValueDisallowUsers: return "inputPrivacyValueDisallowUsers";
+	case mtpc_privacyValueAllowContacts: return "privacyValueAllowContacts";
+	case mtpc_privacyValueAllowAll: return "privacyValueAllowAll";
+	case mtpc_privacyValueAllowUsers: return "privacyValueAllowUsers";
+	case mtpc_privacyValueDisallowContacts: return "privacyValueDisallowContacts";
+	case mtpc_privacyValueDisallowAll: return "privacyValueDisallowAll";
+	case mtpc_privacyValueDisallowUsers: return "privacyValueDisallowUsers";
+	case mtpc_account_privacyRules: return "account_privacyRules";
+	case mtpc_accountDaysTTL: return "accountDaysTTL";
+	case mtpc_documentAttributeImageSize: return "documentAttributeImageSize";
+	case mtpc_documentAttributeAnimated: return "documentAttributeAnimated";
+	case mtpc_documentAttributeSticker: return "documentAttributeSticker";
+	case mtpc_documentAttributeVideo: return "documentAttributeVideo";
+	case mtpc_documentAttributeAudio: return "documentAttributeAudio";
+	case mtpc_documentAttributeFilename: return "documentAttributeFilename";
+	case mtpc_documentAttributeHasStickers: return "documentAttributeHasStickers";
+	case mtpc_messages_stickersNotModified: return "messages_stickersNotModified";
+	case mtpc_messages_stickers: return "messages_stickers";
+	case mtpc_stickerPack: return "stickerPack";
+	case mtpc_messages_allStickersNotModified: return "messages_allStickersNotModified";
+	case mtpc_messages_allStickers: return "messages_allStickers";
+	case mtpc_disabledFeature: return "disabledFeature";
+	case mtpc_messages_affectedMessages: return "messages_affectedMessages";
+	case mtpc_contactLinkUnknown: return "contactLinkUnknown";
+	case mtpc_contactLinkNone: return "contactLinkNone";
+	case mtpc_contactLinkHasPhone: return "contactLinkHasPhone";
+	case mtpc_contactLinkContact: return "contactLinkContact";
+	case mtpc_webPageEmpty: return "webPageEmpty";
+	case mtpc_webPagePending: return "webPagePending";
+	case mtpc_webPage: return "webPage";
+	case mtpc_webPageNotModified: return "webPageNotModified";
+	case mtpc_authorization: return "authorization";
+	case mtpc_account_authorizations: return "account_authorizations";
+	case mtpc_account_noPassword: return "account_noPassword";
+	case mtpc_account_password: return "account_password";
+	case mtpc_account_passwordSettings: return "account_passwordSettings";
+	case mtpc_account_passwordInputSettings: return "account_passwordInputSettings";
+	case mtpc_auth_passwordRecovery: return "auth_passwordRecovery";
+	case mtpc_receivedNotifyMessage: return "receivedNotifyMessage";
+	case mtpc_chatInviteEmpty: return "chatInviteEmpty";
+	case mtpc_chatInviteExported: return "chatInviteExported";
+	case mtpc_chatInviteAlready: return "chatInviteAlready";
+	case mtpc_chatInvite: return "chatInvite";
+	case mtpc_inputStickerSetEmpty: return "inputStickerSetEmpty";
+	case mtpc_inputStickerSetID: return "inputStickerSetID";
+	case mtpc_inputStickerSetShortName: return "inputStickerSetShortName";
+	case mtpc_stickerSet: return "stickerSet";
+	case mtpc_messages_stickerSet: return "messages_stickerSet";
+	case mtpc_botCommand: return "botCommand";
+	case mtpc_botInfo: return "botInfo";
+	case mtpc_keyboardButton: return "keyboardButton";
+	case mtpc_keyboardButtonUrl: return "keyboardButtonUrl";
+	case mtpc_keyboardButtonCallback: return "keyboardButtonCallback";
+	case mtpc_keyboardButtonRequestPhone: return "keyboardButtonRequestPhone";
+	case mtpc_keyboardButtonRequestGeoLocation: return "keyboardButtonRequestGeoLocation";
+	case mtpc_keyboardButtonSwitchInline: return "keyboardButtonSwitchInline";
+	case mtpc_keyboardButtonGame: return "keyboardButtonGame";
+	case mtpc_keyboardButtonRow: return "keyboardButtonRow";
+	case mtpc_replyKeyboardHide: return "replyKeyboardHide";
+	case mtpc_replyKeyboardForceReply: return "replyKeyboardForceReply";
+	case mtpc_replyKeyboardMarkup: return "replyKeyboardMarkup";
+	case mtpc_replyInlineMarkup: return "replyInlineMarkup";
+	case mtpc_help_appChangelogEmpty: return "help_appChangelogEmpty";
+	case mtpc_help_appChangelog: return "help_appChangelog";
+	case mtpc_messageEntityUnknown: return "messageEntityUnknown";
+	case mtpc_messageEntityMention: return "messageEntityMention";
+	case mtpc_messageEntityHashtag: return "messageEntityHashtag";
+	case mtpc_messageEntityBotCommand: return "messageEntityBotCommand";
+	case mtpc_messageEntityUrl: return "messageEntityUrl";
+	case mtpc_messageEntityEmail: return "messageEntityEmail";
+	case mtpc_messageEntityBold: return "messageEntityBold";
+	case mtpc_messageEntityItalic: return "messageEntityItalic";
+	case mtpc_messageEntityCode: return "messageEntityCode";
+	case mtpc_messageEntityPre: return "messageEntityPre";
+	case mtpc_messageEntityTextUrl: return "messageEntityTextUrl";
+	case mtpc_messageEntityMentionName: return "messageEntityMentionName";
+	case mtpc_inputMessageEntityMentionName: return "inputMessageEntityMentionName";
+	case mtpc_inputChannelEmpty: return "inputChannelEmpty";
+	case mtpc_inputChannel: return "inputChannel";
+	case mtpc_contacts_resolvedPeer: return "contacts_resolvedPeer";
+	case mtpc_messageRange: return "messageRange";
+	case mtpc_updates_channelDifferenceEmpty: return "updates_channelDifferenceEmpty";
+	case mtpc_updates_channelDifferenceTooLong: return "updates_channelDifferenceTooLong";
+	case mtpc_updates_channelDifference: return "updates_channelDifference";
+	case mtpc_channelMessagesFilterEmpty: return "channelMessagesFilterEmpty";
+	case mtpc_channelMessagesFilter: return "channelMessagesFilter";
+	case mtpc_channelParticipant: return "channelParticipant";
+	case mtpc_channelParticipantSelf: return "channelParticipantSelf";
+	case mtpc_channelParticipantModerator: return "channelParticipantModerator";
+	case mtpc_channelParticipantEditor: return "channelParticipantEditor";
+	case mtpc_channelParticipantKicked: return "channelParticipantKicked";
+	case mtpc_channelParticipantCreator: return "channelParticipantCreator";
+	case mtpc_channelParticipantsRecent: return "channelParticipantsRecent";
+	case mtpc_channelParticipantsAdmins: return "channelParticipantsAdmins";
+	case mtpc_channelParticipantsKicked: return "channelParticipantsKicked";
+	case mtpc_channelParticipantsBots: return "channelParticipantsBots";
+	case mtpc_channelRoleEmpty: return "channelRoleEmpty";
+	case mtpc_channelRoleModerator: return "channelRoleModerator";
+	case mtpc_channelRoleEditor: return "channelRoleEditor";
+	case mtpc_channels_channelParticipants: return "channels_channelParticipants";
+	case mtpc_channels_channelParticipant: return "channels_channelParticipant";
+	case mtpc_help_termsOfService: return "help_termsOfService";
+	case mtpc_foundGif: return "foundGif";
+	case mtpc_foundGifCached: return "foundGifCached";
+	case mtpc_messages_foundGifs: return "messages_foundGifs";
+	case mtpc_messages_savedGifsNotModified: return "messages_savedGifsNotModified";
+	case mtpc_messages_savedGifs: return "messages_savedGifs";
+	case mtpc_inputBotInlineMessageMediaAuto: return "inputBotInlineMessageMediaAuto";
+	case mtpc_inputBotInlineMessageText: return "inputBotInlineMessageText";
+	case mtpc_inputBotInlineMessageMediaGeo: return "inputBotInlineMessageMediaGeo";
+	case mtpc_inputBotInlineMessageMediaVenue: return "inputBotInlineMessageMediaVenue";
+	case mtpc_inputBotInlineMessageMediaContact: return "inputBotInlineMessageMediaContact";
+	case mtpc_inputBotInlineMessageGame: return "inputBotInlineMessageGame";
+	case mtpc_inputBotInlineResult: return "inputBotInlineResult";
+	case mtpc_inputBotInlineResultPhoto: return "inputBotInlineResultPhoto";
+	case mtpc_inputBotInlineResultDocument: return "inputBotInlineResultDocument";
+	case mtpc_inputBotInlineResultGame: return "inputBotInlineResultGame";
+	case mtpc_botInlineMessageMediaAuto: return "botInlineMessageMediaAuto";
+	case mtpc_botInlineMessageText: return "botInlineMessageText";
+	case mtpc_botInlineMessageMediaGeo: return "botInlineMessageMediaGeo";
+	case mtpc_botInlineMessageMediaVenue: return "botInlineMessageMediaVenue";
+	case mtpc_botInlineMessageMediaContact: return "botInlineMessageMediaContact";
+	case mtpc_botInlineResult: return "botInlineResult";
+	case mtpc_botInlineMediaResult: return "botInlineMediaResult";
+	case mtpc_messages_botResults: return "messages_botResults";
+	case mtpc_exportedMessageLink: return "exportedMessageLink";
+	case mtpc_messageFwdHeader: return "messageFwdHeader";
+	case mtpc_auth_codeTypeSms: return "auth_codeTypeSms";
+	case mtpc_auth_codeTypeCall: return "auth_codeTypeCall";
+	case mtpc_auth_codeTypeFlashCall: return "auth_codeTypeFlashCall";
+	case mtpc_auth_sentCodeTypeApp: return "auth_sentCodeTypeApp";
+	case mtpc_auth_sentCodeTypeSms: return "auth_sentCodeTypeSms";
+	case mtpc_auth_sentCodeTypeCall: return "auth_sentCodeTypeCall";
+	case mtpc_auth_sentCodeTypeFlashCall: return "auth_sentCodeTypeFlashCall";
+	case mtpc_messages_botCallbackAnswer: return "messages_botCallbackAnswer";
+	case mtpc_messages_messageEditData: return "messages_messageEditData";
+	case mtpc_inputBotInlineMessageID: return "inputBotInlineMessageID";
+	case mtpc_inlineBotSwitchPM: return "inlineBotSwitchPM";
+	case mtpc_messages_peerDialogs: return "messages_peerDialogs";
+	case mtpc_topPeer: return "topPeer";
+	case mtpc_topPeerCategoryBotsPM: return "topPeerCategoryBotsPM";
+	case mtpc_topPeerCategoryBotsInline: return "topPeerCategoryBotsInline";
+	case mtpc_topPeerCategoryCorrespondents: return "topPeerCategoryCorrespondents";
+	case mtpc_topPeerCategoryGroups: return "topPeerCategoryGroups";
+	case mtpc_topPeerCategoryChannels: return "topPeerCategoryChannels";
+	case mtpc_topPeerCategoryPeers: return "topPeerCategoryPeers";
+	case mtpc_contacts_topPeersNotModified: return "contacts_topPeersNotModified";
+	case mtpc_contacts_topPeers: return "contacts_topPeers";
+	case mtpc_draftMessageEmpty: return "draftMessageEmpty";
+	case mtpc_draftMessage: return "draftMessage";
+	case mtpc_messages_featuredStickersNotModified: return "messages_featuredStickersNotModified";
+	case mtpc_messages_featuredStickers: return "messages_featuredStickers";
+	case mtpc_messages_recentStickersNotModified: return "messages_recentStickersNotModified";
+	case mtpc_messages_recentStickers: return "messages_recentStickers";
+	case mtpc_messages_archivedStickers: return "messages_archivedStickers";
+	case mtpc_messages_stickerSetInstallResultSuccess: return "messages_stickerSetInstallResultSuccess";
+	case mtpc_messages_stickerSetInstallResultArchive: return "messages_stickerSetInstallResultArchive";
+	case mtpc_stickerSetCovered: return "stickerSetCovered";
+	case mtpc_stickerSetMultiCovered: return "stickerSetMultiCovered";
+	case mtpc_maskCoords: return "maskCoords";
+	case mtpc_inputStickeredMediaPhoto: return "inputStickeredMediaPhoto";
+	case mtpc_inputStickeredMediaDocument: return "inputStickeredMediaDocument";
+	case mtpc_game: return "game";
+	case mtpc_inputGameID: return "inputGameID";
+	case mtpc_inputGameShortName: return "inputGameShortName";
+	case mtpc_highScore: return "highScore";
+	case mtpc_messages_highScores: return "messages_highScores";
+	case mtpc_textEmpty: return "textEmpty";
+	case mtpc_textPlain: return "textPlain";
+	case mtpc_textBold: return "textBold";
+	case mtpc_textItalic: return "textItalic";
+	case mtpc_textUnderline: return "textUnderline";
+	case mtpc_textStrike: return "textStrike";
+	case mtpc_textFixed: return "textFixed";
+	case mtpc_textUrl: return "textUrl";
+	case mtpc_textEmail: return "textEmail";
+	case mtpc_textConcat: return "textConcat";
+	case mtpc_pageBlockUnsupported: return "pageBlockUnsupported";
+	case mtpc_pageBlockTitle: return "pageBlockTitle";
+	case mtpc_pageBlockSubtitle: return "pageBlockSubtitle";
+	case mtpc_pageBlockAuthorDate: return "pageBlockAuthorDate";
+	case mtpc_pageBlockHeader: return "pageBlockHeader";
+	case mtpc_pageBlockSubheader: return "pageBlockSubheader";
+	case mtpc_pageBlockParagraph: return "pageBlockParagraph";
+	case mtpc_pageBlockPreformatted: return "pageBlockPreformatted";
+	case mtpc_pageBlockFooter: return "pageBlockFooter";
+	case mtpc_pageBlockDivider: return "pageBlockDivider";
+	case mtpc_pageBlockAnchor: return "pageBlockAnchor";
+	case mtpc_pageBlockList: return "pageBlockList";
+	case mtpc_pageBlockBlockquote: return "pageBlockBlockquote";
+	case mtpc_pageBlockPullquote: return "pageBlockPullquote";
+	case mtpc_pageBlockPhoto: return "pageBlockPhoto";
+	case mtpc_pageBlockVideo: return "pageBlockVideo";
+	case mtpc_pageBlockCover: return "pageBlockCover";
+	case mtpc_pageBlockEmbed: return "pageBlockEmbed";
+	case mtpc_pageBlockEmbedPost: return "pageBlockEmbedPost";
+	case mtpc_pageBlockCollage: return "pageBlockCollage";
+	case mtpc_pageBlockSlideshow: return "pageBlockSlideshow";
+	case mtpc_pagePart: return "pagePart";
+	case mtpc_pageFull: return "pageFull";
+	case mtpc_inputPhoneCall: return "inputPhoneCall";
+	case mtpc_phoneCallEmpty: return "phoneCallEmpty";
+	case mtpc_phoneCallWaiting: return "phoneCallWaiting";
+	case mtpc_phoneCallRequested: return "phoneCallRequested";
+	case mtpc_phoneCall: return "phoneCall";
+	case mtpc_phoneCallDiscarded: return "phoneCallDiscarded";
+	case mtpc_phoneConnection: return "phoneConnection";
+	case mtpc_phoneCallProtocol: return "phoneCallProtocol";
+	case mtpc_phone_phoneCall: return "phone_phoneCall";
+	case mtpc_phoneCallDiscardReasonMissed: return "phoneCallDiscardReasonMissed";
+	case mtpc_phoneCallDiscardReasonDisconnect: return "phoneCallDiscardReasonDisconnect";
+	case mtpc_phoneCallDiscardReasonHangup: return "phoneCallDiscardReasonHangup";
+	case mtpc_phoneCallDiscardReasonBusy: return "phoneCallDiscardReasonBusy";
+	case mtpc_req_pq: return "req_pq";
+	case mtpc_req_DH_params: return "req_DH_params";
+	case mtpc_set_client_DH_params: return "set_client_DH_params";
+	case mtpc_rpc_drop_answer: return "rpc_drop_answer";
+	case mtpc_get_future_salts: return "get_future_salts";
+	case mtpc_ping: return "ping";
+	case mtpc_ping_delay_disconnect: return "ping_delay_disconnect";
+	case mtpc_destroy_session: return "destroy_session";
+	case mtpc_contest_saveDeveloperInfo: return "contest_saveDeveloperInfo";
+	case mtpc_auth_logOut: return "auth_logOut";
+	case mtpc_auth_resetAuthorizations: return "auth_resetAuthorizations";
+	case mtpc_auth_sendInvites: return "auth_sendInvites";
+	case mtpc_auth_bindTempAuthKey: return "auth_bindTempAuthKey";
+	case mtpc_auth_cancelCode: return "auth_cancelCode";
+	case mtpc_auth_dropTempAuthKeys: return "auth_dropTempAuthKeys";
+	case mtpc_account_registerDevice: return "account_registerDevice";
+	case mtpc_account_unregisterDevice: return "account_unregisterDevice";
+	case mtpc_account_updateNotifySettings: return "account_updateNotifySettings";
+	case mtpc_account_resetNotifySettings: return "account_resetNotifySettings";
+	case mtpc_account_updateStatus: return "account_updateStatus";
+	case mtpc_account_reportPeer: return "account_reportPeer";
+	case mtpc_account_checkUsername: return "account_checkUsername";
+	case mtpc_account_deleteAccount: return "account_deleteAccount";
+	case mtpc_account_setAccountTTL: return "account_setAccountTTL";
+	case mtpc_account_updateDeviceLocked: return "account_updateDeviceLocked";
+	case mtpc_account_resetAuthorization: return "account_resetAuthorization";
+	case mtpc_account_updatePasswordSettings: return "account_updatePasswordSettings";
+	case mtpc_account_confirmPhone: return "account_confirmPhone";
+	case mtpc_contacts_deleteContacts: return "contacts_deleteContacts";
+	case mtpc_contacts_block: return "contacts_block";
+	case mtpc_contacts_unblock: return "contacts_unblock";
+	case mtpc_contacts_resetTopPeerRating: return "contacts_resetTopPeerRating";
+	case mtpc_messages_setTyping: return "messages_setTyping";
+	case mtpc_messages_reportSpam: return "messages_reportSpam";
+	case mtpc_messages_hideReportSpam: return "messages_hideReportSpam";
+	case mtpc_messages_discardEncryption: return "messages_discardEncryption";
+	case mtpc_messages_setEncryptedTyping: return "messages_setEncryptedTyping";
+	case mtpc_messages_readEncryptedHistory: return "messages_readEncryptedHistory";
+	case mtpc_messages_reportEncryptedSpam: return "messages_reportEncryptedSpam";
+	case mtpc_messages_uninstallStickerSet: return "messages_uninstallStickerSet";
+	case mtpc_messages_editChatAdmin: return "messages_editChatAdmin";
+	case mtpc_messages_reorderStickerSets: return "messages_reorderStickerSets";
+	case mtpc_messages_saveGif: return "messages_saveGif";
+	case mtpc_messages_setInlineBotResults: return "messages_setInlineBotResults";
+	case mtpc_messages_editInlineBotMessage: return "messages_editInlineBotMessage";
+	case mtpc_messages_setBotCallbackAnswer: return "messages_setBotCallbackAnswer";
+	case mtpc_messages_saveDraft: return "messages_saveDraft";
+	case mtpc_messages_readFeaturedStickers: return "messages_readFeaturedStickers";
+	case mtpc_messages_saveRecentSticker: return "messages_saveRecentSticker";
+	case mtpc_messages_clearRecentStickers: return "messages_clearRecentStickers";
+	case mtpc_messages_setInlineGameScore: return "messages_setInlineGameScore";
+	case mtpc_messages_toggleDialogPin: return "messages_toggleDialogPin";
+	case mtpc_messages_reorderPinnedDialogs: return "messages_reorderPinnedDialogs";
+	case mtpc_upload_saveFilePart: return "upload_saveFilePart";
+	case mtpc_upload_saveBigFilePart: return "upload_saveBigFilePart";
+	case mtpc_help_saveAppLog: return "help_saveAppLog";
+	case mtpc_help_setBotUpdatesStatus: return "help_setBotUpdatesStatus";
+	case mtpc_channels_readHistory: return "channels_readHistory";
+	case mtpc_channels_reportSpam: return "channels_reportSpam";
+	case mtpc_channels_editAbout: return "channels_editAbout";
+	case mtpc_channels_checkUsername: return "channels_checkUsername";
+	case mtpc_channels_updateUsername: return "channels_updateUsername";
+	case mtpc_phone_discardCall: return "phone_discardCall";
+	case mtpc_phone_receivedCall: return "phone_receivedCall";
+	case mtpc_invokeAfterMsg: return "invokeAfterMsg";
+	case mtpc_invokeAfterMsgs: return "invokeAfterMsgs";
+	case mtpc_initConnection: return "initConnection";
+	case mtpc_invokeWithLayer: return "invokeWithLayer";
+	case mtpc_invokeWithoutUpdates: return "invokeWithoutUpdates";
+	case mtpc_auth_checkPhone: return "auth_checkPhone";
+	case mtpc_auth_sendCode: return "auth_sendCode";
+	case mtpc_auth_resendCode: return "auth_resendCode";
+	case mtpc_account_sendChangePhoneCode: return "account_sendChangePhoneCode";
+	case mtpc_account_sendConfirmPhoneCode: return "account_sendConfirmPhoneCode";
+	case mtpc_auth_signUp: return "auth_signUp";
+	case mtpc_auth_signIn: return "auth_signIn";
+	case mtpc_auth_importAuthorization: return "auth_importAuthorization";
+	case mtpc_auth_importBotAuthorization: return "auth_importBotAuthorization";
+	case mtpc_auth_checkPassword: return "auth_checkPassword";
+	case mtpc_auth_recoverPassword: return "auth_recoverPassword";
+	case mtpc_auth_exportAuthorization: return "auth_exportAuthorization";
+	case mtpc_auth_requestPasswordRecovery: return "auth_requestPasswordRecovery";
+	case mtpc_account_getNotifySettings: return "account_getNotifySettings";
+	case mtpc_account_updateProfile: return "account_updateProfile";
+	case mtpc_account_updateUsername: return "account_updateUsername";
+	case mtpc_account_changePhone: return "account_changePhone";
+	case mtpc_contacts_importCard: return "contacts_importCard";
+	case mtpc_account_getWallPapers: return "account_getWallPapers";
+	case mtpc_account_getPrivacy: return "account_getPrivacy";
+	case mtpc_account_setPrivacy: return "account_setPrivacy";
+	case mtpc_account_getAccountTTL: return "account_getAccountTTL";
+	case mtpc_account_getAuthorizations: return "account_getAuthorizations";
+	case mtpc_account_getPassword: return "account_getPassword";
+	case mtpc_account_getPasswordSettings: return "account_getPasswordSettings";
+	case mtpc_users_getUsers: return "users_getUsers";
+	case mtpc_users_getFullUser: return "users_getFullUser";
+	case mtpc_contacts_getStatuses: return "contacts_getStatuses";
+	case mtpc_contacts_getContacts: return "contacts_getContacts";
+	case mtpc_contacts_importContacts: return "contacts_importContacts";
+	case mtpc_contacts_deleteContact: return "contacts_deleteContact";
+	case mtpc_contacts_getBlocked: return "contacts_getBlocked";
+	case mtpc_contacts_exportCard: return "contacts_exportCard";
+	case mtpc_messages_getMessagesViews: return "messages_getMessagesViews";
+	case mtpc_contacts_search: return "contacts_search";
+	case mtpc_contacts_resolveUsername: return "contacts_resolveUsername";
+	case mtpc_contacts_getTopPeers: return "contacts_getTopPeers";
+	case mtpc_messages_getMessages: return "messages_getMessages";
+	case mtpc_messages_getHistory: return "messages_getHistory";
+	case mtpc_messages_search: return "messages_search";
+	case mtpc_messages_searchGlobal: return "messages_searchGlobal";
+	case mtpc_channels_getMessages: return "channels_getMessages";
+	case mtpc_messages_getDialogs: return "messages_getDialogs";
+	case mtpc_messages_readHistory: return "messages_readHistory";
+	case mtpc_messages_deleteMessages: return "messages_deleteMessages";
+	case mtpc_messages_readMessageContents: return "messages_readMessageContents";
+	case mtpc_channels_deleteMessages: return "channels_deleteMessages";
+	case mtpc_messages_deleteHistory: return "messages_deleteHistory";
+	case mtpc_channels_deleteUserHistory: return "channels_deleteUserHistory";
+	case mtpc_messages_receivedMessages: return "messages_receivedMessages";
+	case mtpc_messages_sendMessage: return "messages_sendMessage";
+	case mtpc_messages_sendMedia: return "messages_sendMedia";
+	case mtpc_messages_forwardMessages: return "messages_forwardMessages";
+	case mtpc_messages_editChatTitle: return "messages_editChatTitle";
+	case mtpc_messages_editChatPhoto: return "messages_editChatPhoto";
+	case mtpc_messages_addChatUser: return "messages_addChatUser";
+	case mtpc_messages_deleteChatUser: return "messages_deleteChatUser";
+	case mtpc_messages_createChat: return "messages_createChat";
+	case mtpc_messages_forwardMessage: return "messages_forwardMessage";
+	case mtpc_messages_importChatInvite: return "messages_importChatInvite";
+	case mtpc_messages_startBot: return "messages_startBot";
+	case mtpc_messages_toggleChatAdmins: return "messages_toggleChatAdmins";
+	case mtpc_messages_migrateChat: return "messages_migrateChat";
+	case mtpc_messages_sendInlineBotResult: return "messages_sendInlineBotResult";
+	case mtpc_messages_editMessage: return "messages_editMessage";
+	case mtpc_messages_getAllDrafts: return "messages_getAllDrafts";
+	case mtpc_messages_setGameScore: return "messages_setGameScore";
+	case mtpc_channels_createChannel: return "channels_createChannel";
+	case mtpc_channels_editAdmin: return "channels_editAdmin";
+	case mtpc_channels_editTitle: return "channels_editTitle";
+	case mtpc_channels_editPhoto: return "channels_editPhoto";
+	case mtpc_channels_joinChannel: return "channels_joinChannel";
+	case mtpc_channels_leaveChannel: return "channels_leaveChannel";
+	case mtpc_channels_inviteToChannel: return "channels_inviteToChannel";
+	case mtpc_channels_kickFromChannel: return "channels_kickFromChannel";
+	case mtpc_channels_deleteChannel: return "channels_deleteChannel";
+	case mtpc_channels_toggleInvites: return "channels_toggleInvites";
+	case mtpc_channels_toggleSignatures: return "channels_toggleSignatures";
+	case mtpc_channels_updatePinnedMessage: return "channels_updatePinnedMessage";
+	case mtpc_messages_getPeerSettings: return "messages_getPeerSettings";
+	case mtpc_messages_getChats: return "messages_getChats";
+	case mtpc_messages_getCommonChats: return "messages_getCommonChats";
+	case mtpc_messages_getAllChats: return "messages_getAllChats";
+	case mtpc_channels_getChannels: return "channels_getChannels";
+	case mtpc_channels_getAdminedPublicChannels: return "channels_getAdminedPublicChannels";
+	case mtpc_messages_getFullChat: return "messages_getFullChat";
+	case mtpc_channels_getFullChannel: return "channels_getFullChannel";
+	case mtpc_messages_getDhConfig: return "messages_getDhConfig";
+	case mtpc_messages_requestEncryption: return "messages_requestEncryption";
+	case mtpc_messages_acceptEncryption: return "messages_acceptEncryption";
+	case mtpc_messages_sendEncrypted: return "messages_sendEncrypted";
+	case mtpc_messages_sendEncryptedFile: return "messages_sendEncryptedFile";
+	case mtpc_messages_sendEncryptedService: return "messages_sendEncryptedService";
+	case mtpc_messages_receivedQueue: return "messages_receivedQueue";
+	case mtpc_photos_deletePhotos: return "photos_deletePhotos";
+	case mtpc_messages_getAllStickers: return "messages_getAllStickers";
+	case mtpc_messages_getMaskStickers: return "messages_getMaskStickers";
+	case mtpc_messages_getWebPagePreview: return "messages_getWebPagePreview";
+	case mtpc_messages_exportChatInvite: return "messages_exportChatInvite";
+	case mtpc_channels_exportInvite: return "channels_exportInvite";
+	case mtpc_messages_checkChatInvite: return "messages_checkChatInvite";
+	case mtpc_messages_getStickerSet: return "messages_getStickerSet";
+	case mtpc_messages_installStickerSet: return "messages_installStickerSet";
+	case mtpc_messages_getDocumentByHash: return "messages_getDocumentByHash";
+	case mtpc_messages_searchGifs: return "messages_searchGifs";
+	case mtpc_messages_getSavedGifs: return "messages_getSavedGifs";
+	case mtpc_messages_getInlineBotResults: return "messages_getInlineBotResults";
+	case mtpc_messages_getMessageEditData: return "messages_getMessageEditData";
+	case mtpc_messages_getBotCallbackAnswer: return "messages_getBotCallbackAnswer";
+	case mtpc_messages_getPeerDialogs: return "messages_getPeerDialogs";
+	case mtpc_messages_getPinnedDialogs: return "messages_getPinnedDialogs";
+	case mtpc_messages_getFeaturedStickers: return "messages_getFeaturedStickers";
+	case mtpc_messages_getRecentStickers: return "messages_getRecentStickers";
+	case mtpc_messages_getArchivedStickers: return "messages_getArchivedStickers";
+	case mtpc_messages_getAttachedStickers: return "messages_getAttachedStickers";
+	case mtpc_messages_getGameHighScores: return "messages_getGameHighScores";
+	case mtpc_messages_getInlineGameHighScores: return "messages_getInlineGameHighScores";
+	case mtpc_messages_getWebPage: return "messages_getWebPage";
+	case mtpc_updates_getState: return "updates_getState";
+	case mtpc_updates_getDifference: return "updates_getDifference";
+	case mtpc_updates_getChannelDifference: return "updates_getChannelDifference";
+	case mtpc_photos_updateProfilePhoto: return "photos_updateProfilePhoto";
+	case mtpc_photos_uploadProfilePhoto: return "photos_uploadProfilePhoto";
+	case mtpc_photos_getUserPhotos: return "photos_getUserPhotos";
+	case mtpc_upload_getFile: return "upload_getFile";
+	case mtpc_help_getConfig: return "help_getConfig";
+	case mtpc_help_getNearestDc: return "help_getNearestDc";
+	case mtpc_help_getAppUpdate: return "help_getAppUpdate";
+	case mtpc_help_getInviteText: return "help_getInviteText";
+	case mtpc_help_getSupport: return "help_getSupport";
+	case mtpc_help_getAppChangelog: return "help_getAppChangelog";
+	case mtpc_help_getTermsOfService: return "help_getTermsOfService";
+	case mtpc_channels_getParticipants: return "channels_getParticipants";
+	case mtpc_channels_getParticipant: return "channels_getParticipant";
+	case mtpc_channels_exportMessageLink: return "channels_exportMessageLink";
+	case mtpc_phone_requestCall: return "phone_requestCall";
+	case mtpc_phone_acceptCall: return "phone_acceptCall";
+	}
+	return nullptr;
+}
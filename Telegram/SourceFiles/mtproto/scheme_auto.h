@@ -40389,3 +40389,6 @@ inline MTPDchannel::Flags mtpCastFlags(MTPflags<MTPDchannelForbidden::Flags> fla
 
 // Human-readable text serialization
 void mtpTextSerializeType(MTPStringLogger &to, const mtpPrime *&from, const mtpPrime *end, mtpPrime cons, uint32 level, mtpPrime vcons);
+
+// Constructor or method name by its type id, nullptr for unknown ids
+const char *mtpTypeName(mtpTypeId type);
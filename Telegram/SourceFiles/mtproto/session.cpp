@@ -22,6 +22,9 @@ Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
 
 #include "mtproto/session.h"
 
+#include "mtproto/rpc_stats.h"
+#include "localstorage.h"
+
 namespace MTP {
 namespace internal {
 
@@ -409,12 +412,17 @@ mtpRequestId Session::resend(quint64 msgId, qint64 msCanWait, bool forceContaine
 	if (mtpRequestData::isSentContainer(request)) { // for container just resend all messages we can
 		DEBUG_LOG(("Message Info: resending container from haveSent, msgId %1").arg(msgId));
 		const mtpMsgId *ids = (const mtpMsgId *)(request->constData() + 8);
+		startResendBatch();
 		for (uint32 i = 0, l = (request->size() - 8) >> 1; i < l; ++i) {
 			resend(ids[i], 10, true);
 		}
+		finishResendBatch();
 		return 0xFFFFFFFF;
 	} else if (!mtpRequestData::isStateRequest(request)) {
 		request->msDate = forceContainer ? 0 : getms(true);
+		if (request->requestId) {
+			statsRequestResent(request->requestId);
+		}
 		sendPrepared(request, msCanWait, false);
 		{
 			QWriteLocker locker(data.toResendMutex());
@@ -427,9 +435,11 @@ mtpRequestId Session::resend(quint64 msgId, qint64 msCanWait, bool forceContaine
 }
 
 void Session::resendMany(QVector<quint64> msgIds, qint64 msCanWait, bool forceContainer, bool sendMsgStateInfo) {
+	startResendBatch();
 	for (int32 i = 0, l = msgIds.size(); i < l; ++i) {
 		resend(msgIds.at(i), msCanWait, forceContainer, sendMsgStateInfo);
 	}
+	finishResendBatch();
 }
 
 void Session::resendAll() {
@@ -442,9 +452,25 @@ void Session::resendAll() {
 			if (i.value()->requestId) toResend.push_back(i.key());
 		}
 	}
+	startResendBatch();
 	for (uint32 i = 0, l = toResend.size(); i < l; ++i) {
 		resend(toResend[i], 10, true);
 	}
+	finishResendBatch();
+}
+
+void Session::startResendBatch() {
+	++_resendBatchDepth;
+}
+
+void Session::finishResendBatch() {
+	t_assert(_resendBatchDepth > 0);
+	if (--_resendBatchDepth > 0) return;
+
+	auto msCanWait = base::take(_resendBatchCanWait, TimeMs(-1));
+	if (msCanWait >= 0) {
+		sendAnything(msCanWait);
+	}
 }
 
 void Session::sendPrepared(const mtpRequest &request, TimeMs msCanWait, bool newRequest) { // returns true, if emit of needToSend() is needed
@@ -460,6 +486,12 @@ void Session::sendPrepared(const mtpRequest &request, TimeMs msCanWait, bool new
 
 	DEBUG_LOG(("MTP Info: added, requestId %1").arg(request->requestId));
 
+	if (_resendBatchDepth > 0) {
+		if (_resendBatchCanWait < 0 || msCanWait < _resendBatchCanWait) {
+			_resendBatchCanWait = msCanWait;
+		}
+		return;
+	}
 	sendAnything(msCanWait);
 }
 
@@ -483,6 +515,16 @@ void Session::layerWasInitedForDC(bool wasInited) {
 	data.setLayerWasInited(wasInited);
 }
 
+void Session::onServerSaltsReceived() {
+	DEBUG_LOG(("MTP Info: Session::onServerSaltsReceived slot, writing mtp data, dcWithShift %1").arg(dcWithShift));
+	Local::writeMtpData();
+}
+
+void Session::onEndpointsRankingChanged() {
+	DEBUG_LOG(("MTP Info: Session::onEndpointsRankingChanged slot, writing settings soon, dcWithShift %1").arg(dcWithShift));
+	Local::writeSettingsDelayed();
+}
+
 void Session::notifyLayerInited(bool wasInited) {
 	DEBUG_LOG(("MTP Info: emitting MTProtoDC::layerWasInited(%1), dcWithShift %2").arg(Logs::b(wasInited)).arg(dcWithShift));
 	dc->setConnectionInited(wasInited);
@@ -318,6 +318,8 @@ public slots:
 
 	void authKeyCreatedForDC();
 	void layerWasInitedForDC(bool wasInited);
+	void onServerSaltsReceived();
+	void onEndpointsRankingChanged();
 
 	void tryToReceive();
 	void checkRequestsByTimer();
@@ -343,6 +345,12 @@ private:
 
 	TimeMs msSendCall, msWait;
 
+	// while resending many requests sendAnything() is called once, after all of them are added
+	void startResendBatch();
+	void finishResendBatch();
+	int _resendBatchDepth = 0;
+	TimeMs _resendBatchCanWait = -1; // -1 - nothing was added
+
 	bool _ping;
 
 	QTimer timeouter;
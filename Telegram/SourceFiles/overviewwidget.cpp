@@ -1624,7 +1624,7 @@ void OverviewInner::mediaOverviewUpdated() {
 				}
 				allGood = false;
 			}
-			HistoryItem *item = App::histItemById(itemChannel(msgid), itemMsgId(msgid));
+			HistoryItem *item = (itemMigrated(msgid) ? _migrated : _history)->overviewItem(_type, itemMsgId(msgid));
 			auto layout = layoutPrepare(item);
 			if (!layout) continue;
 
@@ -1670,7 +1670,7 @@ void OverviewInner::mediaOverviewUpdated() {
 				}
 				allGood = false;
 			}
-			HistoryItem *item = App::histItemById(itemChannel(msgid), itemMsgId(msgid));
+			HistoryItem *item = (itemMigrated(msgid) ? _migrated : _history)->overviewItem(_type, itemMsgId(msgid));
 			auto layout = layoutPrepare(item);
 			if (!layout) continue;
 
@@ -34,6 +34,7 @@ Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
 #include "localstorage.h"
 #include "boxes/confirmbox.h"
 #include "application.h"
+#include "mtproto/rpc_stats.h"
 
 namespace Settings {
 namespace {
@@ -83,6 +84,15 @@ void fillCodes() {
 			Ui::hideLayer();
 		}));
 	});
+	Codes.insert(qsl("rpcstats"), []() {
+		MTP::logRpcStats();
+		auto path = MTP::writeRpcStats();
+		Ui::show(Box<InformBox>(path.isEmpty() ? qsl("Could not write RPC stats, see the log.") : qsl("RPC stats written to:\n") + path));
+	});
+	Codes.insert(qsl("imagestats"), []() {
+		logImageCacheStats();
+		Ui::show(Box<InformBox>(qsl("Image cache stats written to the log.")));
+	});
 	Codes.insert(qsl("getdifference"), []() {
 		if (auto main = App::main()) {
 			main->getDifference();
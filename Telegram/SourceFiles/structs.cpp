@@ -58,8 +58,132 @@ ImagePtr generateUserpicImage(const style::icon &icon) {
 	return ImagePtr(App::pixmapFromImageInPlace(std_::move(data)), "PNG");
 }
 
+// Circled userpics of one size are rendered to slots of a single atlas,
+// so that painting a userpic in a list row is a single blit from it
+// instead of an ellipse with text or an image cache lookup.
+// Each row of slots is a separate pixmap allocated on its first use,
+// their memory is counted in the userpics image cache budget.
+constexpr auto kUserpicAtlasSide = 1024; // in device pixels
+constexpr auto kUserpicAtlasMinSlotsPerSide = 4;
+constexpr auto kUserpicAtlasMaxSlotsPerSide = 16;
+
+class UserpicAtlas {
+public:
+	UserpicAtlas(int size);
+	UserpicAtlas(const UserpicAtlas &other) = delete;
+	UserpicAtlas &operator=(const UserpicAtlas &other) = delete;
+	~UserpicAtlas();
+
+	template <typename Generate>
+	void paint(Painter &p, int x, int y, const StorageKey &key, Generate generate);
+
+	static bool Supports(int size) {
+		return (size > 0) && (size * cIntRetinaFactor() * kUserpicAtlasMinSlotsPerSide <= kUserpicAtlasSide);
+	}
+
+private:
+	int takeSlot(const StorageKey &key);
+	QPixmap &page(int slot);
+	QRect slotRect(int slot) const; // inside the page
+
+	int _size = 0;
+	int _slotSize = 0;
+	int _slotsPerSide = 0;
+	QVector<QPixmap> _pages; // one row of slots in each
+	int64 _pagesSize = 0;
+
+	QMap<StorageKey, int> _slotByKey;
+	QVector<StorageKey> _keyBySlot;
+	QVector<uint64> _lastUsed; // zero for the free slots
+	uint64 _useCounter = 0;
+
+};
+
+UserpicAtlas::UserpicAtlas(int size)
+: _size(size)
+, _slotSize(size * cIntRetinaFactor())
+, _slotsPerSide(qMin(kUserpicAtlasSide / _slotSize, kUserpicAtlasMaxSlotsPerSide)) {
+	_pages.resize(_slotsPerSide);
+	_keyBySlot.resize(_slotsPerSide * _slotsPerSide);
+	_lastUsed.resize(_slotsPerSide * _slotsPerSide);
+}
+
+UserpicAtlas::~UserpicAtlas() {
+	imageCacheExternalSize(Images::CacheCategory::Userpic, -_pagesSize);
+}
+
+template <typename Generate>
+void UserpicAtlas::paint(Painter &p, int x, int y, const StorageKey &key, Generate generate) {
+	auto i = _slotByKey.constFind(key);
+	auto generated = (i == _slotByKey.cend());
+	auto slot = generated ? takeSlot(key) : i.value();
+	auto &pixmap = page(slot);
+	if (generated) {
+		auto rect = slotRect(slot);
+		Painter q(&pixmap);
+		q.setCompositionMode(QPainter::CompositionMode_Source);
+		q.fillRect(rect.x() / cIntRetinaFactor(), rect.y() / cIntRetinaFactor(), _size, _size, Qt::transparent);
+		q.setCompositionMode(QPainter::CompositionMode_SourceOver);
+		generate(q, rect.x() / cIntRetinaFactor(), rect.y() / cIntRetinaFactor());
+	}
+	_lastUsed[slot] = ++_useCounter;
+	p.drawPixmap(QPoint(x, y), pixmap, slotRect(slot));
+}
+
+int UserpicAtlas::takeSlot(const StorageKey &key) {
+	// Free slots are taken in order, so the pages are filled one by one.
+	auto result = 0;
+	for (auto slot = 1, count = _lastUsed.size(); slot != count; ++slot) {
+		if (_lastUsed[slot] < _lastUsed[result]) {
+			result = slot;
+		}
+	}
+	if (_lastUsed[result]) {
+		_slotByKey.remove(_keyBySlot[result]);
+	}
+	_keyBySlot[result] = key;
+	_slotByKey.insert(key, result);
+	return result;
+}
+
+QPixmap &UserpicAtlas::page(int slot) {
+	auto &result = _pages[slot / _slotsPerSide];
+	if (result.isNull()) {
+		auto image = QImage(QSize(_slotsPerSide, 1) * _slotSize, QImage::Format_ARGB32_Premultiplied);
+		image.fill(Qt::transparent);
+		image.setDevicePixelRatio(cRetinaFactor());
+		result = App::pixmapFromImageInPlace(std_::move(image));
+
+		auto size = int64(result.width()) * result.height() * 4;
+		_pagesSize += size;
+		imageCacheExternalSize(Images::CacheCategory::Userpic, size);
+	}
+	return result;
+}
+
+QRect UserpicAtlas::slotRect(int slot) const {
+	return QRect((slot % _slotsPerSide) * _slotSize, 0, _slotSize, _slotSize);
+}
+
+std::map<int, std_::unique_ptr<UserpicAtlas>> UserpicAtlases;
+
+UserpicAtlas *userpicAtlas(int size) {
+	if (!UserpicAtlas::Supports(size)) {
+		return nullptr;
+	}
+	auto i = UserpicAtlases.find(size);
+	if (i == UserpicAtlases.end()) {
+		i = UserpicAtlases.emplace(size, std_::make_unique<UserpicAtlas>(size)).first;
+	}
+	return i->second.get();
+}
+
 } // namespace
 
+void clearUserpicAtlases() {
+	UserpicAtlases.clear();
+}
+
 style::color peerColor(int index) {
 	static style::color peerColors[kUserColorsCount] = {
 		st::historyPeer1NameFg,
@@ -308,6 +432,9 @@ void PeerData::updateNameDelayed(const QString &newName, const QString &newNameO
 
 void PeerData::setUserpic(ImagePtr userpic) {
 	_userpic = userpic;
+	if (_userpic) {
+		_userpic->setCacheCategory(Images::CacheCategory::Userpic);
+	}
 	if (!_userpic || !_userpic->loaded()) {
 		_userpicEmpty.set(colorIndex, name);
 	} else {
@@ -327,7 +454,17 @@ ImagePtr PeerData::currentUserpic() const {
 }
 
 void PeerData::paintUserpic(Painter &p, int x, int y, int size) const {
-	if (auto userpic = currentUserpic()) {
+	auto userpic = currentUserpic();
+	if (auto atlas = (userpic && photoLoc.isNull()) ? nullptr : userpicAtlas(size)) {
+		auto key = userpic ? storageKey(photoLoc) : _userpicEmpty.uniqueKey();
+		atlas->paint(p, x, y, key, [this, &userpic, size](Painter &p, int x, int y) {
+			if (userpic) {
+				p.drawPixmap(x, y, userpic->pixCircled(size, size));
+			} else {
+				_userpicEmpty.paint(p, x, y, x + size + x, size);
+			}
+		});
+	} else if (userpic) {
 		p.drawPixmap(x, y, userpic->pixCircled(size, size));
 	} else {
 		_userpicEmpty.paint(p, x, y, x + size + x, size);
@@ -798,12 +935,14 @@ void PtsWaiter::applySkippedUpdates(ChannelData *channel) {
 	if (!App::main() || _queue.isEmpty()) return;
 
 	++_applySkippedLevel;
+	App::main()->startUpdatesBatch();
 	for (QMap<uint64, PtsSkippedQueue>::const_iterator i = _queue.cbegin(), e = _queue.cend(); i != e; ++i) {
 		switch (i.value()) {
 		case SkippedUpdate: App::main()->feedUpdate(_updateQueue.value(i.key())); break;
 		case SkippedUpdates: App::main()->feedUpdates(_updatesQueue.value(i.key())); break;
 		}
 	}
+	App::main()->finishUpdatesBatch();
 	--_applySkippedLevel;
 	clearSkippedUpdates();
 }
@@ -957,6 +1096,7 @@ ImagePtr PhotoData::makeReplyPreview() {
 			if (w <= 0) w = 1;
 			if (h <= 0) h = 1;
 			replyPreview = ImagePtr(w > h ? thumb->pix(w * st::msgReplyBarSize.height() / h, st::msgReplyBarSize.height()) : thumb->pix(st::msgReplyBarSize.height()), "PNG");
+			replyPreview->setCacheCategory(Images::CacheCategory::Thumbnail);
 		} else {
 			thumb->load();
 		}
@@ -1556,6 +1696,7 @@ bool DocumentData::loaded(FilePathResolveType type) const {
 			that->_data = _loader->bytes();
 			if (that->sticker() && !_loader->imagePixmap().isNull()) {
 				that->sticker()->img = ImagePtr(_data, _loader->imageFormat(), _loader->imagePixmap());
+				that->sticker()->img->setCacheCategory(Images::CacheCategory::Sticker);
 			}
 
 			_loader->deleteLater();
@@ -1746,6 +1887,7 @@ ImagePtr DocumentData::makeReplyPreview() {
 			if (w <= 0) w = 1;
 			if (h <= 0) h = 1;
 			replyPreview = ImagePtr(w > h ? thumb->pix(w * st::msgReplyBarSize.height() / h, st::msgReplyBarSize.height()) : thumb->pix(st::msgReplyBarSize.height()), "PNG");
+			replyPreview->setCacheCategory(Images::CacheCategory::Thumbnail);
 		} else {
 			thumb->load();
 		}
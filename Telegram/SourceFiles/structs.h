@@ -205,6 +205,10 @@ static constexpr int kChannelColorsCount = 4;
 
 style::color peerColor(int index);
 
+// Empty userpic keys don't include the letters color,
+// so the userpic atlases must be cleared when the palette changes.
+void clearUserpicAtlases();
+
 class EmptyUserpic {
 public:
 	EmptyUserpic();
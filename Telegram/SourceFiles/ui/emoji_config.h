@@ -83,7 +83,16 @@ inline EmojiPtr emojiFromUrl(const QString &url) {
 	return emojiFromKey(url.midRef(10).toULongLong(0, 16)); // skip emoji://e.
 }
 
+// Plain text is mostly made of chars that can't start an emoji at all:
+// the smallest one symbol emoji code is 0xA9 and below it only keycaps start.
+inline bool emojiMayStartAt(QChar ch) {
+	auto code = ch.unicode();
+	return (code >= 0xA9U) || (code >= 0x30U && code < 0x3AU) || code == 0x23U || code == 0x2AU;
+}
+
 inline EmojiPtr emojiFromText(const QChar *ch, const QChar *end, int *outLength = nullptr) {
+	if (ch >= end || !emojiMayStartAt(*ch)) return nullptr;
+
 	EmojiPtr emoji = nullptr;
 	if (ch + 1 < end && ((ch->isHighSurrogate() && (ch + 1)->isLowSurrogate()) || (((ch->unicode() >= 0x30 && ch->unicode() < 0x3A) || ch->unicode() == 0x23 || ch->unicode() == 0x2A) && (ch + 1)->unicode() == 0x20E3))) {
 		uint32 code = (ch->unicode() << 16) | (ch + 1)->unicode();
@@ -26,14 +26,299 @@ Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
 
 #include "pspecific.h"
 
+#ifdef ARCH_CPU_SSE2
+#include <emmintrin.h>
+#endif // ARCH_CPU_SSE2
+
 namespace Images {
 namespace {
 
+constexpr auto kBlurRadius = 3;
+constexpr auto kBlurR1 = kBlurRadius + 1;
+constexpr auto kBlurStartSum = (kBlurR1 * (kBlurR1 + 1)) >> 1;
+
+// Channels are packed to 16 bit lanes, the weights sum of the blur is 16,
+// so for 8 bit channels the sums never overflow the lanes.
 FORCE_INLINE uint64 blurGetColors(const uchar *p) {
 	return (uint64)p[0] + ((uint64)p[1] << 16) + ((uint64)p[2] << 32) + ((uint64)p[3] << 48);
 }
 
-const QPixmap &circleMask(int width, int height) {
+// Horizontal pass over the row y, the packed sums are written to rgb.
+void blurRow(const uchar *pix, uint64 *rgb, int w, int y, int stride) {
+	auto row = pix + y * stride;
+	auto out = rgb + y * w;
+
+	auto cur = blurGetColors(row);
+	uint64 rgballsum = -kBlurRadius * cur;
+	uint64 rgbsum = cur * kBlurStartSum;
+	for (auto i = 1; i <= kBlurRadius; ++i) {
+		cur = blurGetColors(row + i * 4);
+		rgbsum += cur * (kBlurR1 - i);
+		rgballsum += cur;
+	}
+
+	auto update = [&](int x, int start, int end) {
+		out[x] = (rgbsum >> 4) & 0x00FF00FF00FF00FFULL;
+		rgballsum += blurGetColors(row + start * 4) - 2 * blurGetColors(row + x * 4) + blurGetColors(row + end * 4);
+		rgbsum += rgballsum;
+	};
+	auto x = 0;
+	for (; x < kBlurR1; ++x) {
+		update(x, 0, x + kBlurR1);
+	}
+	for (; x < w - kBlurR1; ++x) {
+		update(x, x - kBlurR1, x + kBlurR1);
+	}
+	for (; x < w; ++x) {
+		update(x, x - kBlurR1, w - 1);
+	}
+}
+
+// Vertical pass over the column x, the result is written back to pix.
+void blurColumn(uchar *pix, const uint64 *rgb, int w, int h, int x, int stride) {
+	auto column = rgb + x;
+	auto out = pix + x * 4;
+
+	uint64 rgballsum = -kBlurRadius * column[0];
+	uint64 rgbsum = column[0] * kBlurStartSum;
+	for (auto i = 1; i <= kBlurRadius; ++i) {
+		rgbsum += column[i * w] * (kBlurR1 - i);
+		rgballsum += column[i * w];
+	}
+
+	auto update = [&](int y, int start, int end) {
+		auto res = rgbsum >> 4;
+		out[0] = res & 0xFF;
+		out[1] = (res >> 16) & 0xFF;
+		out[2] = (res >> 32) & 0xFF;
+		out[3] = (res >> 48) & 0xFF;
+		out += stride;
+		rgballsum += column[start * w] - 2 * column[y * w] + column[end * w];
+		rgbsum += rgballsum;
+	};
+	auto y = 0;
+	for (; y < kBlurR1; ++y) {
+		update(y, 0, y + kBlurR1);
+	}
+	for (; y < h - kBlurR1; ++y) {
+		update(y, y - kBlurR1, y + kBlurR1);
+	}
+	for (; y < h; ++y) {
+		update(y, y - kBlurR1, h - 1);
+	}
+}
+
+#ifdef ARCH_CPU_SSE2
+
+// The SSE2 passes do the same integer math as the scalar ones for two rows
+// or two columns at once, each of them in four 16 bit lanes of a register.
+FORCE_INLINE __m128i blurGetColorsPair(const uchar *first, const uchar *second) {
+	int32 a, b;
+	memcpy(&a, first, 4);
+	memcpy(&b, second, 4);
+	auto pixels = _mm_unpacklo_epi32(_mm_cvtsi32_si128(a), _mm_cvtsi32_si128(b));
+	return _mm_unpacklo_epi8(pixels, _mm_setzero_si128());
+}
+
+void blurRowsPair(const uchar *pix, uint64 *rgb, int w, int y, int stride) {
+	auto first = pix + y * stride;
+	auto second = first + stride;
+	auto out = rgb + y * w;
+	auto colors = [&](int x) {
+		return blurGetColorsPair(first + x * 4, second + x * 4);
+	};
+
+	auto cur = colors(0);
+	auto rgballsum = _mm_mullo_epi16(cur, _mm_set1_epi16(-kBlurRadius));
+	auto rgbsum = _mm_mullo_epi16(cur, _mm_set1_epi16(kBlurStartSum));
+	for (auto i = 1; i <= kBlurRadius; ++i) {
+		cur = colors(i);
+		rgbsum = _mm_add_epi16(rgbsum, _mm_mullo_epi16(cur, _mm_set1_epi16(kBlurR1 - i)));
+		rgballsum = _mm_add_epi16(rgballsum, cur);
+	}
+
+	auto update = [&](int x, int start, int end) {
+		auto result = _mm_srli_epi16(rgbsum, 4);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(out + x), result);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(out + w + x), _mm_srli_si128(result, 8));
+		auto middle = colors(x);
+		rgballsum = _mm_add_epi16(rgballsum, _mm_sub_epi16(_mm_add_epi16(colors(start), colors(end)), _mm_add_epi16(middle, middle)));
+		rgbsum = _mm_add_epi16(rgbsum, rgballsum);
+	};
+	auto x = 0;
+	for (; x < kBlurR1; ++x) {
+		update(x, 0, x + kBlurR1);
+	}
+	for (; x < w - kBlurR1; ++x) {
+		update(x, x - kBlurR1, x + kBlurR1);
+	}
+	for (; x < w; ++x) {
+		update(x, x - kBlurR1, w - 1);
+	}
+}
+
+void blurColumnsPair(uchar *pix, const uint64 *rgb, int w, int h, int x, int stride) {
+	auto column = rgb + x;
+	auto out = pix + x * 4;
+	auto colors = [&](int y) {
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + y * w));
+	};
+
+	auto cur = colors(0);
+	auto rgballsum = _mm_mullo_epi16(cur, _mm_set1_epi16(-kBlurRadius));
+	auto rgbsum = _mm_mullo_epi16(cur, _mm_set1_epi16(kBlurStartSum));
+	for (auto i = 1; i <= kBlurRadius; ++i) {
+		cur = colors(i);
+		rgbsum = _mm_add_epi16(rgbsum, _mm_mullo_epi16(cur, _mm_set1_epi16(kBlurR1 - i)));
+		rgballsum = _mm_add_epi16(rgballsum, cur);
+	}
+
+	auto update = [&](int y, int start, int end) {
+		auto result = _mm_srli_epi16(rgbsum, 4);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(result, result));
+		out += stride;
+		auto middle = colors(y);
+		rgballsum = _mm_add_epi16(rgballsum, _mm_sub_epi16(_mm_add_epi16(colors(start), colors(end)), _mm_add_epi16(middle, middle)));
+		rgbsum = _mm_add_epi16(rgbsum, rgballsum);
+	};
+	auto y = 0;
+	for (; y < kBlurR1; ++y) {
+		update(y, 0, y + kBlurR1);
+	}
+	for (; y < h - kBlurR1; ++y) {
+		update(y, y - kBlurR1, y + kBlurR1);
+	}
+	for (; y < h; ++y) {
+		update(y, y - kBlurR1, h - 1);
+	}
+}
+
+#endif // ARCH_CPU_SSE2
+
+// Row kernels of the image preparation, the SSE2 versions process four
+// pixels at once and give exactly the same results as the scalar ones.
+#ifdef ARCH_CPU_SSE2
+
+FORCE_INLINE __m128i spreadAlpha(__m128i colors) {
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(colors, 0xFF), 0xFF);
+}
+
+FORCE_INLINE __m128i spreadBlue(__m128i colors) {
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(colors, 0x00), 0x00);
+}
+
+#endif // ARCH_CPU_SSE2
+
+// Multiplies the colors by (mask + 1) / 256 where mask is the first byte of a mask pixel.
+void maskCornerRow(uint32 *ints, const uchar *maskBytes, int maskBytesPerPixel, int count) {
+	auto x = 0;
+#ifdef ARCH_CPU_SSE2
+	if (maskBytesPerPixel == 4) {
+		auto zero = _mm_setzero_si128();
+		auto one = _mm_set1_epi16(1);
+		for (; x + 4 <= count; x += 4) {
+			auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ints + x));
+			auto mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(maskBytes + x * 4));
+			auto opacityLow = _mm_add_epi16(spreadBlue(_mm_unpacklo_epi8(mask, zero)), one);
+			auto opacityHigh = _mm_add_epi16(spreadBlue(_mm_unpackhi_epi8(mask, zero)), one);
+			auto low = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), opacityLow), 8);
+			auto high = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), opacityHigh), 8);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(ints + x), _mm_packus_epi16(low, high));
+		}
+	}
+#endif // ARCH_CPU_SSE2
+	for (; x != count; ++x) {
+		auto opacity = static_cast<anim::ShiftedMultiplier>(maskBytes[x * maskBytesPerPixel]) + 1;
+		ints[x] = anim::unshifted(anim::shifted(ints[x]) * opacity);
+	}
+}
+
+// Multiplies the colors by the mask alpha rounding the same way
+// QPainter::CompositionMode_DestinationIn does.
+void circleMaskRow(uint32 *ints, const uint32 *mask, int count) {
+	auto x = 0;
+#ifdef ARCH_CPU_SSE2
+	auto zero = _mm_setzero_si128();
+	auto half = _mm_set1_epi16(0x80);
+	auto multiply = [&](__m128i colors, __m128i alpha) {
+		auto product = _mm_mullo_epi16(colors, alpha);
+		return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), half), 8);
+	};
+	for (; x + 4 <= count; x += 4) {
+		auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ints + x));
+		auto alpha = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + x));
+		auto low = multiply(_mm_unpacklo_epi8(pixels, zero), spreadAlpha(_mm_unpacklo_epi8(alpha, zero)));
+		auto high = multiply(_mm_unpackhi_epi8(pixels, zero), spreadAlpha(_mm_unpackhi_epi8(alpha, zero)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(ints + x), _mm_packus_epi16(low, high));
+	}
+#endif // ARCH_CPU_SSE2
+	for (; x != count; ++x) {
+		auto alpha = mask[x] >> 24;
+		auto rb = (ints[x] & 0x00FF00FFU) * alpha;
+		rb = ((rb + ((rb >> 8) & 0x00FF00FFU) + 0x00800080U) >> 8) & 0x00FF00FFU;
+		auto ag = ((ints[x] >> 8) & 0x00FF00FFU) * alpha;
+		ag = (ag + ((ag >> 8) & 0x00FF00FFU) + 0x00800080U) & 0xFF00FF00U;
+		ints[x] = ag | rb;
+	}
+}
+
+// Moves the premultiplied colors to the (cb, cg, cr) color by alpha * ca / 65536.
+void colorizeRow(uint32 *ints, int count, int ca, int cr, int cg, int cb) {
+	auto x = 0;
+#ifdef ARCH_CPU_SSE2
+	auto zero = _mm_setzero_si128();
+	auto colorAlpha = _mm_set1_epi16(ca);
+	auto target = _mm_setr_epi16(cb, cg, cr, 0xFF, cb, cg, cr, 0xFF);
+	auto colorize = [&](__m128i colors) {
+		// aca = alpha * ca doesn't fit in a signed 16 bit lane, so the high
+		// part of the signed product aca * (target - color) is fixed up.
+		auto aca = _mm_mullo_epi16(spreadAlpha(colors), colorAlpha);
+		auto difference = _mm_sub_epi16(target, colors);
+		auto shifted = _mm_add_epi16(_mm_mulhi_epi16(aca, difference), _mm_and_si128(difference, _mm_srai_epi16(aca, 15)));
+		return _mm_add_epi16(colors, shifted);
+	};
+	for (; x + 4 <= count; x += 4) {
+		auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ints + x));
+		auto low = colorize(_mm_unpacklo_epi8(pixels, zero));
+		auto high = colorize(_mm_unpackhi_epi8(pixels, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(ints + x), _mm_packus_epi16(low, high));
+	}
+#endif // ARCH_CPU_SSE2
+	auto pix = reinterpret_cast<uchar*>(ints);
+	for (auto i = x * 4, size = count * 4; i < size; i += 4) {
+		int b = pix[i], g = pix[i + 1], r = pix[i + 2], a = pix[i + 3], aca = a * ca;
+		pix[i + 0] = uchar(b + ((aca * (cb - b)) >> 16));
+		pix[i + 1] = uchar(g + ((aca * (cg - g)) >> 16));
+		pix[i + 2] = uchar(r + ((aca * (cr - r)) >> 16));
+		pix[i + 3] = uchar(a + ((aca * (0xFF - a)) >> 16));
+	}
+}
+
+// Puts the premultiplied colors over the premultiplied background bg.
+void opaqueRow(uint32 *ints, int count, anim::Shifted bg) {
+	auto x = 0;
+#ifdef ARCH_CPU_SSE2
+	auto zero = _mm_setzero_si128();
+	auto full = _mm_set1_epi16(256);
+	auto background = _mm_unpacklo_epi8(_mm_set1_epi32(anim::unshifted(bg * 256)), zero);
+	auto over = [&](__m128i colors) {
+		auto transparency = _mm_sub_epi16(full, spreadAlpha(colors));
+		return _mm_srli_epi16(_mm_add_epi16(_mm_slli_epi16(colors, 8), _mm_mullo_epi16(background, transparency)), 8);
+	};
+	for (; x + 4 <= count; x += 4) {
+		auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ints + x));
+		auto low = over(_mm_unpacklo_epi8(pixels, zero));
+		auto high = over(_mm_unpackhi_epi8(pixels, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(ints + x), _mm_packus_epi16(low, high));
+	}
+#endif // ARCH_CPU_SSE2
+	for (; x != count; ++x) {
+		auto components = anim::shifted(ints[x]);
+		ints[x] = anim::unshifted(components * 256 + bg * (256 - anim::getAlpha(components)));
+	}
+}
+
+const QImage &circleMask(int width, int height) {
 	t_assert(Global::started());
 
 	uint64 key = uint64(uint32(width)) << 32 | uint64(uint32(height));
@@ -53,7 +338,7 @@ const QPixmap &circleMask(int width, int height) {
 			p.drawEllipse(0, 0, width, height);
 		}
 		mask.setDevicePixelRatio(cRetinaFactor());
-		i = masks.insert(key, App::pixmapFromImageInPlace(std_::move(mask)));
+		i = masks.insert(key, std_::move(mask));
 	}
 	return i.value();
 }
@@ -69,9 +354,8 @@ QImage prepareBlur(QImage img) {
 
 	uchar *pix = img.bits();
 	if (pix) {
-		int w = img.width(), h = img.height(), wold = w, hold = h;
-		const int radius = 3;
-		const int r1 = radius + 1;
+		int w = img.width(), h = img.height();
+		const int radius = kBlurRadius;
 		const int div = radius * 2 + 1;
 		const int stride = w * 4;
 		if (radius < 16 && div < w && div < h && stride <= w * 4) {
@@ -94,80 +378,26 @@ QImage prepareBlur(QImage img) {
 				pix = img.bits();
 				if (!pix) return was;
 			}
-			uint64 *rgb = new uint64[w * h];
+			auto rgb = new uint64[w * h];
 
-			int x, y, i;
-
-			int yw = 0;
-			const int we = w - r1;
-			for (y = 0; y < h; y++) {
-				uint64 cur = blurGetColors(&pix[yw]);
-				uint64 rgballsum = -radius * cur;
-				uint64 rgbsum = cur * ((r1 * (r1 + 1)) >> 1);
-
-				for (i = 1; i <= radius; i++) {
-					uint64 cur = blurGetColors(&pix[yw + i * 4]);
-					rgbsum += cur * (r1 - i);
-					rgballsum += cur;
-				}
-
-				x = 0;
-
-#define update(start, middle, end) \
-rgb[y * w + x] = (rgbsum >> 4) & 0x00FF00FF00FF00FFLL; \
-rgballsum += blurGetColors(&pix[yw + (start) * 4]) - 2 * blurGetColors(&pix[yw + (middle) * 4]) + blurGetColors(&pix[yw + (end) * 4]); \
-rgbsum += rgballsum; \
-x++;
-
-				while (x < r1) {
-					update(0, x, x + r1);
-				}
-				while (x < we) {
-					update(x - r1, x, x + r1);
-				}
-				while (x < w) {
-					update(x - r1, x, w - 1);
-				}
-
-#undef update
-
-				yw += stride;
+			auto y = 0;
+#ifdef ARCH_CPU_SSE2
+			for (; y + 1 < h; y += 2) {
+				blurRowsPair(pix, rgb, w, y, stride);
+			}
+#endif // ARCH_CPU_SSE2
+			for (; y < h; ++y) {
+				blurRow(pix, rgb, w, y, stride);
 			}
 
-			const int he = h - r1;
-			for (x = 0; x < w; x++) {
-				uint64 rgballsum = -radius * rgb[x];
-				uint64 rgbsum = rgb[x] * ((r1 * (r1 + 1)) >> 1);
-				for (i = 1; i <= radius; i++) {
-					rgbsum += rgb[i * w + x] * (r1 - i);
-					rgballsum += rgb[i * w + x];
-				}
-
-				y = 0;
-				int yi = x * 4;
-
-#define update(start, middle, end) \
-uint64 res = rgbsum >> 4; \
-pix[yi] = res & 0xFF; \
-pix[yi + 1] = (res >> 16) & 0xFF; \
-pix[yi + 2] = (res >> 32) & 0xFF; \
-pix[yi + 3] = (res >> 48) & 0xFF; \
-rgballsum += rgb[x + (start) * w] - 2 * rgb[x + (middle) * w] + rgb[x + (end) * w]; \
-rgbsum += rgballsum; \
-y++; \
-yi += stride;
-
-				while (y < r1) {
-					update(0, y, y + r1);
-				}
-				while (y < he) {
-					update(y - r1, y, y + r1);
-				}
-				while (y < h) {
-					update(y - r1, y, h - 1);
-				}
-
-#undef update
+			auto x = 0;
+#ifdef ARCH_CPU_SSE2
+			for (; x + 1 < w; x += 2) {
+				blurColumnsPair(pix, rgb, w, h, x, stride);
+			}
+#endif // ARCH_CPU_SSE2
+			for (; x < w; ++x) {
+				blurColumn(pix, rgb, w, h, x, stride);
 			}
 
 			delete[] rgb;
@@ -183,10 +413,13 @@ void prepareCircle(QImage &img) {
 	img = img.convertToFormat(QImage::Format_ARGB32_Premultiplied);
 	t_assert(!img.isNull());
 
-	QPixmap mask = circleMask(img.width(), img.height());
-	Painter p(&img);
-	p.setCompositionMode(QPainter::CompositionMode_DestinationIn);
-	p.drawPixmap(0, 0, mask);
+	auto &mask = circleMask(img.width(), img.height());
+	auto width = img.width();
+	for (auto y = 0, height = img.height(); y != height; ++y) {
+		auto ints = reinterpret_cast<uint32*>(img.scanLine(y));
+		auto maskInts = reinterpret_cast<const uint32*>(mask.constScanLine(y));
+		circleMaskRow(ints, maskInts, width);
+	}
 }
 
 void prepareRound(QImage &image, ImageRoundRadius radius, ImageRoundCorners corners) {
@@ -233,14 +466,9 @@ void prepareRound(QImage &image, QImage **cornerMasks, ImageRoundCorners corners
 		auto imageIntsAdded = imageIntsPerLine - maskWidth * imageIntsPerPixel;
 		t_assert(imageIntsAdded >= 0);
 		for (auto y = 0; y != maskHeight; ++y) {
-			for (auto x = 0; x != maskWidth; ++x) {
-				auto opacity = static_cast<anim::ShiftedMultiplier>(*maskBytes) + 1;
-				*imageInts = anim::unshifted(anim::shifted(*imageInts) * opacity);
-				maskBytes += maskBytesPerPixel;
-				imageInts += imageIntsPerPixel;
-			}
-			maskBytes += maskBytesAdded;
-			imageInts += imageIntsAdded;
+			maskCornerRow(imageInts, maskBytes, maskBytesPerPixel, maskWidth);
+			maskBytes += maskBytesPerLine;
+			imageInts += imageIntsPerLine;
 		}
 	};
 	if (corners & ImageRoundCorner::TopLeft) maskCorner(intsTopLeft, cornerMasks[0]);
@@ -257,14 +485,7 @@ QImage prepareColored(style::color add, QImage image) {
 
 	if (auto pix = image.bits()) {
 		int ca = int(add->c.alphaF() * 0xFF), cr = int(add->c.redF() * 0xFF), cg = int(add->c.greenF() * 0xFF), cb = int(add->c.blueF() * 0xFF);
-		const int w = image.width(), h = image.height(), size = w * h * 4;
-		for (int32 i = 0; i < size; i += 4) {
-			int b = pix[i], g = pix[i + 1], r = pix[i + 2], a = pix[i + 3], aca = a * ca;
-			pix[i + 0] = uchar(b + ((aca * (cb - b)) >> 16));
-			pix[i + 1] = uchar(g + ((aca * (cg - g)) >> 16));
-			pix[i + 2] = uchar(r + ((aca * (cr - r)) >> 16));
-			pix[i + 3] = uchar(a + ((aca * (0xFF - a)) >> 16));
-		}
+		colorizeRow(reinterpret_cast<uint32*>(pix), image.width() * image.height(), ca, cr, cg, cb);
 	}
 	return std_::move(image);
 }
@@ -276,13 +497,10 @@ QImage prepareOpaque(QImage image) {
 		auto bg = anim::shifted(st::imageBgTransparent->c);
 		auto width = image.width();
 		auto height = image.height();
-		auto addPerLine = (image.bytesPerLine() / sizeof(uint32)) - width;
+		auto intsPerLine = (image.bytesPerLine() / sizeof(uint32));
 		for (auto y = 0; y != height; ++y) {
-			for (auto x = 0; x != width; ++x) {
-				auto components = anim::shifted(*ints);
-				*ints++ = anim::unshifted(components * 256 + bg * (256 - anim::getAlpha(components)));
-			}
-			ints += addPerLine;
+			opaqueRow(ints, width, bg);
+			ints += intsPerLine;
 		}
 	}
 	return std_::move(image);
@@ -340,6 +558,53 @@ QImage prepare(QImage img, int w, int h, Images::Options options, int outerw, in
 	return std_::move(img);
 }
 
+// Decode a JPEG right into the requested size only if it saves at
+// least one DCT scaling step, libjpeg scales by 1/2, 1/4 and 1/8.
+constexpr auto kScaledDecodeMinFactor = 2;
+
+QSize readSize(QByteArray &bytes, const QByteArray &format) {
+	QBuffer buffer(&bytes);
+	QImageReader reader(&buffer, format);
+	auto result = reader.size();
+#ifndef OS_MAC_OLD
+	reader.setAutoTransform(true);
+	if (reader.transformation() & QImageIOHandler::TransformationRotate90) {
+		result.transpose();
+	}
+#endif // OS_MAC_OLD
+	return result;
+}
+
+QImage readScaled(QByteArray &bytes, const QByteArray &format, int width, int height, int w, int h) {
+	auto fmt = format.toLower();
+	if (fmt != "jpg" && fmt != "jpeg") return QImage();
+	if (w <= 0 || width <= 0 || height <= 0) return QImage();
+
+	if (h <= 0) {
+		h = qMax(qRound(height * w / float64(width)), 1);
+	}
+	if (w * kScaledDecodeMinFactor > width || h * kScaledDecodeMinFactor > height) {
+		return QImage();
+	}
+
+	QBuffer buffer(&bytes);
+	QImageReader reader(&buffer, format);
+	auto scaledSize = QSize(w, h);
+#ifndef OS_MAC_OLD
+	reader.setAutoTransform(true);
+	if (reader.transformation() & QImageIOHandler::TransformationRotate90) {
+		scaledSize.transpose(); // the scaled size is applied before rotation
+	}
+#endif // OS_MAC_OLD
+	reader.setScaledSize(scaledSize);
+
+	auto result = QImage();
+	if (!reader.read(&result)) {
+		return QImage();
+	}
+	return result;
+}
+
 } // namespace Images
 
 namespace {
@@ -367,6 +632,68 @@ StorageImages storageImages;
 
 int64 globalAcquiredSize = 0;
 
+struct CacheCategoryData {
+	Images::CacheList list; // most recently used first
+	int64 size = 0;
+	int64 external = 0; // part of size held outside of the list
+	int64 hits = 0;
+	int64 misses = 0;
+	int64 evicted = 0;
+	int64 scaledDecodes = 0;
+};
+CacheCategoryData CacheCategories[static_cast<int>(Images::CacheCategory::Count)];
+
+CacheCategoryData &cacheCategory(Images::CacheCategory category) {
+	return CacheCategories[static_cast<int>(category)];
+}
+
+int64 cacheCategoryBudget(Images::CacheCategory category) {
+	switch (category) {
+	case Images::CacheCategory::Thumbnail: return MemoryForThumbnailsCache;
+	case Images::CacheCategory::Photo: return MemoryForPhotosCache;
+	case Images::CacheCategory::Sticker: return MemoryForStickersCache;
+	case Images::CacheCategory::Userpic: return MemoryForUserpicsCache;
+	}
+	return MemoryForOtherImagesCache;
+}
+
+const char *cacheCategoryName(Images::CacheCategory category) {
+	switch (category) {
+	case Images::CacheCategory::Thumbnail: return "thumbnails";
+	case Images::CacheCategory::Photo: return "photos";
+	case Images::CacheCategory::Sticker: return "stickers";
+	case Images::CacheCategory::Userpic: return "userpics";
+	}
+	return "other";
+}
+
+int64 pixmapSize(const QPixmap &pixmap) {
+	return int64(pixmap.width()) * pixmap.height() * 4;
+}
+
+Images::CacheList::iterator cacheAdd(Images::CacheCategory category, const Image *image, uint64 key, int64 size) {
+	auto &data = cacheCategory(category);
+	data.size += size;
+	globalAcquiredSize += size;
+	return data.list.insert(data.list.begin(), { image, key, size });
+}
+
+void cacheRemove(Images::CacheCategory category, Images::CacheList::iterator entry) {
+	auto &data = cacheCategory(category);
+	data.size -= entry->size;
+	globalAcquiredSize -= entry->size;
+	data.list.erase(entry);
+}
+
+void cacheTouch(Images::CacheCategory category, Images::CacheList::iterator &entry) {
+	auto &data = cacheCategory(category);
+	if (entry != data.list.begin()) {
+		auto moved = *entry;
+		data.list.erase(entry);
+		entry = data.list.insert(data.list.begin(), moved);
+	}
+}
+
 uint64 PixKey(int width, int height, Images::Options options) {
 	return static_cast<uint64>(width) | (static_cast<uint64>(height) << 24) | (static_cast<uint64>(options) << 48);
 }
@@ -393,33 +720,25 @@ ImagePtr::ImagePtr(int32 width, int32 height, const MTPFileLocation &location, I
 Image::Image(const QString &file, QByteArray fmt) : _forgot(false) {
 	_data = App::pixmapFromImageInPlace(App::readImage(file, &fmt, false, 0, &_saved));
 	_format = fmt;
-	if (!_data.isNull()) {
-		globalAcquiredSize += int64(_data.width()) * _data.height() * 4;
-	}
+	registerData();
 }
 
 Image::Image(const QByteArray &filecontent, QByteArray fmt) : _forgot(false) {
 	_data = App::pixmapFromImageInPlace(App::readImage(filecontent, &fmt, false));
 	_format = fmt;
 	_saved = filecontent;
-	if (!_data.isNull()) {
-		globalAcquiredSize += int64(_data.width()) * _data.height() * 4;
-	}
+	registerData();
 }
 
 Image::Image(const QPixmap &pixmap, QByteArray format) : _format(format), _forgot(false), _data(pixmap) {
-	if (!_data.isNull()) {
-		globalAcquiredSize += int64(_data.width()) * _data.height() * 4;
-	}
+	registerData();
 }
 
 Image::Image(const QByteArray &filecontent, QByteArray fmt, const QPixmap &pixmap) : _saved(filecontent), _format(fmt), _forgot(false), _data(pixmap) {
 	_data = pixmap;
 	_format = fmt;
 	_saved = filecontent;
-	if (!_data.isNull()) {
-		globalAcquiredSize += int64(_data.width()) * _data.height() * 4;
-	}
+	registerData();
 }
 
 const QPixmap &Image::pix(int32 w, int32 h) const {
@@ -433,16 +752,15 @@ const QPixmap &Image::pix(int32 w, int32 h) const {
     }
 	auto options = Images::Option::Smooth | Images::Option::None;
 	auto k = PixKey(w, h, options);
-	auto i = _sizesCache.constFind(k);
-	if (i == _sizesCache.cend()) {
+	auto i = _sizesCache.find(k);
+	if (i == _sizesCache.end()) {
 		auto p = pixNoCache(w, h, options);
         if (cRetina()) p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		if (!p.isNull()) {
-			globalAcquiredSize += int64(p.width()) * p.height() * 4;
-		}
+		i = cacheSize(k, std_::move(p));
+	} else {
+		touchSize(i);
 	}
-	return i.value();
+	return i->pixmap;
 }
 
 const QPixmap &Image::pixRounded(int32 w, int32 h, ImageRoundRadius radius, ImageRoundCorners corners) const {
@@ -467,16 +785,15 @@ const QPixmap &Image::pixRounded(int32 w, int32 h, ImageRoundRadius radius, Imag
 		options |= Images::Option::RoundedSmall | cornerOptions(corners);
 	}
 	auto k = PixKey(w, h, options);
-	auto i = _sizesCache.constFind(k);
-	if (i == _sizesCache.cend()) {
+	auto i = _sizesCache.find(k);
+	if (i == _sizesCache.end()) {
 		auto p = pixNoCache(w, h, options);
 		if (cRetina()) p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		if (!p.isNull()) {
-			globalAcquiredSize += int64(p.width()) * p.height() * 4;
-		}
+		i = cacheSize(k, std_::move(p));
+	} else {
+		touchSize(i);
 	}
-	return i.value();
+	return i->pixmap;
 }
 
 const QPixmap &Image::pixCircled(int32 w, int32 h) const {
@@ -490,16 +807,15 @@ const QPixmap &Image::pixCircled(int32 w, int32 h) const {
 	}
 	auto options = Images::Option::Smooth | Images::Option::Circled;
 	auto k = PixKey(w, h, options);
-	auto i = _sizesCache.constFind(k);
-	if (i == _sizesCache.cend()) {
+	auto i = _sizesCache.find(k);
+	if (i == _sizesCache.end()) {
 		auto p = pixNoCache(w, h, options);
 		if (cRetina()) p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		if (!p.isNull()) {
-			globalAcquiredSize += int64(p.width()) * p.height() * 4;
-		}
+		i = cacheSize(k, std_::move(p));
+	} else {
+		touchSize(i);
 	}
-	return i.value();
+	return i->pixmap;
 }
 
 const QPixmap &Image::pixBlurredCircled(int32 w, int32 h) const {
@@ -513,16 +829,15 @@ const QPixmap &Image::pixBlurredCircled(int32 w, int32 h) const {
 	}
 	auto options = Images::Option::Smooth | Images::Option::Circled | Images::Option::Blurred;
 	auto k = PixKey(w, h, options);
-	auto i = _sizesCache.constFind(k);
-	if (i == _sizesCache.cend()) {
+	auto i = _sizesCache.find(k);
+	if (i == _sizesCache.end()) {
 		auto p = pixNoCache(w, h, options);
 		if (cRetina()) p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		if (!p.isNull()) {
-			globalAcquiredSize += int64(p.width()) * p.height() * 4;
-		}
+		i = cacheSize(k, std_::move(p));
+	} else {
+		touchSize(i);
 	}
-	return i.value();
+	return i->pixmap;
 }
 
 const QPixmap &Image::pixBlurred(int32 w, int32 h) const {
@@ -536,16 +851,15 @@ const QPixmap &Image::pixBlurred(int32 w, int32 h) const {
 	}
 	auto options = Images::Option::Smooth | Images::Option::Blurred;
 	auto k = PixKey(w, h, options);
-	auto i = _sizesCache.constFind(k);
-	if (i == _sizesCache.cend()) {
+	auto i = _sizesCache.find(k);
+	if (i == _sizesCache.end()) {
 		auto p = pixNoCache(w, h, options);
 		if (cRetina()) p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		if (!p.isNull()) {
-			globalAcquiredSize += int64(p.width()) * p.height() * 4;
-		}
+		i = cacheSize(k, std_::move(p));
+	} else {
+		touchSize(i);
 	}
-	return i.value();
+	return i->pixmap;
 }
 
 const QPixmap &Image::pixColored(style::color add, int32 w, int32 h) const {
@@ -559,16 +873,15 @@ const QPixmap &Image::pixColored(style::color add, int32 w, int32 h) const {
 	}
 	auto options = Images::Option::Smooth | Images::Option::Colored;
 	auto k = PixKey(w, h, options);
-	auto i = _sizesCache.constFind(k);
-	if (i == _sizesCache.cend()) {
+	auto i = _sizesCache.find(k);
+	if (i == _sizesCache.end()) {
 		auto p = pixColoredNoCache(add, w, h, true);
 		if (cRetina()) p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		if (!p.isNull()) {
-			globalAcquiredSize += int64(p.width()) * p.height() * 4;
-		}
+		i = cacheSize(k, std_::move(p));
+	} else {
+		touchSize(i);
 	}
-	return i.value();
+	return i->pixmap;
 }
 
 const QPixmap &Image::pixBlurredColored(style::color add, int32 w, int32 h) const {
@@ -582,16 +895,15 @@ const QPixmap &Image::pixBlurredColored(style::color add, int32 w, int32 h) cons
 	}
 	auto options = Images::Option::Blurred | Images::Option::Smooth | Images::Option::Colored;
 	auto k = PixKey(w, h, options);
-	auto i = _sizesCache.constFind(k);
-	if (i == _sizesCache.cend()) {
+	auto i = _sizesCache.find(k);
+	if (i == _sizesCache.end()) {
 		auto p = pixBlurredColoredNoCache(add, w, h);
 		if (cRetina()) p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		if (!p.isNull()) {
-			globalAcquiredSize += int64(p.width()) * p.height() * 4;
-		}
+		i = cacheSize(k, std_::move(p));
+	} else {
+		touchSize(i);
 	}
-	return i.value();
+	return i->pixmap;
 }
 
 const QPixmap &Image::pixSingle(int32 w, int32 h, int32 outerw, int32 outerh, ImageRoundRadius radius, ImageRoundCorners corners) const {
@@ -618,19 +930,15 @@ const QPixmap &Image::pixSingle(int32 w, int32 h, int32 outerw, int32 outerh, Im
 	}
 
 	auto k = SinglePixKey(options);
-	auto i = _sizesCache.constFind(k);
-	if (i == _sizesCache.cend() || i->width() != (outerw * cIntRetinaFactor()) || i->height() != (outerh * cIntRetinaFactor())) {
-		if (i != _sizesCache.cend()) {
-			globalAcquiredSize -= int64(i->width()) * i->height() * 4;
-		}
+	auto i = _sizesCache.find(k);
+	if (i == _sizesCache.end() || i->pixmap.width() != (outerw * cIntRetinaFactor()) || i->pixmap.height() != (outerh * cIntRetinaFactor())) {
 		auto p = pixNoCache(w, h, options, outerw, outerh);
 		if (cRetina()) p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		if (!p.isNull()) {
-			globalAcquiredSize += int64(p.width()) * p.height() * 4;
-		}
+		i = cacheSize(k, std_::move(p));
+	} else {
+		touchSize(i);
 	}
-	return i.value();
+	return i->pixmap;
 }
 
 const QPixmap &Image::pixBlurredSingle(int w, int h, int32 outerw, int32 outerh, ImageRoundRadius radius, ImageRoundCorners corners) const {
@@ -657,24 +965,44 @@ const QPixmap &Image::pixBlurredSingle(int w, int h, int32 outerw, int32 outerh,
 	}
 
 	auto k = SinglePixKey(options);
-	auto i = _sizesCache.constFind(k);
-	if (i == _sizesCache.cend() || i->width() != (outerw * cIntRetinaFactor()) || i->height() != (outerh * cIntRetinaFactor())) {
-		if (i != _sizesCache.cend()) {
-			globalAcquiredSize -= int64(i->width()) * i->height() * 4;
-		}
+	auto i = _sizesCache.find(k);
+	if (i == _sizesCache.end() || i->pixmap.width() != (outerw * cIntRetinaFactor()) || i->pixmap.height() != (outerh * cIntRetinaFactor())) {
 		auto p = pixNoCache(w, h, options, outerw, outerh);
 		if (cRetina()) p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		if (!p.isNull()) {
-			globalAcquiredSize += int64(p.width()) * p.height() * 4;
-		}
+		i = cacheSize(k, std_::move(p));
+	} else {
+		touchSize(i);
 	}
-	return i.value();
+	return i->pixmap;
 }
 
 QPixmap Image::pixNoCache(int w, int h, Images::Options options, int outerw, int outerh) const {
 	if (!loading()) const_cast<Image*>(this)->load();
+	if (!options.testFlag(Images::Option::Blurred)) {
+		if (loading()) {
+			addTargetSize(w, h);
+		} else if (!_prescaled.isEmpty()) {
+			auto prescaled = _prescaled.find(qMakePair(w, h));
+			if (prescaled != _prescaled.end()) {
+				auto image = std_::move(prescaled.value());
+				_prescaled.erase(prescaled);
+				return Images::pixmap(std_::move(image), w, h, options, outerw, outerh);
+			}
+		}
+	}
+	if (_forgot && !options.testFlag(Images::Option::Blurred)) {
+		// Small previews of a large photo don't need the full size image unpacked,
+		// the full size is restored only for the full size pix() in MediaView.
+		// Note: width() restores the plain images, they don't know their size.
+		auto fullw = width(), fullh = height();
+		auto scaled = Images::readScaled(_saved, _format, fullw, fullh, w, h);
+		if (!scaled.isNull()) {
+			++cacheCategory(_cacheCategory).scaledDecodes;
+			return Images::pixmap(std_::move(scaled), w, h, options, outerw, outerh);
+		}
+	}
 	restore();
+	touchData();
 
 	if (_data.isNull()) {
 		if (h <= 0 && height() > 0) {
@@ -725,6 +1053,7 @@ QPixmap Image::pixNoCache(int w, int h, Images::Options options, int outerw, int
 QPixmap Image::pixColoredNoCache(style::color add, int32 w, int32 h, bool smooth) const {
 	const_cast<Image*>(this)->load();
 	restore();
+	touchData();
 	if (_data.isNull()) return blank()->pix();
 
 	QImage img = _data.toImage();
@@ -738,6 +1067,7 @@ QPixmap Image::pixColoredNoCache(style::color add, int32 w, int32 h, bool smooth
 QPixmap Image::pixBlurredColoredNoCache(style::color add, int32 w, int32 h) const {
 	const_cast<Image*>(this)->load();
 	restore();
+	touchData();
 	if (_data.isNull()) return blank()->pix();
 
 	QImage img = Images::prepareBlur(_data.toImage());
@@ -750,24 +1080,118 @@ QPixmap Image::pixBlurredColoredNoCache(style::color add, int32 w, int32 h) cons
 	return App::pixmapFromImageInPlace(Images::prepareColored(add, img));
 }
 
-void Image::forget() const {
-	if (_forgot) return;
+void Image::setCacheCategory(Images::CacheCategory category) const {
+	if (_cacheCategory == category) return;
 
-	if (_data.isNull()) return;
+	auto data = _dataRegistered;
+	if (data) unregisterData();
+	for (auto i = _sizesCache.begin(), e = _sizesCache.end(); i != e; ++i) {
+		if (!i->pixmap.isNull()) {
+			cacheRemove(_cacheCategory, i->entry);
+		}
+	}
+	_cacheCategory = category;
+	for (auto i = _sizesCache.begin(), e = _sizesCache.end(); i != e; ++i) {
+		if (!i->pixmap.isNull()) {
+			i->entry = cacheAdd(_cacheCategory, this, i.key(), pixmapSize(i->pixmap));
+		}
+	}
+	if (data) registerData();
+}
 
-	invalidateSizeCache();
+bool Image::evictCached(uint64 key) const {
+	if (key == Images::SourceCacheKey) {
+		// Encoding the pixmap here would stall the scrolling that trims the cache,
+		// so only the images that still have their original bytes drop the data.
+		if (_saved.isEmpty()) {
+			touchData();
+			return false;
+		}
+		unregisterData();
+		_data = QPixmap();
+		_forgot = true;
+		return true;
+	}
+	auto i = _sizesCache.find(key);
+	if (i != _sizesCache.end()) {
+		removeSize(i);
+	}
+	return true;
+}
+
+Image::Sizes::iterator Image::cacheSize(uint64 key, QPixmap &&pixmap) const {
+	++cacheCategory(_cacheCategory).misses;
+
+	auto i = _sizesCache.find(key);
+	if (i != _sizesCache.end()) {
+		removeSize(i);
+	}
+	i = _sizesCache.insert(key, { std_::move(pixmap), Images::CacheList::iterator() });
+	if (!i->pixmap.isNull()) {
+		i->entry = cacheAdd(_cacheCategory, this, key, pixmapSize(i->pixmap));
+	}
+	return i;
+}
+
+void Image::touchSize(Sizes::iterator i) const {
+	++cacheCategory(_cacheCategory).hits;
+	if (!i->pixmap.isNull()) {
+		cacheTouch(_cacheCategory, i->entry);
+	}
+}
+
+void Image::removeSize(Sizes::iterator i) const {
+	if (!i->pixmap.isNull()) {
+		cacheRemove(_cacheCategory, i->entry);
+	}
+	_sizesCache.erase(i);
+}
+
+void Image::registerData() const {
+	if (_dataRegistered || _data.isNull()) return;
+
+	_dataEntry = cacheAdd(_cacheCategory, this, Images::SourceCacheKey, pixmapSize(_data));
+	_dataRegistered = true;
+}
+
+void Image::unregisterData() const {
+	if (!_dataRegistered) return;
+
+	cacheRemove(_cacheCategory, _dataEntry);
+	_dataRegistered = false;
+}
+
+void Image::touchData() const {
+	if (_dataRegistered) {
+		cacheTouch(_cacheCategory, _dataEntry);
+	}
+}
+
+bool Image::saveData() const {
 	if (_saved.isEmpty()) {
 		QBuffer buffer(&_saved);
 		if (!_data.save(&buffer, _format)) {
 			if (_data.save(&buffer, "PNG")) {
 				_format = "PNG";
 			} else {
-				return;
+				return false;
 			}
 		}
 	}
-	globalAcquiredSize -= int64(_data.width()) * _data.height() * 4;
+	return true;
+}
+
+void Image::forget() const {
+	if (_forgot) return;
+
+	if (_data.isNull()) return;
+
+	invalidateSizeCache();
+	if (!saveData()) return;
+
+	unregisterData();
 	_data = QPixmap();
+	_prescaled.clear();
 	_forgot = true;
 }
 
@@ -781,16 +1205,15 @@ void Image::restore() const {
 #endif // OS_MAC_OLD
 	_data = QPixmap::fromImageReader(&reader, Qt::ColorOnly);
 
-	if (!_data.isNull()) {
-		globalAcquiredSize += int64(_data.width()) * _data.height() * 4;
-	}
+	++cacheCategory(_cacheCategory).misses;
+	registerData();
 	_forgot = false;
 }
 
 void Image::invalidateSizeCache() const {
-	for (auto &pix : _sizesCache) {
-		if (!pix.isNull()) {
-			globalAcquiredSize -= int64(pix.width()) * pix.height() * 4;
+	for (auto &size : _sizesCache) {
+		if (!size.pixmap.isNull()) {
+			cacheRemove(_cacheCategory, size.entry);
 		}
 	}
 	_sizesCache.clear();
@@ -798,9 +1221,7 @@ void Image::invalidateSizeCache() const {
 
 Image::~Image() {
 	invalidateSizeCache();
-	if (!_data.isNull()) {
-		globalAcquiredSize -= int64(_data.width()) * _data.height() * 4;
-	}
+	unregisterData();
 }
 
 void clearStorageImages() {
@@ -823,9 +1244,73 @@ int64 imageCacheSize() {
 	return globalAcquiredSize;
 }
 
+void imageCacheExternalSize(Images::CacheCategory category, int64 delta) {
+	auto &data = cacheCategory(category);
+	data.size += delta;
+	data.external += delta;
+	globalAcquiredSize += delta;
+}
+
+void trimImageCache() {
+	for (auto index = 0; index != static_cast<int>(Images::CacheCategory::Count); ++index) {
+		auto category = static_cast<Images::CacheCategory>(index);
+		auto &data = cacheCategory(category);
+		auto budget = cacheCategoryBudget(category);
+
+		// Pixmaps that could not be freed are moved to the front, so each one is tried only once.
+		for (auto attempts = data.list.size(); data.size > budget && attempts > 0; --attempts) {
+			auto entry = data.list.end();
+			--entry;
+			if (entry->image->evictCached(entry->key)) {
+				++data.evicted;
+			}
+		}
+	}
+}
+
+void logImageCacheStats() {
+	LOG(("Image Cache: %1 bytes total").arg(globalAcquiredSize));
+	for (auto index = 0; index != static_cast<int>(Images::CacheCategory::Count); ++index) {
+		auto category = static_cast<Images::CacheCategory>(index);
+		auto &data = cacheCategory(category);
+		LOG(("Image Cache: %1 - %2 pixmaps, %3 of %4 bytes (%5 external), hits %6, misses %7, evicted %8, scaled decodes %9"
+			).arg(cacheCategoryName(category)
+			).arg(data.list.size()
+			).arg(data.size
+			).arg(cacheCategoryBudget(category)
+			).arg(data.external
+			).arg(data.hits
+			).arg(data.misses
+			).arg(data.evicted
+			).arg(data.scaledDecodes));
+	}
+}
+
 void RemoteImage::doCheckload() const {
 	if (!amLoading() || !_loader->done()) return;
 
+	if (_loader->imagePrescaledOnly()) {
+		// Only the requested sizes were decoded, the full size
+		// is restored from the saved bytes when it is needed.
+		unregisterData();
+
+		_format = _loader->imageFormat();
+		_data = QPixmap();
+		_saved = _loader->bytes();
+		_prescaled = _loader->takeImagePrescaled();
+		auto size = _loader->imageFullSize();
+		const_cast<RemoteImage*>(this)->setInformation(_saved.size(), size.width(), size.height());
+
+		invalidateSizeCache();
+
+		_loader->deleteLater();
+		_loader->stop();
+		_loader = nullptr;
+
+		_forgot = true;
+		return;
+	}
+
 	QPixmap data = _loader->imagePixmap(shrinkBox());
 	if (data.isNull()) {
 		_loader->deleteLater();
@@ -834,15 +1319,14 @@ void RemoteImage::doCheckload() const {
 		return;
 	}
 
-	if (!_data.isNull()) {
-		globalAcquiredSize -= int64(_data.width()) * _data.height() * 4;
-	}
+	unregisterData();
 
 	_format = _loader->imageFormat(shrinkBox());
 	_data = data;
+	_prescaled = _loader->takeImagePrescaled();
 	_saved = _loader->bytes();
 	const_cast<RemoteImage*>(this)->setInformation(_saved.size(), _data.width(), _data.height());
-	globalAcquiredSize += int64(_data.width()) * _data.height() * 4;
+	registerData();
 
 	invalidateSizeCache();
 
@@ -853,6 +1337,12 @@ void RemoteImage::doCheckload() const {
 	_forgot = false;
 }
 
+void RemoteImage::addTargetSize(int w, int h) const {
+	if (amLoading()) {
+		_loader->addImageTargetSize(w, h);
+	}
+}
+
 void RemoteImage::loadLocal() {
 	if (loaded() || amLoading()) return;
 
@@ -863,13 +1353,11 @@ void RemoteImage::loadLocal() {
 void RemoteImage::setData(QByteArray &bytes, const QByteArray &bytesFormat) {
 	QBuffer buffer(&bytes);
 
-	if (!_data.isNull()) {
-		globalAcquiredSize -= int64(_data.width()) * _data.height() * 4;
-	}
+	unregisterData();
 	QByteArray fmt(bytesFormat);
 	_data = App::pixmapFromImageInPlace(App::readImage(bytes, &fmt, false));
 	if (!_data.isNull()) {
-		globalAcquiredSize += int64(_data.width()) * _data.height() * 4;
+		registerData();
 		setInformation(bytes.size(), _data.width(), _data.height());
 	}
 
@@ -926,9 +1414,7 @@ void RemoteImage::loadEvenCancelled(bool loadFirst, bool prior) {
 }
 
 RemoteImage::~RemoteImage() {
-	if (!_data.isNull()) {
-		globalAcquiredSize -= int64(_data.width()) * _data.height() * 4;
-	}
+	unregisterData();
 	if (amLoading()) {
 		_loader->deleteLater();
 		_loader->stop();
@@ -1105,7 +1591,9 @@ void WebImage::setInformation(int32 size, int32 width, int32 height) {
 }
 
 FileLoader *WebImage::createLoader(LoadFromCloudSetting fromCloud, bool autoLoading) {
-	return new webFileLoader(_url, QString(), fromCloud, autoLoading);
+	auto result = new webFileLoader(_url, QString(), fromCloud, autoLoading);
+	result->setImageShrinkBox(_box);
+	return result;
 }
 
 namespace internal {
@@ -120,6 +120,7 @@ inline bool operator!=(const StorageImageLocation &a, const StorageImageLocation
 	return !(a == b);
 }
 
+class Image;
 namespace Images {
 
 QImage prepareBlur(QImage image);
@@ -147,10 +148,40 @@ Q_DECLARE_OPERATORS_FOR_FLAGS(Options);
 
 QImage prepare(QImage img, int w, int h, Options options, int outerw, int outerh);
 
+// Image size from the header, with the EXIF rotation applied.
+QSize readSize(QByteArray &bytes, const QByteArray &format);
+
+// Decodes a JPEG of width x height right into w x h (h <= 0 keeps the aspect ratio).
+// Returns a null image if the scaled decode is not applicable,
+// the caller should decode the full image in that case.
+QImage readScaled(QByteArray &bytes, const QByteArray &format, int width, int height, int w, int h);
+
 inline QPixmap pixmap(QImage img, int w, int h, Options options, int outerw, int outerh) {
 	return QPixmap::fromImage(prepare(img, w, h, options, outerw, outerh), Qt::ColorOnly);
 }
 
+// Unpacked pixmaps of all images, both the source ones and the scaled
+// variants, are kept in the least recently used order with a separate
+// memory budget for each category.
+enum class CacheCategory {
+	Other,
+	Thumbnail,
+	Photo,
+	Sticker,
+	Userpic,
+
+	Count,
+};
+
+constexpr uint64 SourceCacheKey = 0xFFFFFFFFFFFFFFFFULL;
+
+struct CacheEntry {
+	const Image *image;
+	uint64 key; // scaled variant key or SourceCacheKey for the source pixmap
+	int64 size;
+};
+using CacheList = QLinkedList<CacheEntry>;
+
 } // namespace Images
 
 class DelayedStorageImage;
@@ -221,6 +252,14 @@ public:
 
 	void forget() const;
 
+	Images::CacheCategory cacheCategory() const {
+		return _cacheCategory;
+	}
+	void setCacheCategory(Images::CacheCategory category) const;
+
+	// Frees the cached pixmap with that key, returns false if it could not be freed.
+	bool evictCached(uint64 key) const;
+
 	QByteArray savedFormat() const {
 		return _format;
 	}
@@ -244,8 +283,17 @@ protected:
 	void restore() const;
 	virtual void checkload() const {
 	}
+	// Called when a pix is requested while the image is still loading.
+	virtual void addTargetSize(int w, int h) const {
+	}
 	void invalidateSizeCache() const;
 
+	// _data was just unpacked or is going to be freed.
+	void registerData() const;
+	void unregisterData() const;
+	void touchData() const;
+	bool saveData() const; // fills _saved if it is empty, so that _data can be restored
+
 	virtual int32 countWidth() const {
 		restore();
 		return _data.width();
@@ -260,9 +308,24 @@ protected:
 	mutable bool _forgot;
 	mutable QPixmap _data;
 
+	// Variants scaled by the decode task for the requested sizes,
+	// each is used once for the first pix of that size.
+	mutable FileLoader::PrescaledImages _prescaled;
+
 private:
-	using Sizes = QMap<uint64, QPixmap>;
+	struct Size {
+		QPixmap pixmap;
+		Images::CacheList::iterator entry; // valid if !pixmap.isNull()
+	};
+	using Sizes = QMap<uint64, Size>;
+	Sizes::iterator cacheSize(uint64 key, QPixmap &&pixmap) const;
+	void touchSize(Sizes::iterator i) const;
+	void removeSize(Sizes::iterator i) const;
+
 	mutable Sizes _sizesCache;
+	mutable Images::CacheList::iterator _dataEntry;
+	mutable bool _dataRegistered = false;
+	mutable Images::CacheCategory _cacheCategory = Images::CacheCategory::Other;
 
 };
 
@@ -317,6 +380,7 @@ protected:
 	void checkload() const {
 		doCheckload();
 	}
+	void addTargetSize(int w, int h) const override;
 	void loadLocal();
 
 private:
@@ -466,6 +530,9 @@ inline QSize shrinkToKeepAspect(int32 width, int32 height, int32 towidth, int32
 void clearStorageImages();
 void clearAllImages();
 int64 imageCacheSize();
+void imageCacheExternalSize(Images::CacheCategory category, int64 delta); // pixmaps cached outside of the images, counted in the budgets
+void trimImageCache(); // evicts least recently used pixmaps of the categories over their budgets
+void logImageCacheStats();
 
 class PsFileBookmark;
 class ReadAccessEnabler {
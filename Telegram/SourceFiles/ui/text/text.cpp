@@ -180,13 +180,13 @@ public:
 			}
 			lastSkipped = false;
 			if (emoji) {
-				_t->_blocks.push_back(new EmojiBlock(_t->_st->font, _t->_text, blockStart, len, flags, lnkIndex, emoji));
+				_t->_blocks.push_back(EmojiBlock(_t->_st->font, _t->_text, blockStart, len, flags, lnkIndex, emoji));
 				emoji = 0;
 				lastSkipped = true;
 			} else if (newline) {
-				_t->_blocks.push_back(new NewlineBlock(_t->_st->font, _t->_text, blockStart, len));
+				_t->_blocks.push_back(NewlineBlock(_t->_st->font, _t->_text, blockStart, len));
 			} else {
-				_t->_blocks.push_back(new TextBlock(_t->_st->font, _t->_text, _t->_minResizeWidth, blockStart, len, flags, lnkIndex));
+				_t->_blocks.push_back(TextBlock(_t->_st->font, _t->_text, _t->_minResizeWidth, blockStart, len, flags, lnkIndex, _t->_words));
 			}
 			blockStart += len;
 			blockCreated();
@@ -196,7 +196,7 @@ public:
 	void createSkipBlock(int32 w, int32 h) {
 		createBlock();
 		_t->_text.push_back('_');
-		_t->_blocks.push_back(new SkipBlock(_t->_st->font, _t->_text, blockStart++, w, h, lnkIndex));
+		_t->_blocks.push_back(SkipBlock(_t->_st->font, _t->_text, blockStart++, w, h, lnkIndex));
 		blockCreated();
 	}
 
@@ -253,7 +253,7 @@ public:
 		} else if (type == EntityInTextPre) {
 			startFlags = TextBlockFPre;
 			createBlock();
-			if (!_t->_blocks.isEmpty() && _t->_blocks.back()->type() != TextBlockTNewline) {
+			if (!_t->_blocks.empty() && _t->_blocks.back()->type() != TextBlockTNewline) {
 				createNewlineBlock();
 			}
 		} else if (type == EntityInTextUrl
@@ -593,8 +593,8 @@ public:
 		removeFlags.clear();
 
 		_t->_links.resize(maxLnkIndex);
-		for (Text::TextBlocks::const_iterator i = _t->_blocks.cbegin(), e = _t->_blocks.cend(); i != e; ++i) {
-			ITextBlock *b = *i;
+		for (auto &block : _t->_blocks) {
+			auto b = block.get();
 			if (b->lnkIndex() > 0x8000) {
 				lnkIndex = maxLnkIndex + (b->lnkIndex() - 0x8000);
 				if (_t->_links.size() < lnkIndex) {
@@ -642,7 +642,8 @@ public:
 			}
 		}
 		_t->_links.squeeze();
-		_t->_blocks.squeeze();
+		_t->_blocks.shrink_to_fit();
+		_t->_words.shrink_to_fit();
 		_t->_text.squeeze();
 	}
 
@@ -798,6 +799,95 @@ namespace {
 	}
 }
 
+namespace {
+
+constexpr auto kMaxShapedTexts = 128;
+constexpr auto kMaxShapedLinesPerText = 16;
+
+// Lines itemized and shaped by TextPainter for the recently painted texts,
+// so that repainting the same text doesn't run the shaping again.
+// Everything that affects the shaping except the blocks is in the key,
+// the lines of a text are forgotten when its blocks change.
+struct ShapedLineKey {
+	QString text;
+	int lineStart, lineLength;
+	Qt::LayoutDirection direction;
+	const style::TextStyle *st;
+	int activeLink; // link fonts depend on it, index in _links + 1 or 0
+
+	bool operator==(const ShapedLineKey &other) const {
+		return (lineStart == other.lineStart)
+			&& (lineLength == other.lineLength)
+			&& (direction == other.direction)
+			&& (st == other.st)
+			&& (activeLink == other.activeLink)
+			&& (text == other.text);
+	}
+};
+
+class ShapedLinesCache {
+public:
+	QTextEngine *find(const Text *text, int from, const ShapedLineKey &key) {
+		auto i = _texts.find(text);
+		if (i == _texts.end()) return nullptr;
+
+		i->second.lastUsed = ++_lastUsed;
+		for_const (auto &line, i->second.lines) {
+			if (line.from == from && line.key == key) {
+				return line.engine.get();
+			}
+		}
+		return nullptr;
+	}
+	void insert(const Text *text, int from, const ShapedLineKey &key, std_::unique_ptr<QTextEngine> engine) {
+		auto i = _texts.find(text);
+		if (i == _texts.end()) {
+			if (int(_texts.size()) >= kMaxShapedTexts) {
+				removeLeastRecentlyUsed();
+			}
+			i = _texts.emplace(text, TextLines()).first;
+		}
+		auto &lines = i->second.lines;
+		if (int(lines.size()) >= kMaxShapedLinesPerText) {
+			lines.erase(lines.begin());
+		}
+		lines.push_back(Line { from, key, std_::move(engine) });
+		i->second.lastUsed = ++_lastUsed;
+	}
+	void forget(const Text *text) {
+		_texts.erase(text);
+	}
+
+private:
+	struct Line {
+		int from;
+		ShapedLineKey key;
+		std_::unique_ptr<QTextEngine> engine;
+	};
+	struct TextLines {
+		std::vector<Line> lines;
+		uint64 lastUsed = 0;
+	};
+
+	void removeLeastRecentlyUsed() {
+		auto oldest = _texts.begin();
+		for (auto i = _texts.begin(), e = _texts.end(); i != e; ++i) {
+			if (i->second.lastUsed < oldest->second.lastUsed) {
+				oldest = i;
+			}
+		}
+		_texts.erase(oldest);
+	}
+
+	std::map<const Text*, TextLines> _texts;
+	uint64 _lastUsed = 0;
+
+};
+
+NeverFreedPointer<ShapedLinesCache> ShapedLines;
+
+} // namespace
+
 class TextPainter {
 public:
 
@@ -894,8 +984,8 @@ public:
 		_wLeft = _w = w;
 		if (_elideLast) {
 			_yToElide = _yTo;
-			if (_elideRemoveFromEnd > 0 && !_t->_blocks.isEmpty()) {
-				int firstBlockHeight = countBlockHeight(_t->_blocks.front(), _t->_st);
+			if (_elideRemoveFromEnd > 0 && !_t->_blocks.empty()) {
+				int firstBlockHeight = countBlockHeight(_t->_blocks.front().get(), _t->_st);
 				if (_y + firstBlockHeight >= _yToElide) {
 					_wLeft -= _elideRemoveFromEnd;
 				}
@@ -930,7 +1020,7 @@ public:
 		bool longWordLine = true;
 		Text::TextBlocks::const_iterator e = _t->_blocks.cend();
 		for (Text::TextBlocks::const_iterator i = _t->_blocks.cbegin(); i != e; ++i, ++blockIndex) {
-			ITextBlock *b = *i;
+			auto b = i->get();
 			TextBlockType _btype = b->type();
 			int32 blockHeight = countBlockHeight(b, _t->_st);
 
@@ -951,7 +1041,7 @@ public:
 					_wLeft -= _elideRemoveFromEnd;
 				}
 
-				_parDirection = static_cast<NewlineBlock*>(b)->nextDirection();
+				_parDirection = static_cast<const NewlineBlock*>(b)->nextDirection();
 				if (_parDirection == Qt::LayoutDirectionAuto) _parDirection = cLangDir();
 				initNextParagraph(i + 1);
 
@@ -974,8 +1064,8 @@ public:
 			}
 
 			if (_btype == TextBlockTText) {
-				TextBlock *t = static_cast<TextBlock*>(b);
-				if (t->_words.isEmpty()) { // no words in this block, spaces only => layout this block in the same line
+				auto t = static_cast<const TextBlock*>(b);
+				if (!t->hasWords()) { // no words in this block, spaces only => layout this block in the same line
 					last_rPadding += b__f_lpadding;
 
 					_lineHeight = qMax(_lineHeight, blockHeight);
@@ -985,8 +1075,8 @@ public:
 				}
 
 				QFixed f_wLeft = _wLeft; // vars for saving state of the last word start
-				int32 f_lineHeight = _lineHeight; // f points to the last word-start element of t->_words
-				for (TextBlock::TextWords::const_iterator j = t->_words.cbegin(), en = t->_words.cend(), f = j; j != en; ++j) {
+				int32 f_lineHeight = _lineHeight; // f points to the last word-start element of t words
+				for (auto j = t->wordsBegin(_t->_words), en = t->wordsEnd(_t->_words), f = j; j != en; ++j) {
 					bool wordEndsHere = (j->f_width() >= 0);
 					QFixed j_width = wordEndsHere ? j->f_width() : -j->f_width();
 
@@ -1122,7 +1212,7 @@ public:
 		return _lookupResult;
 	}
 
-	const QPen &blockPen(ITextBlock *block) {
+	const QPen &blockPen(const ITextBlock *block) {
 		if (block->lnkIndex()) {
 			return _p->textPalette().linkFg->p;
 		}
@@ -1151,7 +1241,7 @@ public:
 			}
 		}
 
-		ITextBlock *_endBlock = (_endBlockIter == _end) ? nullptr : (*_endBlockIter);
+		auto _endBlock = (_endBlockIter == _end) ? nullptr : _endBlockIter->get();
 		bool elidedLine = _elideLast && (_y + _lineHeight >= _yToElide);
 		if (elidedLine) {
 			// If we decided to draw the last line elided only because of the skip block
@@ -1166,8 +1256,8 @@ public:
 		}
 
 		int blockIndex = _lineStartBlock;
-		ITextBlock *currentBlock = _t->_blocks[blockIndex];
-		ITextBlock *nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex] : 0;
+		auto currentBlock = _t->_blocks[blockIndex].get();
+		auto nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex].get() : nullptr;
 
 		int32 delta = (currentBlock->from() < _lineStart ? qMin(_lineStart - currentBlock->from(), 2) : 0);
 		_localFrom = _lineStart - delta;
@@ -1241,19 +1331,40 @@ public:
 		}
 		if (trimmedLineEnd == _lineStart && !elidedLine) return true;
 
-		if (!elidedLine) initParagraphBidi(); // if was not inited
-
 		_f = _t->_st->font;
-		QStackTextEngine engine(lineText, _f->f);
-		engine.option.setTextDirection(_parDirection);
-		_e = &engine;
-
-		eItemize();
 
 		QScriptLine line;
 		line.from = lineStart;
 		line.length = lineLength;
-		eShapeLine(line);
+
+		// Elided lines are built from the temporarily replaced blocks, they're not cached.
+		auto shapedKey = ShapedLineKey { lineText, lineStart, lineLength, _parDirection, _t->_st, activeLinkIndex() };
+		std_::unique_ptr<QTextEngine> elidedEngine;
+		_e = nullptr;
+		if (!elidedLine) {
+			ShapedLines.createIfNull();
+			_e = ShapedLines->find(_t, _localFrom, shapedKey);
+		}
+		if (_e) {
+			_e->fnt = _f->f;
+			_e->resetFontEngineCache();
+		} else {
+			if (!elidedLine) initParagraphBidi(); // if was not inited
+
+			auto shaped = std_::make_unique<QTextEngine>(lineText, _f->f);
+			shaped->option.setTextDirection(_parDirection);
+			_e = shaped.get();
+
+			eItemize();
+			eShapeLine(line);
+
+			if (elidedLine) {
+				elidedEngine = std_::move(shaped);
+			} else {
+				ShapedLines->insert(_t, _localFrom, shapedKey, std_::move(shaped));
+			}
+		}
+		auto &engine = *_e;
 
 		int firstItem = engine.findItem(line.from), lastItem = engine.findItem(line.from + line.length - 1);
 	    int nItems = (firstItem >= 0 && lastItem >= firstItem) ? (lastItem - firstItem + 1) : 0;
@@ -1268,7 +1379,7 @@ public:
 			QScriptItem &si(engine.layoutData->items[firstItem + i]);
 			while (nextBlock && nextBlock->from() <= _localFrom + si.position) {
 				currentBlock = nextBlock;
-				nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex] : 0;
+				nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex].get() : nullptr;
 			}
 			TextBlockType _type = currentBlock->type();
 			if (_type == TextBlockTSkip) {
@@ -1293,8 +1404,8 @@ public:
 		}
 
 		blockIndex = _lineStartBlock;
-		currentBlock = _t->_blocks[blockIndex];
-		nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex] : 0;
+		currentBlock = _t->_blocks[blockIndex].get();
+		nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex].get() : nullptr;
 
 		int32 textY = _y + _yDelta + _t->_st->font->ascent, emojiY = (_t->_st->font->height - st::emojiSize) / 2;
 
@@ -1307,13 +1418,13 @@ public:
 
 			while (blockIndex > _lineStartBlock + 1 && _t->_blocks[blockIndex - 1]->from() > _localFrom + si.position) {
 				nextBlock = currentBlock;
-				currentBlock = _t->_blocks[--blockIndex - 1];
+				currentBlock = _t->_blocks[--blockIndex - 1].get();
 				if (_p) _p->setPen(blockPen(currentBlock));
 				eSetFont(currentBlock);
 			}
 			while (nextBlock && nextBlock->from() <= _localFrom + si.position) {
 				currentBlock = nextBlock;
-				nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex] : 0;
+				nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex].get() : nullptr;
 				if (_p) _p->setPen(blockPen(currentBlock));
 				eSetFont(currentBlock);
 			}
@@ -1384,7 +1495,7 @@ public:
 							}
 						}
 					}
-					emojiDraw(*_p, static_cast<EmojiBlock*>(currentBlock)->emoji, (glyphX + int(st::emojiPadding)).toInt(), _y + _yDelta + emojiY);
+					emojiDraw(*_p, static_cast<const EmojiBlock*>(currentBlock)->emoji, (glyphX + int(st::emojiPadding)).toInt(), _y + _yDelta + emojiY);
 //				} else if (_p && currentBlock->type() == TextBlockSkip) { // debug
 //					_p->fillRect(QRect(x.toInt(), _y, currentBlock->width(), static_cast<SkipBlock*>(currentBlock)->height()), QColor(0, 0, 0, 32));
 				}
@@ -1514,16 +1625,19 @@ public:
 		return true;
 	}
 
-	void elideSaveBlock(int32 blockIndex, ITextBlock *&_endBlock, int32 elideStart, int32 elideWidth) {
-		if (_elideSavedBlock) {
+	void elideSaveBlock(int32 blockIndex, const ITextBlock *&_endBlock, int32 elideStart, int32 elideWidth) {
+		if (_elideSaved) {
 			restoreAfterElided();
 		}
 
 		_elideSavedIndex = blockIndex;
 		_elideSavedBlock = _t->_blocks[blockIndex];
-		const_cast<Text*>(_t)->_blocks[blockIndex] = new TextBlock(_t->_st->font, _t->_text, QFIXED_MAX, elideStart, 0, _elideSavedBlock->flags(), _elideSavedBlock->lnkIndex());
+		_elideSaved = true;
+
+		// An empty text block adds no words, _elideWords is just a placeholder.
+		const_cast<Text*>(_t)->_blocks[blockIndex] = TextBlock(_t->_st->font, _t->_text, QFIXED_MAX, elideStart, 0, _elideSavedBlock->flags(), _elideSavedBlock->lnkIndex(), _elideWords);
 		_blocksSize = blockIndex + 1;
-		_endBlock = (blockIndex + 1 < _t->_blocks.size() ? _t->_blocks[blockIndex + 1] : 0);
+		_endBlock = (blockIndex + 1 < int32(_t->_blocks.size()) ? _t->_blocks[blockIndex + 1].get() : nullptr);
 	}
 
 	void setElideBidi(int32 elideStart, int32 elideLen) {
@@ -1536,7 +1650,7 @@ public:
 		}
 	}
 
-	void prepareElidedLine(QString &lineText, int32 lineStart, int32 &lineLength, ITextBlock *&_endBlock, int repeat = 0) {
+	void prepareElidedLine(QString &lineText, int32 lineStart, int32 &lineLength, const ITextBlock *&_endBlock, int repeat = 0) {
 		static const QString _Elide = qsl("...");
 
 		_f = _t->_st->font;
@@ -1547,8 +1661,8 @@ public:
 		eItemize();
 
 		int blockIndex = _lineStartBlock;
-		ITextBlock *currentBlock = _t->_blocks[blockIndex];
-		ITextBlock *nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex] : 0;
+		auto currentBlock = _t->_blocks[blockIndex].get();
+		auto nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex].get() : nullptr;
 
 		QScriptLine line;
 		line.from = lineStart;
@@ -1565,7 +1679,7 @@ public:
 			QScriptItem &si(engine.layoutData->items[firstItem + i]);
 			while (nextBlock && nextBlock->from() <= _localFrom + si.position) {
 				currentBlock = nextBlock;
-				nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex] : 0;
+				nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex].get() : nullptr;
 			}
 			TextBlockType _type = currentBlock->type();
 			if (si.analysis.flags == QScriptAnalysis::Object) {
@@ -1636,7 +1750,7 @@ public:
 		lineLength += _Elide.size();
 
 		if (!repeat) {
-			for (; blockIndex < _blocksSize && _t->_blocks[blockIndex] != _endBlock && _t->_blocks[blockIndex]->from() < elideStart; ++blockIndex) {
+			for (; blockIndex < _blocksSize && _t->_blocks[blockIndex].get() != _endBlock && _t->_blocks[blockIndex]->from() < elideStart; ++blockIndex) {
 			}
 			if (blockIndex < _blocksSize) {
 				elideSaveBlock(blockIndex, _endBlock, elideStart, elideWidth);
@@ -1645,10 +1759,9 @@ public:
 	}
 
 	void restoreAfterElided() {
-		if (_elideSavedBlock) {
-			delete _t->_blocks[_elideSavedIndex];
+		if (_elideSaved) {
 			const_cast<Text*>(_t)->_blocks[_elideSavedIndex] = _elideSavedBlock;
-			_elideSavedBlock = nullptr;
+			_elideSaved = false;
 		}
 	}
 
@@ -1659,14 +1772,14 @@ public:
 			return;
 
 		int blockIndex = _lineStartBlock;
-		ITextBlock *currentBlock = _t->_blocks[blockIndex];
-		ITextBlock *nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex] : 0;
+		auto currentBlock = _t->_blocks[blockIndex].get();
+		auto nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex].get() : nullptr;
 		eSetFont(currentBlock);
 		for (item = _e->findItem(line.from); item <= end; ++item) {
 			QScriptItem &si = _e->layoutData->items[item];
 			while (nextBlock && nextBlock->from() <= _localFrom + si.position) {
 				currentBlock = nextBlock;
-				nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex] : 0;
+				nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex].get() : nullptr;
 				eSetFont(currentBlock);
 			}
 			_e->shape(item);
@@ -1698,7 +1811,22 @@ public:
 		return result;
 	}
 
-	void eSetFont(ITextBlock *block) {
+	// Only the link of this text shown as active changes the shaping,
+	// hovering links of other texts doesn't invalidate its shaped lines.
+	int activeLinkIndex() {
+		if (_activeLink < 0) {
+			_activeLink = 0;
+			for (auto i = 0, count = _t->_links.size(); i != count; ++i) {
+				if (ClickHandler::showAsActive(_t->_links.at(i))) {
+					_activeLink = i + 1;
+					break;
+				}
+			}
+		}
+		return _activeLink;
+	}
+
+	void eSetFont(const ITextBlock *block) {
 		style::font newFont = _t->_st->font;
 		int flags = block->flags();
 		if (flags) {
@@ -1737,8 +1865,8 @@ public:
 		const ushort *string = reinterpret_cast<const ushort*>(_e->layoutData->string.unicode());
 
 		int blockIndex = _lineStartBlock;
-		ITextBlock *currentBlock = _t->_blocks[blockIndex];
-		ITextBlock *nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex] : 0;
+		auto currentBlock = _t->_blocks[blockIndex].get();
+		auto nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex].get() : nullptr;
 
 		_e->layoutData->hasBidi = _parHasBidi;
 		QScriptAnalysis *analysis = _parAnalysis.data() + (_localFrom - _parStart);
@@ -1751,15 +1879,15 @@ public:
 		}
 
 		blockIndex = _lineStartBlock;
-		currentBlock = _t->_blocks[blockIndex];
-		nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex] : 0;
+		currentBlock = _t->_blocks[blockIndex].get();
+		nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex].get() : nullptr;
 
 		const ushort *start = string;
 		const ushort *end = start + length;
 		while (start < end) {
 			while (nextBlock && nextBlock->from() <= _localFrom + (start - string)) {
 				currentBlock = nextBlock;
-				nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex] : 0;
+				nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex].get() : nullptr;
 			}
 			TextBlockType _type = currentBlock->type();
 			if (_type == TextBlockTEmoji || _type == TextBlockTSkip) {
@@ -1779,9 +1907,9 @@ public:
 			QScriptItemArray *i_items = &_e->layoutData->items;
 
 			blockIndex = _lineStartBlock;
-			currentBlock = _t->_blocks[blockIndex];
-			nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex] : 0;
-			ITextBlock *startBlock = currentBlock;
+			currentBlock = _t->_blocks[blockIndex].get();
+			nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex].get() : nullptr;
+			auto startBlock = currentBlock;
 
 			if (!length)
 				return;
@@ -1789,7 +1917,7 @@ public:
 			for (int i = start + 1; i < end; ++i) {
 				while (nextBlock && nextBlock->from() <= _localFrom + i) {
 					currentBlock = nextBlock;
-					nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex] : 0;
+					nextBlock = (++blockIndex < _blocksSize) ? _t->_blocks[blockIndex].get() : nullptr;
 				}
 				// According to the unicode spec we should be treating characters in the Common script
 				// (punctuation, spaces, etc) as being the same script as the surrounding text for the
@@ -2283,6 +2411,7 @@ private:
 	TextSelection _selection = { 0, 0 };
 	bool _fullWidthSelection = true;
 	const QChar *_str = nullptr;
+	int _activeLink = -1; // not computed yet
 
 	// current paragraph data
 	Text::TextBlocks::const_iterator _parStartBlock;
@@ -2300,7 +2429,9 @@ private:
 	// elided hack support
 	int32 _blocksSize;
 	int32 _elideSavedIndex;
-	ITextBlock *_elideSavedBlock = nullptr;
+	AnyTextBlock _elideSavedBlock;
+	bool _elideSaved = false;
+	TextWords _elideWords;
 
 	int32 _lineStart, _localFrom;
 	int32 _lineStartBlock;
@@ -2346,12 +2477,11 @@ Text::Text(const Text &other)
 , _minHeight(other._minHeight)
 , _text(other._text)
 , _st(other._st)
-, _blocks(other._blocks.size())
+, _blocks(other._blocks)
+, _words(other._words)
 , _links(other._links)
-, _startDir(other._startDir) {
-	for (int32 i = 0, l = _blocks.size(); i < l; ++i) {
-		_blocks[i] = other._blocks.at(i)->clone();
-	}
+, _startDir(other._startDir)
+, _linesCache(other._linesCache) {
 }
 
 Text::Text(Text &&other)
@@ -2360,36 +2490,41 @@ Text::Text(Text &&other)
 , _minHeight(other._minHeight)
 , _text(other._text)
 , _st(other._st)
-, _blocks(other._blocks)
+, _blocks(std::move(other._blocks))
+, _words(std::move(other._words))
 , _links(other._links)
-, _startDir(other._startDir) {
+, _startDir(other._startDir)
+, _linesCache(std::move(other._linesCache)) {
 	other.clearFields();
 }
 
 Text &Text::operator=(const Text &other) {
+	if (ShapedLines) ShapedLines->forget(this);
 	_minResizeWidth = other._minResizeWidth;
 	_maxWidth = other._maxWidth;
 	_minHeight = other._minHeight;
 	_text = other._text;
 	_st = other._st;
-	_blocks = TextBlocks(other._blocks.size());
+	_blocks = other._blocks;
+	_words = other._words;
 	_links = other._links;
 	_startDir = other._startDir;
-	for (int32 i = 0, l = _blocks.size(); i < l; ++i) {
-		_blocks[i] = other._blocks.at(i)->clone();
-	}
+	_linesCache = other._linesCache;
 	return *this;
 }
 
 Text &Text::operator=(Text &&other) {
+	if (ShapedLines) ShapedLines->forget(this);
 	_minResizeWidth = other._minResizeWidth;
 	_maxWidth = other._maxWidth;
 	_minHeight = other._minHeight;
 	_text = other._text;
 	_st = other._st;
-	_blocks = other._blocks;
+	_blocks = std::move(other._blocks);
+	_words = std::move(other._words);
 	_links = other._links;
 	_startDir = other._startDir;
+	_linesCache = std::move(other._linesCache);
 	other.clearFields();
 	return *this;
 }
@@ -2406,12 +2541,15 @@ void Text::setText(const style::TextStyle &st, const QString &text, const TextPa
 void Text::recountNaturalSize(bool initial, Qt::LayoutDirection optionsDir) {
 	NewlineBlock *lastNewline = 0;
 
+	_linesCache.clear();
+	if (ShapedLines) ShapedLines->forget(this);
+
 	_maxWidth = _minHeight = 0;
 	int32 lineHeight = 0;
 	int32 result = 0, lastNewlineStart = 0;
 	QFixed _width = 0, last_rBearing = 0, last_rPadding = 0;
-	for (TextBlocks::const_iterator i = _blocks.cbegin(), e = _blocks.cend(); i != e; ++i) {
-		ITextBlock *b = *i;
+	for (TextBlocks::iterator i = _blocks.begin(), e = _blocks.end(); i != e; ++i) {
+		ITextBlock *b = i->get();
 		TextBlockType _btype = b->type();
 		int32 blockHeight = countBlockHeight(b, _st);
 		if (_btype == TextBlockTNewline) {
@@ -2463,7 +2601,7 @@ void Text::recountNaturalSize(bool initial, Qt::LayoutDirection optionsDir) {
 		}
 	}
 	if (_width > 0) {
-		if (!lineHeight) lineHeight = countBlockHeight(_blocks.back(), _st);
+		if (!lineHeight) lineHeight = countBlockHeight(_blocks.back().get(), _st);
 		_minHeight += lineHeight;
 		if (_maxWidth < _width) {
 			_maxWidth = _width;
@@ -2598,23 +2736,23 @@ bool Text::hasLinks() const {
 }
 
 bool Text::hasSkipBlock() const {
-	return _blocks.isEmpty() ? false : _blocks.back()->type() == TextBlockTSkip;
+	return _blocks.empty() ? false : _blocks.back()->type() == TextBlockTSkip;
 }
 
 void Text::setSkipBlock(int32 width, int32 height) {
-	if (!_blocks.isEmpty() && _blocks.back()->type() == TextBlockTSkip) {
-		SkipBlock *block = static_cast<SkipBlock*>(_blocks.back());
+	if (!_blocks.empty() && _blocks.back()->type() == TextBlockTSkip) {
+		auto block = static_cast<const SkipBlock*>(_blocks.back().get());
 		if (block->width() == width && block->height() == height) return;
 		_text.resize(block->from());
 		_blocks.pop_back();
 	}
 	_text.push_back('_');
-	_blocks.push_back(new SkipBlock(_st->font, _text, _text.size() - 1, width, height, 0));
+	_blocks.push_back(SkipBlock(_st->font, _text, _text.size() - 1, width, height, 0));
 	recountNaturalSize(false);
 }
 
 void Text::removeSkipBlock() {
-	if (!_blocks.isEmpty() && _blocks.back()->type() == TextBlockTSkip) {
+	if (!_blocks.empty() && _blocks.back()->type() == TextBlockTSkip) {
 		_text.resize(_blocks.back()->from());
 		_blocks.pop_back();
 		recountNaturalSize(false);
@@ -2627,11 +2765,11 @@ int Text::countWidth(int width) const {
 	}
 
 	QFixed maxLineWidth = 0;
-	enumerateLines(width, [&maxLineWidth](QFixed lineWidth, int lineHeight) {
-		if (lineWidth > maxLineWidth) {
-			maxLineWidth = lineWidth;
+	for_const (auto &line, countLineSizes(width)) {
+		if (line.width > maxLineWidth) {
+			maxLineWidth = line.width;
 		}
-	});
+	}
 	return maxLineWidth.ceil().toInt();
 }
 
@@ -2640,27 +2778,69 @@ int Text::countHeight(int width) const {
 		return _minHeight;
 	}
 	int result = 0;
-	enumerateLines(width, [&result](QFixed lineWidth, int lineHeight) {
-		result += lineHeight;
-	});
+	for_const (auto &line, countLineSizes(width)) {
+		result += line.height;
+	}
 	return result;
 }
 
 void Text::countLineWidths(int width, QVector<int> *lineWidths) const {
-	enumerateLines(width, [lineWidths](QFixed lineWidth, int lineHeight) {
-		lineWidths->push_back(lineWidth.ceil().toInt());
-	});
+	for_const (auto &line, countLineSizes(width)) {
+		lineWidths->push_back(line.width.ceil().toInt());
+	}
+}
+
+const Text::LineSizes &Text::countLineSizes(int width) const {
+	constexpr auto kLinesCacheSize = 4;
+
+	// Any width with the same line breaks hits, so resizing a window
+	// counts the lines again only when some line gets wrapped differently.
+	auto effectiveWidth = qMax(QFixed(width), _minResizeWidth);
+	for (auto i = 0, count = _linesCache.size(); i != count; ++i) {
+		if (_linesCache[i].minWidth <= effectiveWidth && effectiveWidth < _linesCache[i].maxWidth) {
+			if (i > 0) {
+				_linesCache.prepend(_linesCache.takeAt(i));
+			}
+			return _linesCache.front().lines;
+		}
+	}
+
+	auto entry = LinesCacheEntry();
+	enumerateLines(width, [&entry](QFixed lineWidth, int lineHeight) {
+		entry.lines.push_back({ lineWidth, lineHeight });
+	}, &entry.minWidth, &entry.maxWidth);
+	if (_linesCache.size() == kLinesCacheSize) {
+		_linesCache.pop_back();
+	}
+	_linesCache.prepend(std_::move(entry));
+	return _linesCache.front().lines;
 }
 
 template <typename Callback>
-void Text::enumerateLines(int w, Callback callback) const {
+void Text::enumerateLines(int w, Callback callback, QFixed *minWidth, QFixed *maxWidth) const {
 	QFixed width = w;
 	if (width < _minResizeWidth) width = _minResizeWidth;
 
+	// Every line break decision compares the width with some required width,
+	// the decisions stay the same while it is not less than all the required
+	// widths that fitted and less than all the required widths that didn't.
+	*minWidth = 0;
+	*maxWidth = QFIXED_MAX;
+	auto fits = [width, minWidth, maxWidth](QFixed newWidthLeft) {
+		auto required = width - newWidthLeft;
+		if (newWidthLeft >= 0) {
+			accumulate_max(*minWidth, required);
+			return true;
+		}
+		accumulate_min(*maxWidth, required);
+		return false;
+	};
+
 	int lineHeight = 0;
 	QFixed widthLeft = width, last_rBearing = 0, last_rPadding = 0;
 	bool longWordLine = true;
-	for_const (auto b, _blocks) {
+	for (auto &block : _blocks) {
+		auto b = block.get();
 		TextBlockType _btype = b->type();
 		int blockHeight = countBlockHeight(b, _st);
 
@@ -2679,7 +2859,7 @@ void Text::enumerateLines(int w, Callback callback) const {
 		auto b__f_lpadding = b->f_lpadding();
 		auto b__f_rbearing = b->f_rbearing();
 		QFixed newWidthLeft = widthLeft - b__f_lpadding - last_rBearing - (last_rPadding + b->f_width() - b__f_rbearing);
-		if (newWidthLeft >= 0) {
+		if (fits(newWidthLeft)) {
 			last_rBearing = b__f_rbearing;
 			last_rPadding = b->f_rpadding();
 			widthLeft = newWidthLeft;
@@ -2691,8 +2871,8 @@ void Text::enumerateLines(int w, Callback callback) const {
 		}
 
 		if (_btype == TextBlockTText) {
-			TextBlock *t = static_cast<TextBlock*>(b);
-			if (t->_words.isEmpty()) { // no words in this block, spaces only => layout this block in the same line
+			auto t = static_cast<const TextBlock*>(b);
+			if (!t->hasWords()) { // no words in this block, spaces only => layout this block in the same line
 				last_rPadding += b__f_lpadding;
 
 				lineHeight = qMax(lineHeight, blockHeight);
@@ -2703,13 +2883,13 @@ void Text::enumerateLines(int w, Callback callback) const {
 
 			QFixed f_wLeft = widthLeft;
 			int f_lineHeight = lineHeight;
-			for (auto j = t->_words.cbegin(), e = t->_words.cend(), f = j; j != e; ++j) {
+			for (auto j = t->wordsBegin(_words), e = t->wordsEnd(_words), f = j; j != e; ++j) {
 				bool wordEndsHere = (j->f_width() >= 0);
 				QFixed j_width = wordEndsHere ? j->f_width() : -j->f_width();
 
 				QFixed newWidthLeft = widthLeft - b__f_lpadding - last_rBearing - (last_rPadding + j_width - j->f_rbearing());
 				b__f_lpadding = 0;
-				if (newWidthLeft >= 0) {
+				if (fits(newWidthLeft)) {
 					last_rBearing = j->f_rbearing();
 					last_rPadding = j->f_rpadding();
 					widthLeft = newWidthLeft;
@@ -2960,18 +3140,18 @@ QString Text::originalText(TextSelection selection, ExpandLinksMode mode) const
 }
 
 void Text::clear() {
-	for (TextBlocks::iterator i = _blocks.begin(), e = _blocks.end(); i != e; ++i) {
-		delete *i;
-	}
 	clearFields();
 	_text.clear();
 }
 
 void Text::clearFields() {
+	if (ShapedLines) ShapedLines->forget(this);
 	_blocks.clear();
+	_words.clear();
 	_links.clear();
 	_maxWidth = _minHeight = 0;
 	_startDir = Qt::LayoutDirectionAuto;
+	_linesCache.clear();
 }
 
 void emojiDraw(QPainter &p, EmojiPtr e, int x, int y) {
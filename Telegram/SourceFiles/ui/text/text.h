@@ -25,6 +25,7 @@ Copyright (c) 2014-2017 John Preston, https://desktop.telegram.org
 #include "core/click_handler.h"
 #include "ui/text/text_entity.h"
 #include "ui/emoji_config.h"
+#include "ui/text/text_block.h"
 
 static const QChar TextCommand(0x0010);
 enum TextCommands {
@@ -80,7 +81,6 @@ static constexpr TextSelection AllTextSelection = { 0, 0xFFFF };
 typedef QPair<QString, QString> TextCustomTag; // open str and close str
 typedef QMap<QChar, TextCustomTag> TextCustomTagsMap;
 
-class ITextBlock;
 class Text {
 public:
 
@@ -210,11 +210,25 @@ private:
 	template <typename AppendPartCallback, typename ClickHandlerStartCallback, typename ClickHandlerFinishCallback, typename FlagsChangeCallback>
 	void enumerateText(TextSelection selection, AppendPartCallback appendPartCallback, ClickHandlerStartCallback clickHandlerStartCallback, ClickHandlerFinishCallback clickHandlerFinishCallback, FlagsChangeCallback flagsChangeCallback) const;
 
-	// Template method for countWidth(), countHeight(), countLineWidths().
+	// Template method for countLineSizes().
 	// callback(lineWidth, lineHeight) will be called for all lines with:
 	// QFixed lineWidth, int lineHeight
+	// the lines are broken the same way for all widths in [*minWidth, *maxWidth)
 	template <typename Callback>
-	void enumerateLines(int w, Callback callback) const;
+	void enumerateLines(int w, Callback callback, QFixed *minWidth, QFixed *maxWidth) const;
+
+	// Line sizes counted by enumerateLines() for a few recently used line breaks,
+	// they are dropped when blocks change in recountNaturalSize() or clear().
+	struct LineSize {
+		QFixed width;
+		int height;
+	};
+	using LineSizes = QVector<LineSize>;
+	struct LinesCacheEntry {
+		QFixed minWidth, maxWidth;
+		LineSizes lines;
+	};
+	const LineSizes &countLineSizes(int width) const;
 
 	void recountNaturalSize(bool initial, Qt::LayoutDirection optionsDir = Qt::LayoutDirectionAuto);
 
@@ -229,14 +243,17 @@ private:
 	QString _text;
 	const style::TextStyle *_st = nullptr;
 
-	typedef QVector<ITextBlock*> TextBlocks;
+	typedef std::vector<AnyTextBlock> TextBlocks;
 	TextBlocks _blocks;
+	TextWords _words;
 
 	typedef QVector<ClickHandlerPtr> TextLinks;
 	TextLinks _links;
 
 	Qt::LayoutDirection _startDir = Qt::LayoutDirectionAuto;
 
+	mutable QVector<LinesCacheEntry> _linesCache; // most recently used first
+
 	friend class TextParser;
 	friend class TextPainter;
 
@@ -158,8 +158,8 @@ static inline void addNextCluster(int &pos, int end, ScriptLine &line, int &glyp
 class BlockParser {
 public:
 
-	BlockParser(QTextEngine *e, TextBlock *b, QFixed minResizeWidth, int32 blockFrom, const QString &str)
-		: block(b), eng(e), str(str) {
+	BlockParser(QTextEngine *e, TextBlock *b, TextWords &words, QFixed minResizeWidth, int32 blockFrom, const QString &str)
+		: block(b), words(words), wordsFrom(int32(words.size())), eng(e), str(str) {
 		parseWords(minResizeWidth, blockFrom);
 	}
 
@@ -178,7 +178,8 @@ public:
 		lbh.logClusters = eng->layoutData->logClustersPtr;
 
 		block->_lpadding = 0;
-		block->_words.clear();
+		block->_wordsFrom = wordsFrom;
+		block->_wordsCount = 0;
 
 		int wordStart = lbh.currentPosition;
 
@@ -212,10 +213,10 @@ public:
 					addNextCluster(lbh.currentPosition, end, lbh.spaceData, lbh.glyphCount,
 						current, lbh.logClusters, lbh.glyphs);
 
-				if (block->_words.isEmpty()) {
+				if (int32(words.size()) == wordsFrom) {
 					block->_lpadding = lbh.spaceData.textWidth;
 				} else {
-					block->_words.back().add_rpadding(lbh.spaceData.textWidth);
+					words.back().add_rpadding(lbh.spaceData.textWidth);
 					block->_width += lbh.spaceData.textWidth;
 				}
 				lbh.spaceData.length = 0;
@@ -235,7 +236,7 @@ public:
 						|| attributes[lbh.currentPosition].whiteSpace
 						|| isLineBreak(attributes, lbh.currentPosition)) {
 						lbh.calculateRightBearing();
-						block->_words.push_back(TextWord(wordStart + blockFrom, lbh.tmpData.textWidth, -lbh.negativeRightBearing()));
+						words.push_back(TextWord(wordStart + blockFrom, lbh.tmpData.textWidth, -lbh.negativeRightBearing()));
 						block->_width += lbh.tmpData.textWidth;
 						lbh.tmpData.textWidth = 0;
 						lbh.tmpData.length = 0;
@@ -245,7 +246,7 @@ public:
 						if (!addingEachGrapheme && lbh.tmpData.textWidth > minResizeWidth) {
 							if (lastGraphemeBoundaryPosition >= 0) {
 								lbh.calculateRightBearingForPreviousGlyph();
-								block->_words.push_back(TextWord(wordStart + blockFrom, -lastGraphemeBoundaryLine.textWidth, -lbh.negativeRightBearing()));
+								words.push_back(TextWord(wordStart + blockFrom, -lastGraphemeBoundaryLine.textWidth, -lbh.negativeRightBearing()));
 								block->_width += lastGraphemeBoundaryLine.textWidth;
 								lbh.tmpData.textWidth -= lastGraphemeBoundaryLine.textWidth;
 								lbh.tmpData.length -= lastGraphemeBoundaryLine.length;
@@ -255,7 +256,7 @@ public:
 						}
 						if (addingEachGrapheme) {
 							lbh.calculateRightBearing();
-							block->_words.push_back(TextWord(wordStart + blockFrom, -lbh.tmpData.textWidth, -lbh.negativeRightBearing()));
+							words.push_back(TextWord(wordStart + blockFrom, -lbh.tmpData.textWidth, -lbh.negativeRightBearing()));
 							block->_width += lbh.tmpData.textWidth;
 							lbh.tmpData.textWidth = 0;
 							lbh.tmpData.length = 0;
@@ -271,12 +272,13 @@ public:
 			if (lbh.currentPosition == end)
 				newItem = item + 1;
 		}
-		if (block->_words.isEmpty()) {
+		block->_wordsCount = int32(words.size()) - wordsFrom;
+		if (!block->_wordsCount) {
 			block->_rpadding = 0;
 		} else {
-			block->_rpadding = block->_words.back().f_rpadding();
+			block->_rpadding = words.back().f_rpadding();
+			block->_rbearing = words.back().f_rbearing();
 			block->_width -= block->_rpadding;
-			block->_words.squeeze();
 		}
 	}
 
@@ -291,6 +293,8 @@ public:
 private:
 
 	TextBlock *block;
+	TextWords &words;
+	int32 wordsFrom;
 	QTextEngine *eng;
 	const QString &str;
 
@@ -300,7 +304,7 @@ QFixed ITextBlock::f_rbearing() const {
 	return (type() == TextBlockTText) ? static_cast<const TextBlock*>(this)->real_f_rbearing() : 0;
 }
 
-TextBlock::TextBlock(const style::font &font, const QString &str, QFixed minResizeWidth, uint16 from, uint16 length, uchar flags, uint16 lnkIndex) : ITextBlock(font, str, from, length, flags, lnkIndex) {
+TextBlock::TextBlock(const style::font &font, const QString &str, QFixed minResizeWidth, uint16 from, uint16 length, uchar flags, uint16 lnkIndex, TextWords &words) : ITextBlock(font, str, from, length, flags, lnkIndex) {
 	_flags |= ((TextBlockTText & 0x0F) << 8);
 	if (length) {
 		style::font blockFont = font;
@@ -337,7 +341,7 @@ TextBlock::TextBlock(const style::font &font, const QString &str, QFixed minResi
 		layout.beginLayout();
 		layout.createLine();
 
-		BlockParser parser(&engine, this, minResizeWidth, _from, part);
+		BlockParser parser(&engine, this, words, minResizeWidth, _from, part);
 
 		layout.endLayout();
 	}
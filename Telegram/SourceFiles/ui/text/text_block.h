@@ -91,10 +91,6 @@ public:
 		return (_flags & 0xFF);
 	}
 
-	virtual ITextBlock *clone() const = 0;
-	virtual ~ITextBlock() {
-	}
-
 protected:
 
 	uint16 _from;
@@ -111,10 +107,6 @@ public:
 		return _nextDir;
 	}
 
-	ITextBlock *clone() const {
-		return new NewlineBlock(*this);
-	}
-
 private:
 	NewlineBlock(const style::font &font, const QString &str, uint16 from, uint16 length) : ITextBlock(font, str, from, length, 0, 0), _nextDir(Qt::LayoutDirectionAuto) {
 		_flags |= ((TextBlockTNewline & 0x0F) << 8);
@@ -161,24 +153,34 @@ private:
 
 };
 
+// Words of all the text blocks of a Text are stored in one array,
+// each TextBlock knows the range of its words in it.
+using TextWords = std::vector<TextWord>;
+
 class TextBlock : public ITextBlock {
 public:
-
-	ITextBlock *clone() const {
-		return new TextBlock(*this);
+	TextWords::const_iterator wordsBegin(const TextWords &words) const {
+		return words.cbegin() + _wordsFrom;
+	}
+	TextWords::const_iterator wordsEnd(const TextWords &words) const {
+		return words.cbegin() + _wordsFrom + _wordsCount;
+	}
+	bool hasWords() const {
+		return (_wordsCount > 0);
 	}
 
 private:
 
-	TextBlock(const style::font &font, const QString &str, QFixed minResizeWidth, uint16 from, uint16 length, uchar flags, uint16 lnkIndex);
+	TextBlock(const style::font &font, const QString &str, QFixed minResizeWidth, uint16 from, uint16 length, uchar flags, uint16 lnkIndex, TextWords &words);
 
 	friend class ITextBlock;
 	QFixed real_f_rbearing() const {
-		return _words.isEmpty() ? 0 : _words.back().f_rbearing();
+		return _rbearing;
 	}
 
-	typedef QVector<TextWord> TextWords;
-	TextWords _words;
+	int32 _wordsFrom = 0;
+	int32 _wordsCount = 0;
+	QFixed _rbearing = 0; // of the last word
 
 	friend class Text;
 	friend class TextParser;
@@ -190,10 +192,6 @@ private:
 class EmojiBlock : public ITextBlock {
 public:
 
-	ITextBlock *clone() const {
-		return new EmojiBlock(*this);
-	}
-
 private:
 
 	EmojiBlock(const style::font &font, const QString &str, uint16 from, uint16 length, uchar flags, uint16 lnkIndex, const EmojiData *emoji);
@@ -213,10 +211,6 @@ public:
 		return _height;
 	}
 
-	ITextBlock *clone() const {
-		return new SkipBlock(*this);
-	}
-
 private:
 
 	SkipBlock(const style::font &font, const QString &str, uint16 from, int32 w, int32 h, uint16 lnkIndex);
@@ -228,3 +222,39 @@ private:
 
 	friend class TextPainter;
 };
+
+// Any of the text blocks stored by value, so that Text keeps all of its
+// blocks in one contiguous array instead of a heap allocation for each.
+// The blocks are plain data, they're copied with the storage bytes.
+class AnyTextBlock {
+public:
+	AnyTextBlock() : _storage() {
+	}
+
+	template <typename BlockType>
+	AnyTextBlock(const BlockType &block) {
+		static_assert(std_::is_base_of<ITextBlock, BlockType>::value, "Bad text block type.");
+		static_assert(sizeof(BlockType) <= kStorageSize, "Text block is too big.");
+		static_assert(alignof(BlockType) <= alignof(alignment), "Bad text block alignment.");
+		new (_storage) BlockType(block);
+	}
+
+	ITextBlock *get() {
+		return reinterpret_cast<ITextBlock*>(_storage);
+	}
+	const ITextBlock *get() const {
+		return reinterpret_cast<const ITextBlock*>(_storage);
+	}
+	ITextBlock *operator->() {
+		return get();
+	}
+	const ITextBlock *operator->() const {
+		return get();
+	}
+
+private:
+	static constexpr size_t kStorageSize = 32U;
+	using alignment = uint64;
+	alignas(alignment) alignment _storage[kStorageSize / sizeof(alignment)];
+
+};
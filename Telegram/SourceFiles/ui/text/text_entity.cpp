@@ -1442,6 +1442,35 @@ MTPVector<MTPMessageEntity> linksToMTP(const EntitiesInText &links, bool sending
 	return result;
 }
 
+namespace {
+
+// Holds the last match of one of the entity expressions and runs the
+// expression again only when the parsing went past the start of that match.
+// A match found from some offset stays the first match for any greater
+// offset up to its start, and no match stays no match for any greater offset.
+class EntityMatcher {
+public:
+	EntityMatcher(const QRegularExpression &re, bool enabled) : _re(re), _enabled(enabled) {
+	}
+
+	QRegularExpressionMatch match(const QString &text, int offset) {
+		if (_enabled && (_offset < 0 || offset < _offset || (_match.hasMatch() && _match.capturedStart() < offset))) {
+			_match = _re.match(text, offset);
+			_offset = offset;
+		}
+		return _match;
+	}
+
+private:
+	const QRegularExpression &_re;
+	bool _enabled;
+	int _offset = -1;
+	QRegularExpressionMatch _match;
+
+};
+
+} // namespace
+
 // Some code is duplicated in flattextarea.cpp!
 void textParseEntities(QString &text, int32 flags, EntitiesInText *inOutEntities, bool rich) {
 	EntitiesInText result;
@@ -1610,6 +1639,25 @@ void textParseEntities(QString &text, int32 flags, EntitiesInText *inOutEntities
 	int32 len = text.size(), commandOffset = rich ? 0 : len;
 	bool inLink = false, commandIsLink = false;
 	const QChar *start = text.constData(), *end = start + text.size();
+
+	// Each of the expressions requires some char to be present in the text,
+	// find them all in one pass and skip the expressions that can't match.
+	bool hasDot = false, hasColon = false, hasSlash = false, hasHash = false, hasAt = false;
+	for (auto ch = start; ch != end; ++ch) {
+		switch (ch->unicode()) {
+		case '.': hasDot = true; break;
+		case ':': hasColon = true; break;
+		case '/': hasSlash = true; break;
+		case '#': hasHash = true; break;
+		case '@': hasAt = true; break;
+		}
+	}
+	EntityMatcher domainMatcher(_reDomain, hasDot);
+	EntityMatcher explicitDomainMatcher(_reExplicitDomain, hasColon && hasSlash);
+	EntityMatcher hashtagMatcher(_reHashtag, withHashtags && hasHash);
+	EntityMatcher mentionMatcher(_reMention, withMentions && hasAt);
+	EntityMatcher botCommandMatcher(_reBotCommand, withBotCommands && hasSlash);
+
 	for (int32 offset = 0, matchOffset = offset, mentionSkip = 0; offset < len;) {
 		if (commandOffset <= offset) {
 			for (commandOffset = offset; commandOffset < len; ++commandOffset) {
@@ -1620,11 +1668,11 @@ void textParseEntities(QString &text, int32 flags, EntitiesInText *inOutEntities
 				}
 			}
 		}
-		auto mDomain = _reDomain.match(text, matchOffset);
-		auto mExplicitDomain = _reExplicitDomain.match(text, matchOffset);
-		auto mHashtag = withHashtags ? _reHashtag.match(text, matchOffset) : QRegularExpressionMatch();
-		auto mMention = withMentions ? _reMention.match(text, qMax(mentionSkip, matchOffset)) : QRegularExpressionMatch();
-		auto mBotCommand = withBotCommands ? _reBotCommand.match(text, matchOffset) : QRegularExpressionMatch();
+		auto mDomain = domainMatcher.match(text, matchOffset);
+		auto mExplicitDomain = explicitDomainMatcher.match(text, matchOffset);
+		auto mHashtag = hashtagMatcher.match(text, matchOffset);
+		auto mMention = mentionMatcher.match(text, qMax(mentionSkip, matchOffset));
+		auto mBotCommand = botCommandMatcher.match(text, matchOffset);
 
 		EntityInTextType lnkType = EntityInTextUrl;
 		int32 lnkStart = 0, lnkLength = 0;
@@ -1655,7 +1703,7 @@ void textParseEntities(QString &text, int32 flags, EntitiesInText *inOutEntities
 			}
 			if (!(start + mentionStart + 1)->isLetter() || !(start + mentionEnd - 1)->isLetterOrNumber()) {
 				mentionSkip = mentionEnd;
-				mMention = _reMention.match(text, qMax(mentionSkip, matchOffset));
+				mMention = mentionMatcher.match(text, qMax(mentionSkip, matchOffset));
 				if (mMention.hasMatch()) {
 					mentionStart = mMention.capturedStart();
 					mentionEnd = mMention.capturedEnd();
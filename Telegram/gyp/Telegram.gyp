@@ -234,6 +234,12 @@
       '<(src_loc)/data/data_abstract_structure.h',
       '<(src_loc)/data/data_drafts.cpp',
       '<(src_loc)/data/data_drafts.h',
+      '<(src_loc)/data/data_messages_index.cpp',
+      '<(src_loc)/data/data_messages_index.h',
+      '<(src_loc)/data/data_overview_ids.cpp',
+      '<(src_loc)/data/data_overview_ids.h',
+      '<(src_loc)/data/data_search_index.cpp',
+      '<(src_loc)/data/data_search_index.h',
       '<(src_loc)/dialogs/dialogs_common.h',
       '<(src_loc)/dialogs/dialogs_indexed_list.cpp',
       '<(src_loc)/dialogs/dialogs_indexed_list.h',
@@ -337,10 +343,14 @@
       '<(src_loc)/mtproto/dcenter.h',
       '<(src_loc)/mtproto/file_download.cpp',
       '<(src_loc)/mtproto/file_download.h',
+      '<(src_loc)/mtproto/packet_log.cpp',
+      '<(src_loc)/mtproto/packet_log.h',
       '<(src_loc)/mtproto/rsa_public_key.cpp',
       '<(src_loc)/mtproto/rsa_public_key.h',
       '<(src_loc)/mtproto/rpc_sender.cpp',
       '<(src_loc)/mtproto/rpc_sender.h',
+      '<(src_loc)/mtproto/rpc_stats.cpp',
+      '<(src_loc)/mtproto/rpc_stats.h',
       '<(src_loc)/mtproto/scheme_auto.cpp',
       '<(src_loc)/mtproto/scheme_auto.h',
       '<(src_loc)/mtproto/session.cpp',